@@ -51,10 +51,15 @@ CPP_SRCS += \
 ../src/PlayerState.cpp \
 ../src/Plotter.cpp \
 ../src/PositionInfo.cpp \
+../src/RolloutEvaluator.cpp \
+../src/SchedulingProfile.cpp \
 ../src/ServerParam.cpp \
 ../src/Simulator.cpp \
+../src/StandInServer.cpp \
 ../src/Strategy.cpp \
+../src/TableCache.cpp \
 ../src/Tackler.cpp \
+../src/TeamProcess.cpp \
 ../src/Thread.cpp \
 ../src/TimeTest.cpp \
 ../src/Trainer.cpp \
@@ -114,10 +119,15 @@ OBJS += \
 ./src/PlayerState.o \
 ./src/Plotter.o \
 ./src/PositionInfo.o \
+./src/RolloutEvaluator.o \
+./src/SchedulingProfile.o \
 ./src/ServerParam.o \
 ./src/Simulator.o \
+./src/StandInServer.o \
 ./src/Strategy.o \
+./src/TableCache.o \
 ./src/Tackler.o \
+./src/TeamProcess.o \
 ./src/Thread.o \
 ./src/TimeTest.o \
 ./src/Trainer.o \
@@ -177,10 +187,15 @@ CPP_DEPS += \
 ./src/PlayerState.d \
 ./src/Plotter.d \
 ./src/PositionInfo.d \
+./src/RolloutEvaluator.d \
+./src/SchedulingProfile.d \
 ./src/ServerParam.d \
 ./src/Simulator.d \
+./src/StandInServer.d \
 ./src/Strategy.d \
+./src/TableCache.d \
 ./src/Tackler.d \
+./src/TeamProcess.d \
 ./src/Thread.d \
 ./src/TimeTest.d \
 ./src/Trainer.d \
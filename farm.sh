@@ -0,0 +1,265 @@
+#!/bin/bash
+
+# WrightEagle (Soccer Simulation League 2D)                                       
+# BASE SOURCE CODE RELEASE 2016                                                   
+# Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                  
+#                         Multi-Agent Systems Lab.,                               
+#                         School of Computer Science and Technology,              
+#                         University of Science and Technology of China           
+# All rights reserved.                                                            
+#                                                                                 
+# Redistribution and use in source and binary forms, with or without              
+# modification, are permitted provided that the following conditions are met:     
+#     * Redistributions of source code must retain the above copyright            
+#       notice, this list of conditions and the following disclaimer.             
+#     * Redistributions in binary form must reproduce the above copyright         
+#       notice, this list of conditions and the following disclaimer in the       
+#       documentation and/or other materials provided with the distribution.      
+#     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the     
+#       names of its contributors may be used to endorse or promote products      
+#       derived from this software without specific prior written permission.     
+#                                                                                 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED   
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          
+# DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE   
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL      
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR      
+# SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER      
+# CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   
+# OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+# THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.               
+
+# 同时跑多场无界面比赛，用于调参。
+# 每场比赛使用独立的端口（PORT + 10 * 场次）和独立的工作目录（Test/、Logfiles/、server日志都在里面），
+# server 以 synch_mode 和 auto_mode 运行，不用等实时，也不用在monitor里开球。
+# 按 -c 把CPU分成若干组，每组同时只跑一场，server和双方球队都绑在这一组CPU上，
+# 组数就是并行的场数，所以吞吐量随核数基本线性增长。
+# -s standin 时不用 rcssserver，而是用本程序的替身server（stand_in_server），球员直接在 Simulator 上跑，
+# 不写完整的 rcssserver 日志，也没有教练。
+# 所有比赛结束后把比分、NetworkTest 和 TimeTest 的结果汇总到 report.txt。
+
+HOST="localhost"
+PORT="6000"
+VERSION="Release"
+BINARY="WEBase"
+TEAM_NAME="WEBase"
+MATCHES=4
+CPUS_PER_MATCH=4
+SERVER="rcssserver"
+OPP_DIR=""
+HALF_TIME=300
+MATCH_TIMEOUT=1800
+OUT_DIR="Farm/`date +%Y%m%d%H%M%S`"
+
+usage() {
+    echo "Usage: $0 [-n matches] [-c cpus per match] [-p base port] [-s server] [-o opponent dir] [-l half time] [-T timeout] [-d output dir] [-v Debug|Release] [-b binary] [-t team name]"
+    exit 1
+}
+
+while getopts  "n:c:p:s:o:l:T:d:v:b:t:" flag; do
+    case "$flag" in
+        n) MATCHES=$OPTARG;;
+        c) CPUS_PER_MATCH=$OPTARG;;
+        p) PORT=$OPTARG;;
+        s) SERVER=$OPTARG;;
+        o) OPP_DIR=$OPTARG;;
+        l) HALF_TIME=$OPTARG;;
+        T) MATCH_TIMEOUT=$OPTARG;;
+        d) OUT_DIR=$OPTARG;;
+        v) VERSION=$OPTARG;;
+        b) BINARY=$OPTARG;;
+        t) TEAM_NAME=$OPTARG;;
+        *) usage;;
+    esac
+done
+
+if [ $VERSION = "Debug" ]; then
+    make debug
+else
+    make release
+fi
+
+SELF_DIR=`pwd`
+CLIENT="$SELF_DIR/$VERSION/$BINARY"
+OPP_NAME="${TEAM_NAME}_R"
+if [ -n "$OPP_DIR" ]; then
+    OPP_DIR=`cd $OPP_DIR && pwd`
+fi
+# 比赛在各自的目录里启动，相对路径的server要先换成绝对路径
+case "$SERVER" in
+    */*) SERVER="`cd \`dirname $SERVER\` && pwd`/`basename $SERVER`";;
+esac
+
+# 没有 taskset 时照常运行，只是不绑核
+TASKSET=""
+if which taskset >/dev/null 2>&1; then
+    TASKSET="taskset -c"
+fi
+
+CPUS=`getconf _NPROCESSORS_ONLN`
+if [ $CPUS_PER_MATCH -gt $CPUS ]; then
+    CPUS_PER_MATCH=$CPUS
+fi
+SLOTS=`expr $CPUS / $CPUS_PER_MATCH`
+if [ $SLOTS -gt $MATCHES ]; then
+    SLOTS=$MATCHES
+fi
+
+mkdir -p $OUT_DIR
+OUT_DIR=`cd $OUT_DIR && pwd`
+
+echo ">>>>>>>>>>>>>>>>>>>>>> $MATCHES matches, $SLOTS in parallel, $CPUS_PER_MATCH cpus each, output in $OUT_DIR"
+
+# 在 $1 号比赛的目录里跑一整场，CPU列表为 $2
+run_match() {
+    local id=$1
+    local cpus=$2
+    local dir="$OUT_DIR/match-$id"
+    local port=`expr $PORT + $id \* 10`
+    local coach_port=`expr $port + 1`
+    local olcoach_port=`expr $port + 2`
+    local pin=""
+    if [ -n "$TASKSET" ]; then
+        pin="$TASKSET $cpus"
+    fi
+
+    mkdir -p $dir/Test $dir/Logfiles $dir/server
+    # 配置、阵型和数据（包括 data/cache 下的派生表）都和源码目录共用
+    for f in conf data formations train; do
+        ln -sfn $SELF_DIR/$f $dir/$f
+    done
+
+    cd $dir
+
+    local server_options="server::port=$port server::coach_port=$coach_port server::olcoach_port=$olcoach_port"
+    server_options="$server_options server::synch_mode=true server::auto_mode=true"
+    server_options="$server_options server::half_time=$HALF_TIME server::nr_normal_halfs=2 server::nr_extra_halfs=0 server::penalty_shoot_outs=false"
+    server_options="$server_options server::kick_off_wait=50 server::connect_wait=300 server::game_over_wait=10"
+    server_options="$server_options server::coach=false server::text_logging=false"
+    server_options="$server_options server::game_logging=true server::game_log_dir=$dir/server server::game_log_compression=0"
+
+    local team_param="-host $HOST -port $port -coach_port $coach_port -olcoach_port $olcoach_port -log_dir Logfiles"
+    team_param="$team_param -team_process on -sched_cpus $cpus -time_test on -network_test on"
+
+    local begin=`date +%s`
+    if [ "$SERVER" = "standin" ]; then
+        timeout $MATCH_TIMEOUT $pin $CLIENT -stand_in_server on -port $port -synch_mode on -half_time $HALF_TIME -log_dir $dir/server >server.out 2>&1 &
+        team_param="$team_param -team_process_coach off"
+    else
+        timeout $MATCH_TIMEOUT $pin $SERVER $server_options >server.out 2>&1 &
+    fi
+    local server_pid=$!
+    sleep 1
+
+    $pin $CLIENT -team_name $TEAM_NAME $team_param >left.out 2>&1 &
+    local left_pid=$!
+    sleep 1
+
+    local right_pid
+    if [ -n "$OPP_DIR" ]; then
+        (cd $OPP_DIR && exec $pin ./start.sh -h $HOST -p $port) >right.out 2>&1 &
+        right_pid=$!
+    else
+        $pin $CLIENT -team_name $OPP_NAME $team_param -time_test off -network_test off >right.out 2>&1 &
+        right_pid=$!
+    fi
+
+    wait $server_pid
+    local end=`date +%s`
+
+    # 球员在server退出后会因等不到信息而退出，这里只是兜底
+    sleep 2
+    kill $left_pid $right_pid 2>/dev/null
+    wait $left_pid $right_pid 2>/dev/null
+
+    # rcssserver 和替身server的日志名都形如 20240101120000-WEBase_2-vs-WEBase_R_1.rcg
+    local rcg=`ls $dir/server/*.rcg 2>/dev/null | tail -1`
+    local result=`basename "$rcg" .rcg | sed -n 's/^[0-9]*-\(.*\)_\([0-9]*\)-vs-\(.*\)_\([0-9]*\)$/\1 \2 \4 \3/p'`
+    if [ -z "$result" ]; then
+        result="- - - -"
+    fi
+    echo "$id $result `expr $end - $begin` $cpus" >$dir/result.txt
+    echo ">>>>>>>>>>>>>>>>>>>>>> match $id: $result (`expr $end - $begin`s on cpus $cpus)"
+
+    cd $SELF_DIR
+}
+
+# 第 $1 组CPU依次跑第 $1, $1 + SLOTS, ... 场
+run_slot() {
+    local slot=$1
+    local first=`expr $slot \* $CPUS_PER_MATCH`
+    local last=`expr $first + $CPUS_PER_MATCH - 1`
+    local id=$slot
+    while [ $id -lt $MATCHES ]; do
+        run_match $id "$first-$last"
+        id=`expr $id + $SLOTS`
+    done
+}
+
+FARM_BEGIN=`date +%s`
+
+slot=0
+while [ $slot -lt $SLOTS ]; do
+    run_slot $slot &
+    slot=`expr $slot + 1`
+done
+wait
+
+FARM_END=`date +%s`
+
+REPORT="$OUT_DIR/report.txt"
+{
+    echo "matches: $MATCHES, parallel: $SLOTS, cpus per match: $CPUS_PER_MATCH, server: $SERVER"
+    echo "wall time: `expr $FARM_END - $FARM_BEGIN`s"
+    echo ""
+    echo "# id left left_score right_score right seconds cpus"
+    cat $OUT_DIR/match-*/result.txt | sort -n
+    echo ""
+    cat $OUT_DIR/match-*/result.txt | awk '
+        $3 == "-" { failed++; next }
+        { played++; goals += $3; against += $4; seconds += $6
+          if ($3 > $4) win++; else if ($3 < $4) lose++; else draw++ }
+        END {
+            printf("played: %d, failed: %d\n", played, failed)
+            if (played > 0) {
+                printf("win/draw/lose: %d/%d/%d\n", win, draw, lose)
+                printf("goals: %.2f - %.2f per match\n", goals / played, against / played)
+                printf("match time: %.1fs per match\n", seconds / played)
+            }
+        }'
+    echo ""
+
+    # NetworkTest：各球员 CommandReconcile 的合计
+    echo "# NetworkTest"
+    cat $OUT_DIR/match-*/Test/CommandReconcile-*.txt 2>/dev/null | awk '
+        /^Command cycles:/ { command += $3 }
+        /^Miss cycles:/ { miss += $3 }
+        /^Double cycles:/ { double += $3 }
+        /^Lost commands:/ { lost += $3 }
+        END {
+            printf("command cycles: %d, miss cycles: %d, double cycles: %d, lost commands: %d\n", command, miss, double, lost)
+            if (command > 0) printf("late rate: %f\n", miss / command)
+        }'
+    echo ""
+
+    # TimeTest：每个事件按次数加权的平均耗时和最大耗时（每次调用的统计）
+    echo "# TimeTest"
+    for f in $OUT_DIR/match-*/Test/TimeTest-*.txt; do
+        [ -f $f ] || continue
+        awk '
+            NR == 1 { event = $0 }
+            /^Time cost for each time:/ { each = 1; next }
+            /^Time cost for each cycle:/ { each = 0 }
+            each && /^Num:/ { num = $2 }
+            each && /^Ave:/ { ave = $2 }
+            each && /^Max:/ { max = $2 }
+            END { print event, num, ave, max }' $f
+    done | awk '
+        { num[$1] += $2; sum[$1] += $2 * $3; if ($4 > max[$1]) max[$1] = $4 }
+        END {
+            for (e in num) if (num[e] > 0) printf("%-24s num %d, ave %.3f ms, max %.3f ms\n", e, num[e], sum[e] / num[e], max[e])
+        }' | sort
+} >$REPORT
+
+cat $REPORT
@@ -1256,6 +1256,29 @@ void ActionEffector::Reset()
 	mIsSayMissed	= false;
 }
 
+/**
+ * 计数器恢复成CheckCommands()中与sense同步后的值
+ * Counters go back to the values synchronized with sense_body in CheckCommands().
+ */
+void ActionEffector::ResetForReplan(Observer *observer)
+{
+	bool is_say_missed = mIsSayMissed;
+	Reset();
+	mIsSayMissed = is_say_missed;
+
+	mKickCount          = observer->Sense().GetKickCount();
+	mDashCount          = observer->Sense().GetDashCount();
+	mTurnCount          = observer->Sense().GetTurnCount();
+	mSayCount           = observer->Sense().GetSayCount();
+	mTurnNeckCount      = observer->Sense().GetTurnNeckCount();
+	mCatchCount         = observer->Sense().GetCatchCount();
+	mMoveCount          = observer->Sense().GetMoveCount();
+	mChangeViewCount    = observer->Sense().GetChangeViewCount();
+	mPointtoCount       = observer->Sense().GetArmCount();
+	mAttentiontoCount   = observer->Sense().GetFocusCount();
+	mTackleCount        = observer->Sense().GetTackleCount();
+}
+
 void ActionEffector::ResetForScan()
 {
 	//清空互斥命令
@@ -73,7 +73,7 @@ class Agent;
 inline AngleDeg GetTurnMoment(const AngleDeg actual_turn_angle, const int player_type, const double player_speed)
 {
 	return (actual_turn_angle * (1.0 +
-			PlayerParam::instance().HeteroPlayer(player_type).inertiaMoment() * player_speed));
+			PlayerParam::instance().Profile(player_type).mInertiaMoment * player_speed));
 }
 
 /**
@@ -87,7 +87,7 @@ inline AngleDeg GetTurnMoment(const AngleDeg actual_turn_angle, const int player
 inline AngleDeg GetTurnAngle(const AngleDeg moment, const int player_type, const double player_speed)
 {
 	return (GetNormalizeMoment(moment) / (1.0 +
-			PlayerParam::instance().HeteroPlayer(player_type).inertiaMoment() * player_speed));
+			PlayerParam::instance().Profile(player_type).mInertiaMoment * player_speed));
 }
 
 /**
@@ -99,8 +99,8 @@ inline AngleDeg GetTurnAngle(const AngleDeg moment, const int player_type, const
  */
 inline AngleDeg GetMaxTurnAngle(const int player_type, const double player_speed)
 {
-	return (ServerParam::instance().maxMoment() / (1.0 +
-			PlayerParam::instance().HeteroPlayer(player_type).inertiaMoment() * player_speed));
+	const PlayerTypeProfile & profile = PlayerParam::instance().Profile(player_type);
+	return (profile.mMaxMoment / (1.0 + profile.mInertiaMoment * player_speed));
 }
 
 /**
@@ -134,11 +134,12 @@ inline AngleDeg GetMinTurnNeckAngle(const AngleDeg player_head_angle)
  */
 inline double GetKickRate(const Vector & ball_2_player, const int player_type)
 {
+	const PlayerTypeProfile & profile = PlayerParam::instance().Profile(player_type);
 	double dir_diff = fabs(ball_2_player.Dir());
-	double dist_ball = ball_2_player.Mod() - PlayerParam::instance().HeteroPlayer(player_type).playerSize() - ServerParam::instance().ballSize();
-	return PlayerParam::instance().HeteroPlayer(player_type).kickPowerRate() *
+	double dist_ball = ball_2_player.Mod() - profile.mKickDistOffset;
+	return profile.mKickPowerRate *
 			(1.0 - 0.25 * dir_diff / 180.0 -
-					0.25 * dist_ball / PlayerParam::instance().HeteroPlayer(player_type).kickableMargin());
+					0.25 * dist_ball * profile.mKickMarginInverse);
 }
 
 /**
@@ -152,20 +153,41 @@ inline double GetKickRate(const Vector & ball_2_player, const int player_type)
  */
 inline double GetMaxKickRand(const Vector & ball_2_player, const Vector & ball_vel, const int player_type, const double kick_power)
 {
+	const PlayerTypeProfile & profile = PlayerParam::instance().Profile(player_type);
 	double dir_diff = fabs(ball_2_player.Dir());
-	double dist_ball = ball_2_player.Mod() - PlayerParam::instance().HeteroPlayer(player_type).playerSize() - ServerParam::instance().ballSize();
+	double dist_ball = ball_2_player.Mod() - profile.mKickDistOffset;
 
 	double pos_rate = 0.5 + 0.25 * (dir_diff / 180.0 +
-			dist_ball / PlayerParam::instance().HeteroPlayer(player_type).kickableMargin());
+			dist_ball * profile.mKickMarginInverse);
 
 	double speed_rate = 0.5 + 0.5 * (ball_vel.Mod() /
 			(ServerParam::instance().ballSpeedMax() * ServerParam::instance().ballDecay()));
 
-	return (PlayerParam::instance().HeteroPlayer(player_type).kickRand() *
+	return (profile.mKickRand *
 			(kick_power / ServerParam::instance().maxPower()) *
 			(pos_rate + speed_rate));
 }
 
+/**
+ * 铲球概率公式中的乘方
+ */
+inline double TacklePow(const double & x, const double & exponent)
+{
+	//server 默认的 tackle_exponent 和 foul_exponent 都是整数，用连乘代替 pow
+	const int n = static_cast<int>(exponent);
+	if (n == exponent && n >= 0 && n <= 32) {
+		double result = 1.0;
+		double base = x;
+		for (int k = n; k > 0; k >>= 1) {
+			if (k & 1) result *= base;
+			base *= base;
+		}
+		return result;
+	}
+
+	return pow(x, exponent);
+}
+
 /**
  * 得到tackle的概率，注意这里的ball_2_player是球相对于球员的相对坐标，以球员身体方向为x正方向
  * Get tackle success probability.
@@ -191,7 +213,7 @@ inline double GetTackleProb(const Vector & ball_2_player, const bool foul)
 
 		double exponent = ( foul ) ? ServerParam::instance().foulExponent() : ServerParam::instance().tackleExponent();
 		// tackle failure probability
-		double prob = pow(dx, exponent) + pow(dy, exponent);
+		double prob = TacklePow(dx, exponent) + TacklePow(dy, exponent);
 		prob = MinMax(0.0, prob, 1.0);
 		return 1.0 - prob;
 	}
@@ -205,7 +227,7 @@ inline double GetMaxTackleRand(const Vector & ball_2_player, const Vector & ball
 	double speed_rate = 0.5 + 0.5 * (ball_vel.Mod() /
 			(ServerParam::instance().ballSpeedMax() * ServerParam::instance().ballDecay()));
 
-	return (PlayerParam::instance().HeteroPlayer(player_type).kickRand()
+	return (PlayerParam::instance().Profile(player_type).mKickRand
 			* ServerParam::instance().tackleRandFactor()
 			* (pos_rate + speed_rate));
 }
@@ -224,7 +246,7 @@ inline double GetMaxTackleRand(const double & prob, const Vector & ball_vel, con
 	double speed_rate = 0.5 + 0.5 * (ball_vel.Mod() /
 			(ServerParam::instance().ballSpeedMax() * ServerParam::instance().ballDecay()));
 
-	return (PlayerParam::instance().HeteroPlayer(player_type).kickRand()
+	return (PlayerParam::instance().Profile(player_type).mKickRand
 			* ServerParam::instance().tackleRandFactor()
 			* (pos_rate + speed_rate));
 }
@@ -388,6 +410,12 @@ public:
 	void Reset();
 	void ResetForScan();
 
+	/**
+	 * 撤销本周期已经排队的命令，用于推测决策后重新决策
+	 * Drop commands queued in this cycle, used before planning again after a speculative decision.
+	 */
+	void ResetForReplan(Observer *observer);
+
 	/**
 	 * 下面这些接口是server提供的所有命令的接口，高层来调用
 	 * 这些接口中严格按照server是否会执行来判断，server肯定可以执行的才返回true
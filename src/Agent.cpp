@@ -31,8 +31,12 @@
  ************************************************************************************/
 
 #include <cstdlib>
+#include <cstdio>
+#include <fstream>
 #include "Agent.h"
 #include "WorldModel.h"
+#include "BehaviorBase.h"
+#include "PlayerParam.h"
 
 /**
  * Constructor.
@@ -43,11 +47,15 @@ Agent::Agent(Unum unum, WorldModel *world_model, bool reverse):
 	mpWorldModel( world_model ),
 	mpWorldState( &(world_model->World(reverse)) ),
 	mpInfoState( new InfoState( mpWorldState)),
+	mpActiveBehaviorPool( new ActiveBehaviorPool ),
 	mIsNewSight (false),
 	mpStrategy(0),
 	mpAnalyser(0),
     mpActionEffector(0),
-    mpFormation(0)
+    mpFormation(0),
+    mPoolTime(Time(-3, 0)),
+    mPoolRevision(0),
+    mPoolStamp(-1)
 {
 }
 
@@ -59,7 +67,12 @@ Agent::~Agent()
 	SetHistoryActiveBehaviors();
 
 	for (int type = BT_None + 1; type < BT_Max; ++type) {
-		delete mLastActiveBehavior[type];
+		mpActiveBehaviorPool->Recycle(mLastActiveBehavior[type]);
+	}
+
+	for (Unum i = 1; i <= TEAMSIZE; ++i) {
+		delete mpTeammateAgents[i];
+		delete mpOpponentAgents[i];
 	}
 
 	delete mpInfoState;
@@ -67,6 +80,7 @@ Agent::~Agent()
 	delete mpActionEffector;
 	delete mpStrategy;
 	delete mpAnalyser;
+	delete mpActiveBehaviorPool;
 }
 
 /**
@@ -93,6 +107,72 @@ Agent * Agent::CreateOpponentAgent(Unum unum) ///反算对手
 }
 
 
+Agent & Agent::GetTeammateAgent(Unum unum)
+{
+	Assert(unum > 0 && unum <= TEAMSIZE);
+	return AcquirePooledAgent(mpTeammateAgents[unum], unum, mReverse);
+}
+
+Agent & Agent::GetOpponentAgent(Unum unum)
+{
+	Assert(unum > 0 && unum <= TEAMSIZE);
+	return AcquirePooledAgent(mpOpponentAgents[unum], unum, !mReverse);
+}
+
+/**
+ * 池里的 Agent 与 new 出来的一样只是反算用，不执行动作。
+ * 每次取出都先向 WorldModel 要一次它的世界，反算的世界过期时会在这里重新生成；
+ * 世界状态的标记变了就让 InfoState、Strategy、Analyser 在用到时重新计算，
+ * 并处理上次保存的行为：换了周期转为历史，同一周期则清掉。
+ */
+Agent & Agent::AcquirePooledAgent(Agent *& slot, Unum unum, bool reverse)
+{
+	const bool time_test = PlayerParam::instance().TimeTest();
+
+	if (slot == 0) {
+		RealTime begin = time_test? GetRealTime(): RealTime();
+		slot = new Agent(unum, mpWorldModel, reverse);
+		if (time_test) {
+			RealTime end = GetRealTime();
+			AgentPoolTest::instance().AddConstruction(end.Sub(begin));
+		}
+	}
+
+	Agent & agent = *slot;
+	const WorldState & world = mpWorldModel->World(reverse);
+
+	if (agent.mPoolTime == world.CurrentTime() && agent.mPoolRevision == Updatable::Revision() && agent.mPoolStamp == world.GetStamp()) {
+		if (time_test) {
+			AgentPoolTest::instance().AddAcquire(true, 0);
+		}
+		return agent;
+	}
+
+	RealTime begin = time_test? GetRealTime(): RealTime();
+
+	if (agent.mPoolTime.T() != world.CurrentTime().T()) {
+		agent.SetHistoryActiveBehaviors();
+	}
+	else {
+		agent.ResetActiveBehaviors();
+	}
+
+	agent.mpInfoState->Invalidate();
+	if (agent.mpStrategy) agent.mpStrategy->Expire();
+	if (agent.mpAnalyser) agent.mpAnalyser->Expire();
+
+	agent.mPoolTime = world.CurrentTime();
+	agent.mPoolRevision = Updatable::Revision();
+	agent.mPoolStamp = world.GetStamp();
+
+	if (time_test) {
+		RealTime end = GetRealTime();
+		AgentPoolTest::instance().AddAcquire(false, end.Sub(begin));
+	}
+
+	return agent;
+}
+
 void Agent::SaveActiveBehavior(const ActiveBehavior & beh)
 {
 	BehaviorType type = beh.GetType();
@@ -101,12 +181,11 @@ void Agent::SaveActiveBehavior(const ActiveBehavior & beh)
 
 	if (mActiveBehavior[type] != 0) {
 		if (*mActiveBehavior[type] < beh) {
-			delete mActiveBehavior[type];
-			mActiveBehavior[type] = new ActiveBehavior(beh);
+			*mActiveBehavior[type] = beh;
 		}
 	}
 	else {
-		mActiveBehavior[type] = new ActiveBehavior(beh);
+		mActiveBehavior[type] = mpActiveBehaviorPool->Clone(beh);
 	}
 }
 
@@ -125,17 +204,41 @@ void Agent::SetActiveBehaviorInAct(BehaviorType type)
 	mActiveBehavior[0] = mActiveBehavior[type];
 }
 
-void Agent::SaveActiveBehaviorList(const std::list<ActiveBehavior> & behavior_list)
+void Agent::ReplaceActiveBehavior(const ActiveBehavior & beh)
 {
-	for (std::list<ActiveBehavior>::const_iterator it = behavior_list.begin(); it != behavior_list.end(); ++it) {
+	BehaviorType type = beh.GetType();
+
+	Assert(type > BT_None && type < BT_Max);
+
+	if (mActiveBehavior[type] != 0) {
+		*mActiveBehavior[type] = beh;
+	}
+	else {
+		mActiveBehavior[type] = mpActiveBehaviorPool->Clone(beh);
+	}
+}
+
+void Agent::SaveActiveBehaviorList(const ActiveBehaviorList & behavior_list)
+{
+	for (ActiveBehaviorList::const_iterator it = behavior_list.begin(); it != behavior_list.end(); ++it) {
 		SaveActiveBehavior(*it);
 	}
 }
 
+void Agent::ResetActiveBehaviors()
+{
+    for (int type = BT_None + 1; type < BT_Max; ++type) {
+        mpActiveBehaviorPool->Recycle(mActiveBehavior[type]);
+        mActiveBehavior[type] = 0;
+    }
+
+    mActiveBehavior[0] = 0;
+}
+
 void Agent::SetHistoryActiveBehaviors()
 {
     for (int type = BT_None + 1; type < BT_Max; ++type) {
-        delete mLastActiveBehavior[type];
+        mpActiveBehaviorPool->Recycle(mLastActiveBehavior[type]);
 
         mLastActiveBehavior[type] = mActiveBehavior[type];
         mActiveBehavior[type] = 0;
@@ -145,3 +248,55 @@ void Agent::SetHistoryActiveBehaviors()
     mActiveBehavior[0] = 0;
 }
 
+AgentPoolTest::AgentPoolTest():
+	mUnum(0),
+	mConstructions(0),
+	mConstructionCost(0),
+	mAcquires(0),
+	mReuses(0),
+	mUpdateCost(0)
+{
+}
+
+AgentPoolTest & AgentPoolTest::instance()
+{
+	static AgentPoolTest agent_pool_test;
+	return agent_pool_test;
+}
+
+void AgentPoolTest::AddConstruction(long cost)
+{
+	++mConstructions;
+	mConstructionCost += cost;
+}
+
+void AgentPoolTest::AddAcquire(bool reused, long cost)
+{
+	++mAcquires;
+	if (reused) {
+		++mReuses;
+	}
+	mUpdateCost += cost;
+}
+
+AgentPoolTest::~AgentPoolTest()
+{
+	if (mAcquires == 0) return;
+
+	char file_name[256];
+	sprintf(file_name, "Test/AgentPool-%d.txt", mUnum);
+
+	std::ofstream out_file(file_name);
+	if (out_file.good() == false) {
+		PRINT_ERROR("open file error  " << file_name);
+		return;
+	}
+
+	out_file << "Acquires: " << mAcquires << std::endl;
+	out_file << "Constructions: " << mConstructions << ", ave " << (mConstructions? mConstructionCost / 1000.0 / mConstructions: 0.0) << "ms" << std::endl;
+	out_file << "Reused with cached info: " << mReuses << " (" << 100.0 * mReuses / mAcquires << "%)" << std::endl;
+	out_file << "Updates: " << mAcquires - mReuses << ", ave " << (mAcquires > mReuses? mUpdateCost / 1000.0 / (mAcquires - mReuses): 0.0) << "ms" << std::endl;
+	out_file << "Construction cost saved: " << (mConstructions? (mAcquires - mConstructions) * mConstructionCost / 1000.0 / mConstructions: 0.0) << "ms" << std::endl;
+	out_file.close();
+}
+
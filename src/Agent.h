@@ -60,6 +60,8 @@
 
 class WorldModel;
 class ActiveBehavior;
+class ActiveBehaviorList;
+class ActiveBehaviorPool;
 
 /**
  * Identifies an agent.
@@ -68,10 +70,11 @@ struct AgentID {
 	Unum     mAgentUnum; //总是为正
 	Time     mCurrentTime;
 	bool     mReverse;
+	int      mRevision; //同一周期内世界状态的更新次数，见Updatable::Invalidate()
 
-	AgentID(Unum unum = 0, Time time = Time(-3, 0), bool reverse = false): mAgentUnum(unum), mCurrentTime(time), mReverse(reverse){}
+	AgentID(Unum unum = 0, Time time = Time(-3, 0), bool reverse = false): mAgentUnum(unum), mCurrentTime(time), mReverse(reverse), mRevision(Updatable::Revision()){}
 	bool operator == (const AgentID & o){
-		return mCurrentTime == o.mCurrentTime && mAgentUnum == o.mAgentUnum && mReverse == o.mReverse;
+		return mCurrentTime == o.mCurrentTime && mAgentUnum == o.mAgentUnum && mReverse == o.mReverse && mRevision == o.mRevision;
 	}
 	bool operator != (const AgentID & o){
 		return !(*this == o);
@@ -110,6 +113,14 @@ public:
 	 */
 	Agent * CreateOpponentAgent(Unum unum); ///反算对手
 
+	/**
+	 * 从本 Agent 的池里取反算队友/对手用的 Agent，由本 Agent 持有，调用者不要 delete。
+	 * 世界状态没变（周期、版本和修改标记都相同）时直接复用上次算好的派生信息，
+	 * 否则让它的派生信息在用到时重新计算。
+	 */
+	Agent & GetTeammateAgent(Unum unum);
+	Agent & GetOpponentAgent(Unum unum);
+
 	/**
 	 * Interfaces to get the agent's world state.
 	 */
@@ -122,6 +133,11 @@ public:
 	InfoState        & Info() {	return *mpInfoState; }
 	const InfoState  & GetInfoState() const { return *mpInfoState; }
 
+	/**
+	 * 决策时 ActiveBehavior 用的内存池
+	 */
+	ActiveBehaviorPool & GetActiveBehaviorPool() { return *mpActiveBehaviorPool; }
+
 	/**
 	 * 自己相关的接口
 	 * Interfaces to get information about the agent it self.
@@ -245,6 +261,9 @@ public:
      */
 	void CheckCommands(Observer *observer) { mIsNewSight = observer->IsNewSight();mBallSeenTime = observer->Ball().GetDist().time(); GetActionEffector().CheckCommands(observer); }
 
+	/** 推测决策后重新决策前调用，撤销本周期的命令和行为 */
+	void ResetForReplan(Observer *observer) { mIsNewSight = observer->IsNewSight(); mBallSeenTime = observer->Ball().GetDist().time(); GetActionEffector().ResetForReplan(observer); ResetActiveBehaviors(); }
+
 	/**
 	 * Interface to ActionEffector::SendCommands.
 	 */
@@ -275,6 +294,7 @@ private:
 	/** 以上变量在 Agent 的生存周期内是不会变的，各种形式的反算（包括反算队友和对手）都要 new 一个 Agent */
 
 	InfoState  * mpInfoState;
+	ActiveBehaviorPool * mpActiveBehaviorPool;
 
 	bool mIsNewSight;
 	Time mBallSeenTime;
@@ -321,6 +341,11 @@ public:
 
     void SetHistoryActiveBehaviors();
 
+    /**
+     * 清除本周期已经保存的activebehavior -- 重新决策前调用
+     */
+    void ResetActiveBehaviors();
+
 private:
     /**
      * 保存behavior*决策出的最优activebehavior -- plan结束时保存
@@ -330,7 +355,13 @@ private:
 
     friend class DecisionTree;
 
-    void SaveActiveBehaviorList(const std::list<ActiveBehavior> & behavior_list);
+    void SaveActiveBehaviorList(const ActiveBehaviorList & behavior_list);
+
+    /**
+     * 多层搜索改变了选择时，用选中的行为替换保存的同类行为 -- 不比较评价
+     * @param beh
+     */
+    void ReplaceActiveBehavior(const ActiveBehavior & beh);
 
     /**
      * 设置本周期实际执行的activebehavior -- excute时设置
@@ -341,6 +372,44 @@ private:
 private:
 	Array<ActiveBehavior*, BT_Max, true> mActiveBehavior;
 	Array<ActiveBehavior*, BT_Max, true> mLastActiveBehavior;
+
+private:
+	Agent & AcquirePooledAgent(Agent *& slot, Unum unum, bool reverse);
+
+	/** 反算用的 Agent 池，第一次用到时生成 */
+	Array<Agent *, TEAMSIZE + 1, true> mpTeammateAgents;
+	Array<Agent *, TEAMSIZE + 1, true> mpOpponentAgents;
+
+	/** 做为池里的 Agent 最近一次被取出时世界状态的标记 */
+	Time mPoolTime;
+	int mPoolRevision;
+	long mPoolStamp;
+};
+
+/**
+ * 反算 Agent 池的生成和复用情况，time_test打开时统计，结束时写到Test/AgentPool-<unum>.txt
+ */
+class AgentPoolTest {
+	AgentPoolTest();
+
+public:
+	~AgentPoolTest();
+
+	static AgentPoolTest & instance();
+
+	void SetUnum(int unum) { mUnum = unum; }
+
+	void AddConstruction(long cost);
+	void AddAcquire(bool reused, long cost);
+
+private:
+	int mUnum;
+
+	long mConstructions;
+	long mConstructionCost; // 微秒
+	long mAcquires;
+	long mReuses; // 派生信息直接复用的次数
+	long mUpdateCost; // 需要重新计算时，使派生信息失效、转存保存的行为的耗时，微秒
 };
 
 #endif /* AGENT_H_ */
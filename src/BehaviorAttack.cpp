@@ -121,7 +121,7 @@ BehaviorAttackPlanner::~BehaviorAttackPlanner()
  * @note 视觉请求优化：非最优行为也会提交视觉请求以支持决策
  * @note 视觉请求优先级按指数增长，确保重要信息优先获取
  */
-void BehaviorAttackPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorAttackPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 特殊条件检查 ===
 	// 如果自己可以接球，且对手刚控制球，且上一行为不是传球或带球，则不执行进攻行为
@@ -141,7 +141,7 @@ void BehaviorAttackPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 	if (!mActiveBehaviorList.empty()) {
 		// === 行为排序和选择 ===
 		// 按评估分数从高到低排序
-		mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+		mActiveBehaviorList.SortDescending();
 		
 		// 将最优行为添加到结果列表中
 		behavior_list.push_back(mActiveBehaviorList.front());
@@ -40,7 +40,7 @@ public:
 	BehaviorAttackPlanner(Agent & agent);
 	virtual ~BehaviorAttackPlanner();
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 #endif /* BEHAVIORATTACK_H_ */
@@ -67,6 +67,8 @@
 #include "Strategy.h"
 #include "Analyser.h"
 #include "Logger.h"
+#include "PlayerParam.h"
+#include <algorithm>
 
 /**
  * @brief BehaviorAttackData 构造函数
@@ -212,6 +214,120 @@ void ActiveBehavior::SubmitVisualRequest(double plus)
 	}
 }
 
+ActiveBehaviorPool::~ActiveBehaviorPool()
+{
+	for (std::vector<std::vector<ActiveBehavior> *>::iterator it = mFreeBuffers.begin(); it != mFreeBuffers.end(); ++it) {
+		delete *it;
+	}
+
+	for (std::vector<ActiveBehavior *>::iterator it = mFreeBehaviors.begin(); it != mFreeBehaviors.end(); ++it) {
+		delete *it;
+	}
+}
+
+std::vector<ActiveBehavior> * ActiveBehaviorPool::AcquireBuffer()
+{
+	if (mFreeBuffers.empty()) {
+		return new std::vector<ActiveBehavior>;
+	}
+
+	std::vector<ActiveBehavior> * buffer = mFreeBuffers.back();
+	mFreeBuffers.pop_back();
+	return buffer;
+}
+
+void ActiveBehaviorPool::ReleaseBuffer(std::vector<ActiveBehavior> * buffer)
+{
+	buffer->clear();
+	mFreeBuffers.push_back(buffer);
+}
+
+ActiveBehavior * ActiveBehaviorPool::Clone(const ActiveBehavior & beh)
+{
+	if (mFreeBehaviors.empty()) {
+		return new ActiveBehavior(beh);
+	}
+
+	ActiveBehavior * result = mFreeBehaviors.back();
+	mFreeBehaviors.pop_back();
+	*result = beh;
+	return result;
+}
+
+void ActiveBehaviorPool::Recycle(ActiveBehavior * beh)
+{
+	if (beh) {
+		mFreeBehaviors.push_back(beh);
+	}
+}
+
+ActiveBehaviorList::ActiveBehaviorList(Agent & agent):
+	mPool(agent.GetActiveBehaviorPool()),
+	mpBuffer(mPool.AcquireBuffer())
+{
+}
+
+ActiveBehaviorList::~ActiveBehaviorList()
+{
+	mPool.ReleaseBuffer(mpBuffer);
+}
+
+void ActiveBehaviorList::SelectBest()
+{
+	std::vector<ActiveBehavior> & list = *mpBuffer;
+
+	size_t best = 0;
+	for (size_t i = 1; i < list.size(); ++i) {
+		if (list[i] > list[best]) {
+			best = i;
+		}
+	}
+
+	if (best != 0) {
+		std::swap(list[0], list[best]);
+	}
+}
+
+void ActiveBehaviorList::SortDescending()
+{
+	std::vector<ActiveBehavior> & list = *mpBuffer;
+
+	for (size_t i = 1; i < list.size(); ++i) {
+		if (!(list[i] > list[i - 1])) continue;
+
+		ActiveBehavior beh = list[i];
+		size_t j = i;
+		for (; j > 0 && beh > list[j - 1]; --j) {
+			list[j] = list[j - 1];
+		}
+		list[j] = beh;
+	}
+}
+
+PlanStatistics::PlanStatistics()
+{
+}
+
+PlanStatistics & PlanStatistics::instance()
+{
+	static PlanStatistics statistics;
+	return statistics;
+}
+
+void PlanStatistics::Record(const Time & time, BehaviorType type, int evaluated, int skipped)
+{
+	Assert(type > BT_None && type < BT_Max);
+
+	mEvaluated[type] += evaluated;
+	mSkipped[type] += skipped;
+
+	if (PlayerParam::instance().SaveTextLog()) {
+		const long total = mEvaluated[type] + mSkipped[type];
+		Logger::instance().GetTextLogger("plan") << time << ": " << BehaviorFactory::instance().GetBehaviorName(type) << " evaluated " << evaluated << ", skipped " << skipped
+				<< " (overall " << (total? 100.0 * mSkipped[type] / total: 0.0) << "% skipped)" << std::endl;
+	}
+}
+
 BehaviorFactory::BehaviorFactory()
 {
 }
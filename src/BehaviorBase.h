@@ -55,6 +55,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 #include "Geometry.h"
 #include "ActionEffector.h"
 #include "Formation.h"
@@ -250,6 +251,94 @@ public:
 	double mBuffer; //有些行为执行时的buffer是在plan时算好的，要先存到这个变量里
 };
 
+/**
+ * ActiveBehavior 的内存池，每个 Agent 一个。
+ * ActiveBehaviorList 构造时借一个缓冲区，析构时还回来，缓冲区保留容量；
+ * Agent 保存各类最优 ActiveBehavior 时也从这里取，不用时放回。
+ * 这样稳定后每周期决策时不再为 ActiveBehavior 分配内存。
+ */
+class ActiveBehaviorPool {
+	ActiveBehaviorPool(const ActiveBehaviorPool &);
+	const ActiveBehaviorPool & operator=(const ActiveBehaviorPool &);
+
+public:
+	ActiveBehaviorPool() {}
+	~ActiveBehaviorPool();
+
+	std::vector<ActiveBehavior> * AcquireBuffer();
+	void ReleaseBuffer(std::vector<ActiveBehavior> * buffer);
+
+	ActiveBehavior * Clone(const ActiveBehavior & beh);
+	void Recycle(ActiveBehavior * beh);
+
+private:
+	std::vector<std::vector<ActiveBehavior> *> mFreeBuffers;
+	std::vector<ActiveBehavior *> mFreeBehaviors;
+};
+
+/**
+ * 存放 Plan 结果的列表，接口与原来用的 std::list 相同的部分保持不变。
+ * 只需要最优的一个时用 SelectBest()，不用整个排序。
+ */
+class ActiveBehaviorList {
+	ActiveBehaviorList(const ActiveBehaviorList &);
+	const ActiveBehaviorList & operator=(const ActiveBehaviorList &);
+
+public:
+	typedef std::vector<ActiveBehavior>::iterator iterator;
+	typedef std::vector<ActiveBehavior>::const_iterator const_iterator;
+
+	explicit ActiveBehaviorList(Agent & agent);
+	~ActiveBehaviorList();
+
+	bool empty() const { return mpBuffer->empty(); }
+	size_t size() const { return mpBuffer->size(); }
+	void clear() { mpBuffer->clear(); }
+	void push_back(const ActiveBehavior & beh) { mpBuffer->push_back(beh); }
+
+	ActiveBehavior & front() { return mpBuffer->front(); }
+	const ActiveBehavior & front() const { return mpBuffer->front(); }
+
+	iterator begin() { return mpBuffer->begin(); }
+	iterator end() { return mpBuffer->end(); }
+	const_iterator begin() const { return mpBuffer->begin(); }
+	const_iterator end() const { return mpBuffer->end(); }
+
+	/**
+	 * 把评价最高的（相同时取先加入的，与稳定排序后的 front() 一致）换到最前面，其余的顺序不保证
+	 */
+	void SelectBest();
+
+	/**
+	 * 按评价从高到低稳定排序，列表很短，用插入排序，不分配内存
+	 */
+	void SortDescending();
+
+private:
+	ActiveBehaviorPool & mPool;
+	std::vector<ActiveBehavior> * mpBuffer;
+};
+
+/**
+ * 各 planner 评价过和用界跳过的候选数。planner 每次 Plan 结束时记录一次，
+ * 打开 save_text_log 时按周期写到 "plan" 日志，同时给出累计的跳过比例。
+ */
+class PlanStatistics {
+	PlanStatistics();
+
+public:
+	static PlanStatistics & instance();
+
+	void Record(const Time & time, BehaviorType type, int evaluated, int skipped);
+
+	long GetEvaluated(BehaviorType type) const { return mEvaluated[type]; }
+	long GetSkipped(BehaviorType type) const { return mSkipped[type]; }
+
+private:
+	Array<long, BT_Max, true> mEvaluated;
+	Array<long, BT_Max, true> mSkipped;
+};
+
 class BehaviorAttackData {
 public:
 	BehaviorAttackData(Agent & agent);
@@ -283,21 +372,21 @@ class BehaviorPlannerBase: public BehaviorDataType {
 	BehaviorPlannerBase(const BehaviorPlannerBase &);
 
 public:
-	BehaviorPlannerBase(Agent & agent): BehaviorDataType(agent) {}
+	BehaviorPlannerBase(Agent & agent): BehaviorDataType(agent), mActiveBehaviorList(agent) {}
 	virtual ~BehaviorPlannerBase() {}
 
 	/**
 	* 做决策，产生最好的ActiveBehavior，存到behavior_list里面
 	*/
-	virtual void Plan(std::list<ActiveBehavior> & behavior_list) = 0;
+	virtual void Plan(ActiveBehaviorList & behavior_list) = 0;
 
 public:
-	const std::list<ActiveBehavior> & GetActiveBehaviorList() {
+	const ActiveBehaviorList & GetActiveBehaviorList() {
 		return mActiveBehaviorList;
 	}
 
 protected:
-	std::list<ActiveBehavior> mActiveBehaviorList; // record the active behaviors for each high level behavior
+	ActiveBehaviorList mActiveBehaviorList; // record the active behaviors for each high level behavior
 };
 
 class BehaviorExecutable {
@@ -355,8 +444,7 @@ public:
 };
 
 
-typedef std::list<ActiveBehavior> ActiveBehaviorList;
-typedef std::list<ActiveBehavior>::iterator ActiveBehaviorPtr;
+typedef ActiveBehaviorList::iterator ActiveBehaviorPtr;
 
 #define TeammateFormationTactic(TacticName) (*(FormationTactic##TacticName *)mFormation.GetTeammateTactic(FTT_##TacticName))
 #define OpponentFormationTactic(TacticName) (*(FormationTactic##TacticName *)mFormation.GetOpponentTactic(FTT_##TacticName))
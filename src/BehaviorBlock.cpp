@@ -169,7 +169,7 @@ BehaviorBlockPlanner::~BehaviorBlockPlanner()
  * @note 使用分析器的灯塔位置作为目标位置
  * @note 会考虑体力状况调整跑动力度
  */
-void BehaviorBlockPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorBlockPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 获取最近球的队友 ===
 	Unum closest_tm = mPositionInfo.GetClosestTeammateToBall();
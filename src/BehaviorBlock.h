@@ -51,7 +51,7 @@ public:
 	BehaviorBlockPlanner(Agent & agent);
 	virtual ~BehaviorBlockPlanner();
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 #endif /* BEHAVIORFORMATION_H_ */
@@ -117,7 +117,7 @@ BehaviorDefensePlanner::~BehaviorDefensePlanner()
  * @note 视觉请求优化：非最优行为也会提交视觉请求以支持决策
  * @note 视觉请求优先级按指数增长，确保重要信息优先获取
  */
-void BehaviorDefensePlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorDefensePlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 按优先级顺序规划各种防守行为 ===
 	// 每个规划器都会将生成的行为添加到mActiveBehaviorList中
@@ -129,7 +129,7 @@ void BehaviorDefensePlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 	if (!mActiveBehaviorList.empty()) {
 		// === 行为排序和选择 ===
 		// 按评估分数从高到低排序
-		mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+		mActiveBehaviorList.SortDescending();
 		
 		// 将最优行为添加到结果列表中
 		behavior_list.push_back(mActiveBehaviorList.front());
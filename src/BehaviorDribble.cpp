@@ -236,18 +236,21 @@ BehaviorDribblePlanner::~BehaviorDribblePlanner(void)
 }
 
 
-void BehaviorDribblePlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorDribblePlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	if (!mSelfState.IsKickable()) return;
 	if (mStrategy.IsForbidenDribble()) return;
 	if (mSelfState.IsGoalie()) return;
 
-	for (AngleDeg dir = -90.0; dir < 90.0; dir += 2.5) {
-		ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Normal);
+	const std::vector<Unum> & opp2ball = mPositionInfo.GetCloseOpponentToBall();
+	const double speed = mSelfState.GetEffectiveSpeedMax();
 
-		dribble.mAngle = dir;
+	//先做不用评价的过滤，剩下的才需要评价
+	Array<bool, DIR_COUNT, true> normal_valid;
+	Array<bool, DIR_COUNT, true> fast_valid;
 
-		const std::vector<Unum> & opp2ball = mPositionInfo.GetCloseOpponentToBall();
+	for (int k = 0; k < DIR_COUNT; ++k) {
+		const AngleDeg dir = GetDir(k);
 		AngleDeg min_differ = HUGE_VALUE;
 
 		for (uint j = 0; j < opp2ball.size(); ++j) {
@@ -260,50 +263,147 @@ void BehaviorDribblePlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 			}
 		}
 
-		if (min_differ < 10.0) continue;
-
-		dribble.mTarget= mSelfState.GetPos() + Polar2Vector( mSelfState.GetEffectiveSpeedMax(), dir);
-
-		dribble.mEvaluation = Evaluation::instance().EvaluatePosition(dribble.mTarget, true);
-
-		mActiveBehaviorList.push_back(dribble);
+		normal_valid[k] = min_differ >= 10.0;
 	}
-	double speed = mSelfState.GetEffectiveSpeedMax();
 
-	for (AngleDeg dir = -90.0; dir < 90.0; dir += 2.5) {
-		ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Fast);
-		dribble.mKickSpeed = speed;
-		dribble.mAngle = dir;
-
-		const std::vector<Unum> & opp2ball = mPositionInfo.GetCloseOpponentToBall();
-		Vector target = mBallState.GetPos() + Polar2Vector(dribble.mKickSpeed * 10, dribble.mAngle);
+	for (int k = 0; k < DIR_COUNT; ++k) {
+		Vector target = mBallState.GetPos() + Polar2Vector(speed * 10, GetDir(k));
 		if(!ServerParam::instance().pitchRectanglar().IsWithin(target)){
 			continue;
 		}
 		bool ok = true;
 		for (uint j = 0; j < opp2ball.size(); ++j) {
 			Vector rel_pos = mWorldState.GetOpponent(opp2ball[j]).GetPos() - target;
-			if (rel_pos.Mod() < dribble.mKickSpeed * 12 ||
+			if (rel_pos.Mod() < speed * 12 ||
 					mWorldState.GetOpponent(opp2ball[j]).GetPosConf() < PlayerParam::instance().minValidConf()){
 				ok = false;
 				break;
 			}
 		}
-		if(!ok){
+		fast_valid[k] = ok;
+	}
+
+	double best = -HUGE_VALUE;
+	int evaluated = 0;
+	int skipped = 0;
+
+	//上周期保存的带球行为及其邻域先评价，尽早得到一个好的界
+	const ActiveBehavior * last = mAgent.GetLastActiveBehavior(BT_Dribble);
+	if (last != 0) {
+		const bool fast = last->mDetailType == BDT_Dribble_Fast;
+		const int center = int(floor((GetNormalizeAngleDeg(last->mAngle) + 90.0) / 2.5 + 0.5));
+
+		for (int k = Max(center - WARM_START_RADIUS, 0); k <= Min(center + WARM_START_RADIUS, DIR_COUNT - 1); ++k) {
+			if (fast && fast_valid[k]) {
+				PlanFast(k, best);
+				fast_valid[k] = false;
+				++evaluated;
+			}
+			else if (!fast && normal_valid[k]) {
+				PlanNormal(k, best);
+				normal_valid[k] = false;
+				++evaluated;
+			}
+		}
+	}
+
+	for (int begin = 0; begin < DIR_COUNT; begin += SECTOR_SIZE) {
+		const int end = Min(begin + SECTOR_SIZE, int(DIR_COUNT));
+
+		int remain = 0;
+		for (int k = begin; k < end; ++k) {
+			remain += normal_valid[k];
+		}
+		if (remain == 0) continue;
+
+		if (GetArcUpperBound(mSelfState.GetPos(), speed, GetDir(begin), GetDir(end - 1)) < best) {
+			skipped += remain;
 			continue;
 		}
-		dribble.mEvaluation = 0;
+
+		for (int k = begin; k < end; ++k) {
+			if (normal_valid[k]) {
+				PlanNormal(k, best);
+				++evaluated;
+			}
+		}
+	}
+
+	for (int begin = 0; begin < DIR_COUNT; begin += SECTOR_SIZE) {
+		const int end = Min(begin + SECTOR_SIZE, int(DIR_COUNT));
+
+		int remain = 0;
+		for (int k = begin; k < end; ++k) {
+			remain += fast_valid[k];
+		}
+		if (remain == 0) continue;
+
+		double bound = 0.0;
 		for (int i = 1; i <= 8; ++i) {
-			dribble.mEvaluation += Evaluation::instance().EvaluatePosition(mBallState.GetPos() + Polar2Vector(dribble.mKickSpeed * i, dribble.mAngle), true);
+			bound += GetArcUpperBound(mBallState.GetPos(), speed * i, GetDir(begin), GetDir(end - 1));
+		}
+		if (bound / 8 < best) {
+			skipped += remain;
+			continue;
 		}
-		dribble.mEvaluation /= 8;
-		dribble.mTarget = target;
 
-		mActiveBehaviorList.push_back(dribble);
+		for (int k = begin; k < end; ++k) {
+			if (fast_valid[k]) {
+				PlanFast(k, best);
+				++evaluated;
+			}
+		}
 	}
 
+	PlanStatistics::instance().Record(mWorldState.CurrentTime(), BT_Dribble, evaluated, skipped);
+
 	if (!mActiveBehaviorList.empty()) {
-		mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+		mActiveBehaviorList.SelectBest();
 		behavior_list.push_back(mActiveBehaviorList.front());
 	}
 }
+
+void BehaviorDribblePlanner::PlanNormal(int k, double & best)
+{
+	ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Normal);
+
+	dribble.mAngle = GetDir(k);
+	dribble.mTarget= mSelfState.GetPos() + Polar2Vector( mSelfState.GetEffectiveSpeedMax(), dribble.mAngle);
+	dribble.mEvaluation = Evaluation::instance().EvaluatePosition(dribble.mTarget, true);
+
+	best = Max(best, dribble.mEvaluation);
+	mActiveBehaviorList.push_back(dribble);
+}
+
+void BehaviorDribblePlanner::PlanFast(int k, double & best)
+{
+	ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Fast);
+	dribble.mKickSpeed = mSelfState.GetEffectiveSpeedMax();
+	dribble.mAngle = GetDir(k);
+
+	dribble.mEvaluation = 0;
+	for (int i = 1; i <= 8; ++i) {
+		dribble.mEvaluation += Evaluation::instance().EvaluatePosition(mBallState.GetPos() + Polar2Vector(dribble.mKickSpeed * i, dribble.mAngle), true);
+	}
+	dribble.mEvaluation /= 8;
+	dribble.mTarget = mBallState.GetPos() + Polar2Vector(dribble.mKickSpeed * 10, dribble.mAngle);
+
+	best = Max(best, dribble.mEvaluation);
+	mActiveBehaviorList.push_back(dribble);
+}
+
+/**
+ * 圆弧上的点离弦的距离不超过弓高 radius * (1 - cos(span / 2))，
+ * 所以弦两端点的外接矩形四边各外扩一个弓高就包住了整段圆弧
+ */
+double BehaviorDribblePlanner::GetArcUpperBound(const Vector & center, double radius, AngleDeg from, AngleDeg to)
+{
+	const Vector p1 = center + Polar2Vector(radius, from);
+	const Vector p2 = center + Polar2Vector(radius, to);
+	const double sagitta = radius * (1.0 - Cos((to - from) * 0.5)) + FLOAT_EPS;
+
+	const Vector low(Min(p1.X(), p2.X()) - sagitta, Min(p1.Y(), p2.Y()) - sagitta);
+	const Vector high(Max(p1.X(), p2.X()) + sagitta, Max(p1.Y(), p2.Y()) + sagitta);
+
+	return Evaluation::instance().EvaluatePositionUpperBound(low, high, true);
+}
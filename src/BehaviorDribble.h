@@ -63,7 +63,28 @@ public:
     BehaviorDribblePlanner(Agent & agent);
     virtual ~BehaviorDribblePlanner(void);
 
-    void Plan(std::list<ActiveBehavior> & behavior_list);
+    void Plan(ActiveBehaviorList & behavior_list);
+
+private:
+	/**
+	 * 两组候选都是 -90 到 90 度每2.5度一个方向。上周期选中的带球方向前后 WARM_START_RADIUS 个先评价，
+	 * 其余按每 SECTOR_SIZE 个方向一组，整组评价的上界不超过已有的最好评价时整组跳过。
+	 */
+	enum {
+		DIR_COUNT = 72,
+		WARM_START_RADIUS = 2,
+		SECTOR_SIZE = 6
+	};
+
+	static AngleDeg GetDir(int k) { return -90.0 + 2.5 * k; }
+
+	void PlanNormal(int k, double & best);
+	void PlanFast(int k, double & best);
+
+	/**
+	 * 以 center 为圆心、radius 为半径，方向在 [from, to] 内的圆弧上各点位置评价的上界
+	 */
+	static double GetArcUpperBound(const Vector & center, double radius, AngleDeg from, AngleDeg to);
 };
 
 
@@ -173,7 +173,7 @@ BehaviorFormationPlanner::~BehaviorFormationPlanner()
  * @note 防守球员有特殊的位置优化逻辑
  * @note 使用评估系统评估位置质量
  */
-void BehaviorFormationPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorFormationPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 创建阵型行为 ===
 	ActiveBehavior formation(mAgent, BT_Formation);
@@ -182,7 +182,7 @@ BehaviorGoalieExecuter::~BehaviorGoalieExecuter(void)
  * @note 使用射线理论计算最佳守门位置
  * @note 位置选择受禁区限制
  */
-void BehaviorGoaliePlanner::Plan(std::list<ActiveBehavior>& behavior_list)
+void BehaviorGoaliePlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 检查行为冲突 ===
 	// 如果刚完成传球或带球动作，不执行守门员行为
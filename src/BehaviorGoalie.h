@@ -62,7 +62,7 @@ public:
     BehaviorGoaliePlanner(Agent& agent);
     virtual ~BehaviorGoaliePlanner(void);
 
-    void Plan(std::list<ActiveBehavior>& behavior_list);
+    void Plan(ActiveBehaviorList & behavior_list);
 };
 #endif
 
@@ -209,7 +209,7 @@ BehaviorHoldPlanner::~BehaviorHoldPlanner(void)
  * @note 守门员不进行持球规划
  * @note 根据对手威胁程度动态调整持球策略
  */
-void BehaviorHoldPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorHoldPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 检查踢球条件 ===
 	// 只有在可以踢球的情况下才考虑持球
@@ -266,7 +266,7 @@ void BehaviorHoldPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 		}
 
 		if (!mActiveBehaviorList.empty()) {
-			mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+			mActiveBehaviorList.SelectBest();
 			behavior_list.push_back(mActiveBehaviorList.front());
 		}
 	}
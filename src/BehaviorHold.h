@@ -54,7 +54,7 @@ public:
     BehaviorHoldPlanner(Agent & agent);
     virtual ~BehaviorHoldPlanner(void);
 
-    void Plan(std::list<ActiveBehavior> & behavior_list);
+    void Plan(ActiveBehaviorList & behavior_list);
 };
 
 
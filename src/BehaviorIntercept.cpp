@@ -193,7 +193,7 @@ BehaviorInterceptPlanner::~BehaviorInterceptPlanner() {
  * @note 特殊处理守门员的截球逻辑
  * @note 使用几何计算确定守门员截球点
  */
-void BehaviorInterceptPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorInterceptPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 检查踢球条件 ===
 	// 如果已经可以踢球，则不需要截球
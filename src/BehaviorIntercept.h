@@ -58,7 +58,7 @@ public:
 	BehaviorInterceptPlanner(Agent & agent);
 	virtual ~BehaviorInterceptPlanner();
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 #endif /* BEHAVIORINTERCEPT_H_ */
@@ -178,7 +178,7 @@ BehaviorMarkPlanner::~BehaviorMarkPlanner()
  * @note 使用可踢球区域作为防守距离，确保能有效拦截
  * @note 防守球员有特殊的评估方式
  */
-void BehaviorMarkPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorMarkPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 找到需要标记的对手 ===
 	Unum closest_opp = mPositionInfo.GetClosestOpponentToTeammate(mSelfState.GetUnum());  // 离自己最近的对手
@@ -76,6 +76,7 @@
 #include "CommunicateSystem.h"
 #include "TimeTest.h"
 #include "Evaluation.h"
+#include "RolloutEvaluator.h"
 
 #include <sstream>
 using namespace std;
@@ -241,7 +242,7 @@ BehaviorPassPlanner::~BehaviorPassPlanner(void)
  * @note 传球决策考虑队友位置和对手威胁
  * @note 支持多种传球策略的智能选择
  */
-void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorPassPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	// === 检查踢球条件 ===
 	// 只有在可以踢球的情况下才考虑传球
@@ -254,6 +255,12 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 
 	PlayerState oppState = mWorldState.GetOpponent( _opp );
 	bool oppClose = oppState.IsKickable()|| oppState.GetTackleProb(true) > 0.65 ;
+
+	//打开pass_rollout时不再用10度的角度过滤，而是对每个候选做带噪声的模拟，见RolloutEvaluator
+	const bool use_rollout = PlayerParam::instance().PassRollout();
+	std::vector<ActiveBehavior> rollout_passes;
+	std::vector<RolloutEvaluator::PassTask> rollout_tasks;
+
 	for (uint i = 0; i < tm2ball.size(); ++i) {
 		ActiveBehavior pass(mAgent, BT_Pass);
 
@@ -276,7 +283,7 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 			}
 		}
 
-		if (min_differ < 10.0) continue;
+		if (!use_rollout && min_differ < 10.0) continue;
 
 		pass.mEvaluation = Evaluation::instance().EvaluatePosition(pass.mTarget, true);
 
@@ -287,10 +294,39 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 			pass.mDetailType = BDT_Pass_Clear;
 		}
 		else pass.mDetailType = BDT_Pass_Direct;
-		mActiveBehaviorList.push_back(pass);
+
+		if (!use_rollout) {
+			mActiveBehaviorList.push_back(pass);
+		}
+		else {
+			rollout_passes.push_back(pass);
+			rollout_tasks.push_back(RolloutEvaluator::PassTask(mBallState.GetPos(), Polar2Vector(pass.mKickSpeed, (pass.mTarget - mBallState.GetPos()).Dir()),
+					mWorldState.GetTeammate(tm2ball[i]), PlayerParam::instance().PassRolloutSamples()));
+			for (uint j = 0; j < opp2tm.size(); ++j) {
+				rollout_tasks.back().mOpponents.push_back(RolloutEvaluator::Chaser(mWorldState.GetOpponent(opp2tm[j])));
+			}
+		}
+	}
+
+	if (!rollout_tasks.empty()) {
+		//期望收益：成功率乘以成功时平均接球点的评价；一次都没成功的与原来被角度过滤掉的一样不考虑
+		RolloutEvaluator::instance().Evaluate(rollout_tasks, PlayerParam::instance().PassRolloutBudget());
+
+		for (uint k = 0; k < rollout_tasks.size(); ++k) {
+			const RolloutEvaluator::PassTask & task = rollout_tasks[k];
+			if (task.mSuccess > 0) {
+				rollout_passes[k].mEvaluation = task.GetSuccessProb() * Evaluation::instance().EvaluatePosition(task.GetMeanSuccessPos(), true);
+				mActiveBehaviorList.push_back(rollout_passes[k]);
+			}
+		}
+
+		if (PlayerParam::instance().SaveTextLog()) {
+			Logger::instance().GetTextLogger("rollout") << mWorldState.CurrentTime() << ": " << rollout_tasks.size() << " passes, "
+					<< RolloutEvaluator::instance().GetLastRolloutsPerMs() << " rollouts/ms (" << RolloutEvaluator::instance().GetRolloutsPerMs() << " overall)" << std::endl;
+		}
 	}
 	if (!mActiveBehaviorList.empty()) {
-		mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+		mActiveBehaviorList.SelectBest();
 		if(mActiveBehaviorList.front().mDetailType == BDT_Pass_Clear){
 			mActiveBehaviorList.front().mEvaluation = 1.0 + FLOAT_EPS;
 		}
@@ -306,37 +342,59 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 			behavior_list.push_back(pass);
 		}
 		if(oppClose){
-			Vector p;
-			BallState SimBall = mBallState;
-			int MinTmInter = HUGE_VALUE, MinOppInter = HUGE_VALUE, MinTm;
-			Vector MinTmPos;
-			for(AngleDeg dir = -45 ; dir <= 45  ; dir += 2.5){
+			//先算出所有方向的出球速度，再逐个方向求截球；MinTmInter和MinOppInter在各方向间是累积的最小值，
+			//截球周期下界不小于当前最小值的球员不可能更新它们，直接跳过，不必解截球模型
+			const int dir_count = 37; //-45 -> 45，每2.5度一个
+			Array<Vector, dir_count> ball_vel;
+			for (int k = 0; k < dir_count; ++k) {
+				const AngleDeg dir = -45 + 2.5 * k;
 				if(!Tackler::instance().CanTackleToDir(mAgent,dir)){
-					SimBall.UpdateVel(Polar2Vector(Kicker::instance().GetMaxSpeed(mAgent,mSelfState.GetBodyDir() + dir,1),mSelfState.GetBodyDir() + dir),0,1.0);
+					ball_vel[k] = Polar2Vector(Kicker::instance().GetMaxSpeed(mAgent,mSelfState.GetBodyDir() + dir,1),mSelfState.GetBodyDir() + dir);
 				}
 				else
-					SimBall.UpdateVel(Polar2Vector(Max(Tackler::instance().GetBallVelAfterTackle(mAgent,dir).Mod(), Kicker::instance().GetMaxSpeed(mAgent,mSelfState.GetBodyDir() + dir,1)),mSelfState.GetBodyDir() + dir),0,1.0);
+					ball_vel[k] = Polar2Vector(Max(Tackler::instance().GetBallVelAfterTackle(mAgent,dir).Mod(), Kicker::instance().GetMaxSpeed(mAgent,mSelfState.GetBodyDir() + dir,1)),mSelfState.GetBodyDir() + dir);
+			}
+
+			Vector p;
+			BallState SimBall = mBallState;
+			PlayerInterceptInfo int_info;
+			int MinTmInter = HUGE_VALUE, MinOppInter = HUGE_VALUE;
+			int evaluated = 0, skipped = 0;
+			Vector MinTmPos;
+			for(int k = 0; k < dir_count; ++k){
+				const AngleDeg dir = -45 + 2.5 * k;
+				SimBall.UpdateVel(ball_vel[k],0,1.0);
 				for(int i = 2 ; i <= 11 ; i ++){
 					if(fabs((mWorldState.GetTeammate(i).GetPos() - mSelfState.GetPos()).Dir() - dir) > 45 ){
 						continue;
 					}
 					if(!mWorldState.GetPlayer(i).IsAlive()){continue;}
-					PlayerInterceptInfo* a = mInterceptInfo.GetPlayerInterceptInfo(i);
-					mInterceptInfo.CalcTightInterception(SimBall,a,true);
-					if(MinTmInter > (*a).mMinCycle){
-						MinTm= i;
-						MinTmInter = (*a).mMinCycle;
-						MinTmPos = (*a).mInterPos;
+					if(InterceptInfo::GetMinCycleLowerBound(SimBall.GetPos(), mSelfState.GetBodyDir() + dir, mWorldState.GetTeammate(i)) >= MinTmInter){
+						++skipped;
+						continue;
+					}
+					int_info.mpPlayer = & mWorldState.GetTeammate(i);
+					InterceptInfo::CalcTightInterception(SimBall,&int_info,true);
+					++evaluated;
+					if(MinTmInter > int_info.mMinCycle){
+						MinTmInter = int_info.mMinCycle;
+						MinTmPos = int_info.mInterPos;
 					}
 				}
 				for(int i = 1 ; i <= 11 ; i++){
 					if(fabs((mWorldState.GetOpponent(i).GetPos() - mSelfState.GetPos()).Dir() - dir) > 45 ){
 						continue;
 					}
-					PlayerInterceptInfo* a = mInterceptInfo.GetPlayerInterceptInfo(-i);
-					mInterceptInfo.CalcTightInterception(SimBall,a,true);
-					if(MinOppInter > (*a).mMinCycle){
-						MinOppInter = (*a).mMinCycle;
+					if(!mWorldState.GetOpponent(i).IsAlive()){continue;}
+					if(InterceptInfo::GetMinCycleLowerBound(SimBall.GetPos(), mSelfState.GetBodyDir() + dir, mWorldState.GetOpponent(i)) >= MinOppInter){
+						++skipped;
+						continue;
+					}
+					int_info.mpPlayer = & mWorldState.GetOpponent(i);
+					InterceptInfo::CalcTightInterception(SimBall,&int_info,true);
+					++evaluated;
+					if(MinOppInter > int_info.mMinCycle){
+						MinOppInter = int_info.mMinCycle;
 					}
 				}
 				if(MinOppInter > MinTmInter){
@@ -355,8 +413,10 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
 
 				}
 			}
+			PlanStatistics::instance().Record(mWorldState.CurrentTime(), BT_Pass, evaluated, skipped); //解围时每个(方向, 球员)的截球算一个候选
+
 			if (!mActiveBehaviorList.empty()) {
-				mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
+				mActiveBehaviorList.SelectBest();
 				behavior_list.push_back(mActiveBehaviorList.front());
 			}
 		}
@@ -65,7 +65,7 @@ public:
 	BehaviorPassPlanner(Agent &agent);
 	virtual ~BehaviorPassPlanner(void);
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 #endif
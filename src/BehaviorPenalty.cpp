@@ -239,7 +239,7 @@ BehaviorPenaltyPlanner::~BehaviorPenaltyPlanner()
  * @note 点球主罚者有特殊的处理逻辑
  * @note 包含精确的时间控制和位置计算
  */
-void BehaviorPenaltyPlanner::Plan(std::list<ActiveBehavior> &behaviorlist)
+void BehaviorPenaltyPlanner::Plan(ActiveBehaviorList & behaviorlist)
 {
 	// === 创建点球行为 ===
 	ActiveBehavior penaltyKO(mAgent, BT_Penalty);
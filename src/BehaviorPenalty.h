@@ -53,7 +53,7 @@ public:
     BehaviorPenaltyPlanner(Agent & agent);
     virtual ~BehaviorPenaltyPlanner(void);
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 
@@ -156,7 +156,7 @@ BehaviorSetplayPlanner::~BehaviorSetplayPlanner(void)
  *
  * @param behavior_list 行为列表
  */
-void BehaviorSetplayPlanner::Plan(std::list<ActiveBehavior> & behavior_list)
+void BehaviorSetplayPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	ActiveBehavior setplay(mAgent, BT_Setplay);
 
@@ -53,7 +53,7 @@ public:
 	BehaviorSetplayPlanner(Agent & agent);
 	virtual ~BehaviorSetplayPlanner();
 
-	void Plan(std::list<ActiveBehavior> & behavior_list);
+	void Plan(ActiveBehaviorList & behavior_list);
 };
 
 #endif
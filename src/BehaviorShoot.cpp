@@ -202,7 +202,7 @@ BehaviorShootPlanner::~BehaviorShootPlanner()
  * Plan.
  * None or one ActiveBehavior will be push back to behavior_list.
  */
-void BehaviorShootPlanner::Plan(list<ActiveBehavior> & behavior_list)
+void BehaviorShootPlanner::Plan(ActiveBehaviorList & behavior_list)
 {
 	if (!mSelfState.IsKickable()) return;
 
@@ -79,6 +79,42 @@
 #include "VisualSystem.h"
 #include "InterceptModel.h"
 #include "Plotter.h"
+#include "Evaluation.h"
+#include "TeamProcess.h"
+#include "SchedulingProfile.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+/** 下面各阶段之间没有依赖，可以并行构造；它们读到的参数都是配置文件里的，server发来的参数要等它们构造完才解析 */
+void LoadModels()
+{
+    InterceptModel::instance();             // 截球模型实例
+    Dasher::instance();                      // 跑动系统实例
+    Tackler::instance();                     // 铲球系统实例
+    Kicker::instance();                     // 踢球系统实例，表在球员类型就绪后再准备
+}
+
+void LoadEvaluation()
+{
+    Evaluation::instance();                 // 要读 data/sensitivity.net，以前在第一次决策时才读
+}
+
+void LoadSystems()
+{
+    BehaviorFactory::instance();            // 行为工厂实例
+    VisualSystem::instance();                // 视觉系统实例
+    CommunicateSystem::instance();           // 通信系统实例
+}
+}
+
+void StartupStage::Load()
+{
+	RealTime begin = GetRealTime();
+	mLoader();
+	RealTime end = GetRealTime();
+	mCost = end.Sub(begin);
+}
 
 /**
  * @brief Client 构造函数
@@ -91,15 +127,16 @@
  * 2. 核心组件创建（观察者、世界模型）
  * 3. 辅助实例创建（调试、日志、绘图等）
  * 4. 参数系统初始化
- * 5. 基础模型初始化
- * 6. 智能动作系统初始化
- * 7. 其他实用实例初始化
- * 8. 线程系统初始化
+ * 5. 登记基础模型、智能动作系统等其他实例的构造阶段，见 StartStartupStages
+ * 6. 线程系统初始化
  * 
  * @note 构造函数会创建大量单例实例，需要保证初始化顺序
  * @note 部分实例不能在构造函数中创建，需要时再创建
  */
 Client::Client() {
+	mStartupTime = GetRealTime();
+	mStartupParallel = false;
+
 	// === 随机数种子初始化 ===
 	// 全局随机数种子只初始化一次
 	srand(time(0)); //global srand once
@@ -127,22 +164,14 @@ Client::Client() {
     ServerParam::instance();                 // 服务器参数实例
     PlayerParam::instance();                 // 球员参数实例
 
-	/** Base Model */
-    // 基础模型：截球模型等
-    InterceptModel::instance();             // 截球模型实例
-
-    /** Smart Action */
-    // 智能动作系统：跑动、铲球、踢球等
-    Dasher::instance();                      // 跑动系统实例
-    Tackler::instance();                     // 铲球系统实例
-    Kicker::instance();                     // 踢球系统实例
+    /** Base Model, Smart Action and Other Useful instance */
+    // 截球模型、跑动、铲球、踢球、行为工厂、视觉、通信等互不依赖，
+    // 由StartStartupStages在连接server的同时构造
+    mStartupStages.push_back(new StartupStage("models", LoadModels));
+    mStartupStages.push_back(new StartupStage("evaluation", LoadEvaluation));
+    mStartupStages.push_back(new StartupStage("systems", LoadSystems));
 
-    /** Other Useful instance */
-    // 其他实用实例：行为工厂、网络、视觉、通信等
-    BehaviorFactory::instance();            // 行为工厂实例
     UDPSocket::instance();                   // UDP套接字实例
-    VisualSystem::instance();                // 视觉系统实例
-    CommunicateSystem::instance();           // 通信系统实例
 
 	// === 线程系统初始化 ===
 	/** Parser thread and CommandSend thread */
@@ -153,6 +182,8 @@ Client::Client() {
 
 	mpParser = new Parser(mpObserver);           // 消息解析器
 
+	RealTime end = GetRealTime();
+	AddStartupCost("core", end.Sub(mStartupTime));
 }
 
 /**
@@ -178,11 +209,73 @@ Client::~Client()
 	delete mpObserver;
 	delete mpWorldModel;
 	delete mpAgent;
+
+	for (std::vector<StartupStage*>::iterator it = mStartupStages.begin(); it != mStartupStages.end(); ++it) {
+		delete *it;
+	}
+}
+
+void Client::StartStartupStages(bool parallel)
+{
+	for (std::vector<StartupStage*>::iterator it = mStartupStages.begin(); it != mStartupStages.end(); ++it) {
+		if (parallel) {
+			(*it)->Start();
+		}
+		else {
+			(*it)->Load();
+		}
+	}
+
+	mStartupParallel = parallel;
+}
+
+void Client::JoinStartupStages()
+{
+	for (std::vector<StartupStage*>::iterator it = mStartupStages.begin(); it != mStartupStages.end(); ++it) {
+		if (mStartupParallel) {
+			(*it)->Join();
+		}
+		AddStartupCost((*it)->GetName(), (*it)->GetCost());
+		delete *it;
+	}
+
+	mStartupParallel = false;
+	mStartupStages.clear(); //线程都已结束，只留下用时；析构中的删除只处理没走到这里就退出的情况
+}
+
+void Client::ReportStartupCost()
+{
+	RealTime end = GetRealTime();
+	AddStartupCost("total", end.Sub(mStartupTime));
+
+	if (PlayerParam::instance().SaveTextLog()) {
+		for (std::vector<std::pair<std::string, long> >::iterator it = mStartupCost.begin(); it != mStartupCost.end(); ++it) {
+			Logger::instance().GetTextLogger("startup") << it->first << ": " << it->second / 1000.0 << "ms" << std::endl;
+		}
+	}
+
+	if (PlayerParam::instance().TimeTest()) {
+		char file_name[256];
+		sprintf(file_name, "Test/Startup-%d.txt", mpObserver->SelfUnum());
+
+		std::ofstream out_file(file_name);
+		if (out_file.good() == false) {
+			PRINT_ERROR("open file error  " << file_name);
+			return;
+		}
+
+		for (std::vector<std::pair<std::string, long> >::iterator it = mStartupCost.begin(); it != mStartupCost.end(); ++it) {
+			out_file << it->first << ": " << it->second / 1000.0 << "ms" << std::endl;
+		}
+		out_file.close();
+	}
 }
 
 void Client::RunDynamicDebug()
 {
 	static char msg[MAX_MESSAGE];
+	StartStartupStages(false);
+	JoinStartupStages();
 	DynamicDebug::instance().Initial(mpObserver); // 动态调试的初始化，注意位置不能移动
 
 	DynamicDebug::instance().Run(msg); // 初始化信息
@@ -224,28 +317,40 @@ void Client::RunDynamicDebug()
 
 void Client::RunNormal()
 {
+	SchedulingProfile::instance().Apply(TR_Decision); // 主线程就是决策线程
 
 	mpCommandSender->Start(); //发送命令线程，向server发送信息
 	Logger::instance().Start(); //log线程
 	mpParser->Start(); //分析线程，接受server发来的信息
+	StartStartupStages(PlayerParam::instance().ParallelStartup()); //和连接server同时构造各个表
+
+	RealTime connect_begin = GetRealTime();
+	bool connected = mpParser->WaitForConnectServer(2000); // wait for the parser thread to connect the server
+	RealTime connect_end = GetRealTime();
+	AddStartupCost("connect", connect_end.Sub(connect_begin));
 
-	int past_cycle = 0;
-	do
+	JoinStartupStages();
+	mpParser->SetStartupDone(); // 表都构造完了，Parser才开始解析参数消息
+
+	if (!connected)
 	{
-		WaitFor(100); // wait for the parser thread to connect the server
-		if (++past_cycle > 20)
-		{
-			std::cout << PlayerParam::instance().teamName() << ": Connect Server Error ..." << std::endl;
-			return;
-		}
-	} while (mpParser->IsConnectServerOk() == false);
+		std::cout << PlayerParam::instance().teamName() << ": Connect Server Error ..." << std::endl;
+		return;
+	}
 
 	ConstructAgent();
+	SchedulingProfile::instance().SetUnum(mpObserver->SelfUnum()); // 号码确定后才能分CPU
+	ReportStartupCost();
 
 	SendOptionToServer();
 
 	MainLoop();
 
+	if (PlayerParam::instance().TimeTest()) {
+		TeamProcess::WriteProcessStats(mpObserver->SelfUnum()); // 与 team_process 方式对比用
+		SchedulingProfile::instance().WriteStats();
+	}
+
 	WaitFor(mpObserver->SelfUnum() * 100);
     if (mpObserver->SelfUnum() == 0)
     {
@@ -283,7 +388,7 @@ void Client::ConstructAgent()
 
 void Client::MainLoop()
 {
-	while (mpObserver->WaitForNewInfo()) // 等待新视觉
+	while (mpObserver->WaitForNewInfo(IsSpeculativeDecision())) // 等待新视觉，推测决策时只等sense
 	{
         NetworkTest::instance().AddDecisionBegin();
 
@@ -297,12 +402,18 @@ void Client::MainLoop()
             mpObserver->SetCommandSend();
             Logger::instance().SetFlushCond();
 
+            NetworkTest::instance().WriteCommandReconcile(); // 输出命令对账汇总
+
             break;
         }
 
         DynamicDebug::instance().AddMessage("\0", MT_Run); // 动态调试记录Run信息
         Run();
 
+		if (PlayerParam::instance().TimeTest() || PlayerParam::instance().SaveTextLog()) {
+			SchedulingProfile::instance().AddCycle(mpObserver->CurrentTime());
+		}
+
 		mpObserver->SetPlanned();
 		mpObserver->SetCommandSend(); //唤醒发送命令的线程
 		Logger::instance().SetFlushCond(); // set flush cond and let the logger thread flush the logs to file.
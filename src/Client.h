@@ -49,12 +49,41 @@
 #ifndef CLIENT_H_
 #define CLIENT_H_
 
+#include "Thread.h"
+#include <vector>
+#include <string>
+
 class Observer;
 class WorldModel;
 class Agent;
 class Parser;
 class CommandSender;
 
+/**
+ * 启动时构造一组互不依赖的单例，可以在自己的线程里跑，也可以直接在调用线程里跑
+ */
+class StartupStage: public Thread
+{
+public:
+	typedef void (*Loader)();
+
+	StartupStage(const char * name, Loader loader): mName(name), mLoader(loader), mCost(0) {}
+
+	/** 在调用线程里执行并计时 */
+	void Load();
+
+	const char * GetName() const { return mName; }
+	long GetCost() const { return mCost; } // 微秒
+
+private:
+	void StartRoutine() { Load(); }
+
+private:
+	const char * mName;
+	Loader mLoader;
+	long mCost;
+};
+
 class Client {
 	friend class Player;
 	friend class Coach;
@@ -67,6 +96,11 @@ class Client {
 	Parser 		    *mpParser;
 	CommandSender   *mpCommandSender;
 
+	std::vector<StartupStage*> mStartupStages; // 可以和连接server同时进行的构造阶段
+	std::vector<std::pair<std::string, long> > mStartupCost; // 各阶段用时，微秒
+	RealTime mStartupTime;
+	bool mStartupParallel; // 各阶段是否在自己的线程里
+
 public:
 	Client();
 	virtual ~Client();
@@ -86,6 +120,19 @@ public:
 	*/
 	void MainLoop();
 
+	/**
+	 * 构造各个表和模型：parallel为true时每个阶段一个线程，和连接server同时进行，
+	 * 否则直接在当前线程里依次构造；JoinStartupStages返回后全部完成
+	 */
+	void StartStartupStages(bool parallel);
+	void JoinStartupStages();
+
+	/**
+	 * 记录和输出启动各阶段的用时
+	 */
+	void AddStartupCost(const char * stage, long cost) { mStartupCost.push_back(std::make_pair(std::string(stage), cost)); }
+	void ReportStartupCost();
+
 	/**
 	 * 创建Agent，并完成相关调用
 	 */
@@ -96,6 +143,11 @@ public:
 	*/
 	virtual void Run() = 0;
 
+	/**
+	* 是否在sense到来时就推测决策，视觉到来后再修正，见Player::RunSpeculative()
+	*/
+	virtual bool IsSpeculativeDecision() const { return false; }
+
 	/**
 	* 给server发送一些选项，如synch_see,eye_on等
 	*/
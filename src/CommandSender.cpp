@@ -57,7 +57,7 @@
  * - 判断是否到达“可发送命令”的时机
  * - 获取当前时间戳，用于网络测试统计
  */
-CommandSender::CommandSender(Observer *pObserver): mpObserver(pObserver), mpAgent(0)
+CommandSender::CommandSender(Observer *pObserver): Thread(TR_CommandSender), mpObserver(pObserver), mpAgent(0)
 {
 }
 
@@ -59,6 +59,122 @@
 #include "Agent.h"
 #include "Strategy.h"
 #include "TimeTest.h"
+#include "WorldState.h"
+#include "PlayerParam.h"
+#include "ServerParam.h"
+#include "Logger.h"
+
+//#define __ALLOC_TEST
+
+#ifdef __ALLOC_TEST
+#include <cstdlib>
+#include <new>
+#include <fstream>
+
+/**
+ * 统计决策过程中的内存分配次数：替换全局的 operator new，按线程计数，
+ * 每次 Decision() 前后的差即本次决策的分配次数，结果在 Test/Allocation-<unum>.txt
+ */
+namespace {
+	__thread long allocation_count = 0;
+}
+
+// C++17 不再允许动态异常说明，释放函数按标准版本用 noexcept 或 throw()
+#if __cplusplus >= 201103L
+#define ALLOC_TEST_NOTHROW noexcept
+#else
+#define ALLOC_TEST_NOTHROW throw()
+#endif
+
+void * operator new(std::size_t size)
+{
+	++allocation_count;
+	void * p = malloc(size ? size : 1);
+	if (p == 0) throw std::bad_alloc();
+	return p;
+}
+
+void * operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void * p) ALLOC_TEST_NOTHROW
+{
+	free(p);
+}
+
+void operator delete[](void * p) ALLOC_TEST_NOTHROW
+{
+	free(p);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void * p, std::size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void * p, std::size_t) noexcept
+{
+	free(p);
+}
+#endif
+
+class AllocationTest {
+	AllocationTest(): mUnum(0), mDecisions(0), mAllocations(0), mMaxAllocations(0), mZeroDecisions(0) {}
+
+public:
+	static AllocationTest & instance() { static AllocationTest test; return test; }
+
+	long Count() const { return allocation_count; }
+
+	void AddDecision(Unum unum, long allocations) {
+		mUnum = unum;
+		++mDecisions;
+		mAllocations += allocations;
+		if (allocations > mMaxAllocations) mMaxAllocations = allocations;
+		if (allocations == 0) ++mZeroDecisions;
+	}
+
+	~AllocationTest() {
+		if (mDecisions == 0) return;
+
+		char file_name[256];
+		sprintf(file_name, "Test/Allocation-%d.txt", mUnum);
+
+		std::ofstream out_file(file_name);
+		if (out_file.good() == false) {
+			PRINT_ERROR("open file error  " << file_name);
+			return;
+		}
+
+		out_file << "Decisions: " << mDecisions << std::endl;
+		out_file << "Mean allocations: " << double(mAllocations) / mDecisions << std::endl;
+		out_file << "Max allocations: " << mMaxAllocations << std::endl;
+		out_file << "Decisions without allocation: " << mZeroDecisions << " (" << 100.0 * mZeroDecisions / mDecisions << "%)" << std::endl;
+		out_file.close();
+	}
+
+private:
+	Unum mUnum;
+	long mDecisions;
+	long mAllocations;
+	long mMaxAllocations;
+	long mZeroDecisions;
+};
+#endif
+
+const double DecisionTree::SEARCH_DISCOUNT = 0.5;
+
+DecisionTree::DecisionTree():
+	mSearchCount(0),
+	mSearchDepth(1),
+	mExpandedNodes(0),
+	mTranspositionHits(0),
+	mDepthReached(0)
+{
+}
 
 /**
  * @brief 决策树主决策函数
@@ -80,8 +196,34 @@ bool DecisionTree::Decision(Agent & agent)
 	// 死亡状态的智能体不能进行决策
 	Assert(agent.GetSelf().IsAlive());
 
-	// 搜索最佳行为（step=1表示从第一层开始搜索）
-	ActiveBehavior beh = Search(agent, 1);
+#ifdef __ALLOC_TEST
+	const long allocation_begin = AllocationTest::instance().Count();
+#endif
+
+	// 搜索最佳行为（step从搜索层数开始倒数，step=1是最后一层）
+	mSearchDepth = Max(PlayerParam::instance().DecisionSearchDepth(), 1);
+
+	RealTime search_begin = GetRealTime();
+	if (mSearchDepth > 1) {
+		mDeadline = search_begin + PlayerParam::instance().DecisionSearchBudget();
+		mSearchTime = agent.GetWorldState().CurrentTime();
+		++mSearchCount;
+		mExpandedNodes = 0;
+		mTranspositionHits = 0;
+		mDepthReached = 1;
+	}
+
+	ActiveBehavior beh = Search(agent, mSearchDepth);
+
+	if (mSearchDepth > 1 && PlayerParam::instance().SaveTextLog()) {
+		RealTime search_end = GetRealTime();
+		const long elapsed = Max(search_end.Sub(search_begin), 1L); //us
+		Logger::instance().GetTextLogger("search") << mSearchTime << ": " << mExpandedNodes << " nodes, "
+				<< mTranspositionHits << " transposition hits, depth " << mDepthReached << "/" << mSearchDepth << ", "
+				<< elapsed << "us, " << mExpandedNodes * 1000000.0 / elapsed << " nodes/s" << std::endl;
+	}
+
+	bool ret = false;
 
 	// 检查是否找到了有效行为
 	if (beh.GetType() != BT_None) {
@@ -92,11 +234,15 @@ bool DecisionTree::Decision(Agent & agent)
 		Assert(&beh.GetAgent() == &agent);
 		
 		// 执行选中的行为
-		return beh.Execute();
+		ret = beh.Execute();
 	}
-	
-	// 没有找到合适的行为
-	return false;
+
+#ifdef __ALLOC_TEST
+	AllocationTest::instance().AddDecision(agent.GetSelfUnum(), AllocationTest::instance().Count() - allocation_begin);
+#endif
+
+	// 没有找到合适的行为时返回false
+	return ret;
 }
 
 /**
@@ -104,72 +250,319 @@ bool DecisionTree::Decision(Agent & agent)
  * 
  * 在决策树中搜索最佳行为，采用分层决策机制：
  * 1. 检查智能体状态（空闲状态直接返回）
- * 2. 根据智能体类型（守门员/普通球员）选择不同的行为序列
- * 3. 按优先级顺序评估各种行为
- * 4. 返回评估最高的行为
+ * 2. 按优先级调用各 planner 得到候选行为（见 Plan）
+ * 3. 最后一层（step=1）直接返回评估最高的行为
+ * 4. 其余各层展开评估最高的几个行为（见 Expand），返回回传值最高的行为
+ * 
+ * @param agent 参与决策的智能体引用
+ * @param step 剩余的搜索层数，step=1是最后一层
+ * @return ActiveBehavior 搜索到的最佳行为，可能是BT_None（无行为）；
+ *         展开过时其 mEvaluation 是回传的值，供上一层比较
+ * 
+ * @note 搜索受 decision_search_budget 限制，超时后剩下的节点都按单层选择处理
+ */
+ActiveBehavior DecisionTree::Search(Agent & agent, int step)
+{
+	// 检查智能体是否处于空闲状态
+	// 空闲状态的智能体不能执行任何行为
+	if (agent.GetSelf().IsIdling()) {
+		return ActiveBehavior(agent, BT_None); // 返回无行为
+	}
+
+	// 创建活跃行为列表，用于存储所有候选行为
+	ActiveBehaviorList active_behavior_list(agent);
+
+	Plan(agent, active_behavior_list);
+
+	// 检查是否找到了候选行为
+	if (active_behavior_list.empty()) {
+		// 没有找到任何合适的行为
+		// 返回无行为，智能体将保持当前状态
+		return ActiveBehavior(agent, BT_None);
+	}
+
+	if (step > 1 && agent.GetWorldState().GetPlayMode() == PM_Play_On && !TimeOut()) {
+		// 先按planner给出的评价保存，下周期planner看到的仍是原来的评价
+		agent.SaveActiveBehaviorList(active_behavior_list);
+
+		double value = 0.0;
+		const int best = Expand(agent, active_behavior_list, step, value);
+
+		if (best >= 0) {
+			ActiveBehavior beh = *(active_behavior_list.begin() + best);
+			agent.ReplaceActiveBehavior(beh); //执行的是这个，保存的同类行为也要是它
+
+			beh.mEvaluation = value;
+			return beh;
+		}
+
+		return active_behavior_list.front(); //Expand已经排过序了
+	}
+
+	// 从候选行为中选择最佳的一个
+	// GetBestActiveBehavior会根据评估分数选择最优行为
+	return GetBestActiveBehavior(agent, active_behavior_list);
+}
+
+/**
+ * @brief 按优先级调用各 planner
  * 
  * 决策优先级（从高到低）：
  * 守门员：Penalty > Setplay > Attack > Goalie
  * 普通球员：Penalty > Setplay > Attack > Defense
  * 
- * @param agent 参与决策的智能体引用
- * @param step 决策树的搜索深度（当前只支持step=1）
- * @return ActiveBehavior 搜索到的最佳行为，可能是BT_None（无行为）
- * 
  * @note MutexPlan使用短路或运算，一旦找到有效行为就停止后续搜索
  * @note 这种设计确保了高优先级行为的优先执行
  */
-ActiveBehavior DecisionTree::Search(Agent & agent, int step)
+void DecisionTree::Plan(Agent & agent, ActiveBehaviorList & active_behavior_list)
 {
-	// 当前只支持第一层决策（step=1）
-	// 决策树目前只支持单层决策，不支持多层递归决策
-	if (step == 1) {
-		// 检查智能体是否处于空闲状态
-		// 空闲状态的智能体不能执行任何行为
-		if (agent.GetSelf().IsIdling()) {
-			return ActiveBehavior(agent, BT_None); // 返回无行为
+	// 根据智能体类型选择不同的行为决策序列
+	// 守门员和普通球员有不同的行为优先级
+	if (agent.GetSelf().IsGoalie()) {
+		// 守门员的决策序列：点球 > 定位球 > 进攻 > 守门员专用行为
+		MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorGoaliePlanner>(agent, active_behavior_list);
+	}
+	else {
+		// 普通球员的决策序列：点球 > 定位球 > 进攻 > 防守
+		MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
+		MutexPlan<BehaviorDefensePlanner>(agent, active_behavior_list);
+	}
+}
+
+/**
+ * 按评价排序后展开前 decision_search_width 个行为，回传值为
+ * 行为本身的评价 + SEARCH_DISCOUNT * (我方下一层最优评价 - 对手最优评价)。
+ * 超时后不再展开，只在已展开的行为里选；一个都没展开时返回-1。
+ */
+int DecisionTree::Expand(Agent & agent, ActiveBehaviorList & behavior_list, int step, double & value)
+{
+	behavior_list.SortDescending();
+
+	const int width = Min(PlayerParam::instance().DecisionSearchWidth(), int(behavior_list.size()));
+
+	int best = -1;
+	for (int i = 0; i < width && !TimeOut(); ++i) {
+		const ActiveBehavior & beh = *(behavior_list.begin() + i);
+		const double backed = beh.mEvaluation + SEARCH_DISCOUNT * ExpandBehavior(agent, beh, step);
+
+		if (best < 0 || backed > value) {
+			best = i;
+			value = backed;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * 在预测的世界里反算：离球最近的对手做单层决策，下一层的我方球员（传球时是接球队员，否则是自己）
+ * 继续搜索 step - 1 层。反算用的 Agent 从 agent 的池里取，世界状态的修改和恢复都通过 WorldStateSetter。
+ * 反算对手用的世界要在修改己方世界之前生成，这样它备份的是真实的状态；改完世界后再取一次 Agent，
+ * 它的派生信息才会按预测的世界重新计算。
+ * 预测世界的粗粒度键相同时直接用置换表里的值。
+ */
+double DecisionTree::ExpandBehavior(Agent & agent, const ActiveBehavior & beh, int step)
+{
+	if (beh.GetType() == BT_Shoot) {
+		return 0.0; //射门之后不再展开
+	}
+
+	Prediction prediction;
+	Predict(agent, beh, prediction);
+	++mExpandedNodes;
+
+	const unsigned long long key = GetWorldKey(prediction, agent.IsReverse(), step);
+	Transposition & entry = mTransposition[key % TRANSPOSITION_SIZE];
+	if (entry.mSearch == mSearchCount && entry.mKey == key) {
+		++mTranspositionHits;
+		return entry.mValue;
+	}
+
+	double value = 0.0;
+
+	WorldState * reverse_world = prediction.mOppUnum? & agent.GetOpponentAgent(prediction.mOppUnum).World(): 0;
+
+	{ //用来指明反算存在的代码范围，以使恢复正常进行
+		WorldStateSetter setter(agent.World());
+
+		setter.SetBallInfo(prediction.mBallPos, prediction.mBallVel);
+		for (Unum i = 1; i <= TEAMSIZE; ++i) {
+			if (prediction.mMoved[i]) {
+				setter.SetTeammateInfo(i, prediction.mPos[i], prediction.mBodyDir[i], prediction.mVel[i]);
+			}
+			if (prediction.mMoved[i + TEAMSIZE]) {
+				setter.SetOpponentInfo(i, prediction.mPos[i + TEAMSIZE], prediction.mBodyDir[i + TEAMSIZE], prediction.mVel[i + TEAMSIZE]);
+			}
 		}
 
-		// 创建活跃行为列表，用于存储所有候选行为
-		std::list<ActiveBehavior> active_behavior_list;
-
-		// 根据智能体类型选择不同的行为决策序列
-		// 守门员和普通球员有不同的行为优先级
-		if (agent.GetSelf().IsGoalie()) {
-			// 守门员的决策序列：点球 > 定位球 > 进攻 > 守门员专用行为
-			// 使用短路或运算，一旦某个行为规划器产生有效行为就停止
-			// 这种设计确保了高优先级行为的优先执行
-			MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorGoaliePlanner>(agent, active_behavior_list);
+		const WorldState & world = agent.GetWorldState();
+		for (Unum i = 1; i <= TEAMSIZE; ++i) {
+			setter.Teammate(i).UpdateKickable(world.GetTeammate(i).IsAlive() &&
+					world.GetTeammate(i).GetPos().Dist(prediction.mBallPos) < world.GetTeammate(i).GetKickableArea());
+			setter.Opponent(i).UpdateKickable(world.GetOpponent(i).IsAlive() &&
+					world.GetOpponent(i).GetPos().Dist(prediction.mBallPos) < world.GetOpponent(i).GetKickableArea());
 		}
-		else {
-			// 普通球员的决策序列：点球 > 定位球 > 进攻 > 防守
-			// 同样使用短路或运算，按优先级顺序尝试各种行为
-			MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
-			MutexPlan<BehaviorDefensePlanner>(agent, active_behavior_list);
+		setter.IncStopTime(); //可以开始反算了
+
+		if (reverse_world != 0) {
+			WorldStateSetter reverse_setter(*reverse_world);
+
+			reverse_setter.Ball().GetReverseFrom(world.GetBall());
+			for (Unum i = 1; i <= TEAMSIZE; ++i) {
+				reverse_setter.Opponent(i).GetReverseFrom(world.GetTeammate(i));
+				reverse_setter.Teammate(i).GetReverseFrom(world.GetOpponent(i));
+			}
+			reverse_setter.IncStopTime();
+
+			Agent & opponent = agent.GetOpponentAgent(prediction.mOppUnum);
+			if (opponent.GetSelf().IsAlive() && !TimeOut()) {
+				ActiveBehavior opp_beh = Search(opponent, 1);
+				if (opp_beh.GetType() != BT_None) {
+					value -= opp_beh.mEvaluation;
+				}
+			}
 		}
 
-		// 检查是否找到了候选行为
-		if (!active_behavior_list.empty()){
-			// 从候选行为中选择最佳的一个
-			// GetBestActiveBehavior会根据评估分数选择最优行为
-			return GetBestActiveBehavior(agent, active_behavior_list);
+		if (!TimeOut()) {
+			Agent & teammate = agent.GetTeammateAgent(prediction.mNextUnum);
+
+			ActiveBehavior tm_beh = Search(teammate, step - 1);
+			if (tm_beh.GetType() != BT_None) {
+				value += tm_beh.mEvaluation;
+			}
+			mDepthReached = Max(mDepthReached, mSearchDepth - step + 2);
+		}
+	}
+
+	entry.mKey = key;
+	entry.mSearch = mSearchCount;
+	entry.mValue = value;
+
+	return value;
+}
+
+/**
+ * 用 Simulator 预测 beh 执行若干周期后的世界：
+ * 传球时球按踢出的速度运动到接近目标，接球队员跑向目标点；带球和控球时球跟着自己；
+ * 其余行为自己跑向 mTarget。活着的对手都去追球，离球最近的那个做为反算的对手。
+ */
+void DecisionTree::Predict(Agent & agent, const ActiveBehavior & beh, Prediction & prediction)
+{
+	const WorldState & world = agent.GetWorldState();
+	const Unum self = agent.GetSelfUnum();
+	const AngleDeg turn_buffer = 15.0;
+
+	Vector ball_pos = world.GetBall().GetPos();
+	Vector ball_vel = world.GetBall().GetVel();
+
+	int horizon = SEARCH_HORIZON;
+	Unum next = self;
+
+	const bool is_pass = beh.GetType() == BT_Pass && beh.mKickSpeed > FLOAT_EPS;
+	const bool with_ball = beh.GetType() == BT_Dribble || beh.GetType() == BT_Hold;
+
+	if (is_pass) {
+		ball_vel = Polar2Vector(beh.mKickSpeed, (beh.mTarget - ball_pos).Dir());
+		const double cycle = ServerParam::instance().GetBallCycle(beh.mKickSpeed, ball_pos.Dist(beh.mTarget));
+		horizon = MinMax(1, int(cycle), int(PASS_HORIZON));
+
+		const Unum receiver = beh.mKeyTm.mUnum;
+		if (receiver > 0 && receiver != self && world.GetTeammate(receiver).IsAlive()) {
+			next = receiver;
+		}
+	}
+
+	Simulator::Player self_player(world.GetTeammate(self));
+	for (int t = 0; t < horizon; ++t) {
+		if (is_pass) {
+			self_player.Step();
 		}
 		else {
-			// 没有找到任何合适的行为
-			// 返回无行为，智能体将保持当前状态
-			return ActiveBehavior(agent, BT_None);
+			self_player.Chase(beh.mTarget, turn_buffer);
 		}
 	}
+	prediction.Save(self, self_player);
+
+	if (next != self) {
+		Simulator::Player receiver(world.GetTeammate(next));
+		for (int t = 0; t < horizon; ++t) {
+			receiver.Chase(beh.mTarget, turn_buffer);
+		}
+		prediction.Save(next, receiver);
+	}
+
+	Vector ball_traj[PASS_HORIZON];
+	if (with_ball) {
+		for (int t = 0; t < horizon; ++t) {
+			ball_traj[t] = self_player.mPos; //只用最后的位置，近似即可
+		}
+		ball_pos = self_player.mPos;
+		ball_vel = self_player.mVel;
+	}
 	else {
-		// 不支持多层决策（当前版本只支持单层决策）
-		// 如果step不为1，直接返回无行为
-		return ActiveBehavior(agent, BT_None);
+		Simulator::Ball ball(ball_pos, ball_vel);
+		for (int t = 0; t < horizon; ++t) {
+			ball.Step();
+			ball_traj[t] = ball.mPos;
+		}
+		ball_pos = ball.mPos;
+		ball_vel = ball.mVel;
 	}
+
+	prediction.mBallPos = ball_pos;
+	prediction.mBallVel = ball_vel;
+	prediction.mNextUnum = next;
+
+	double min_dist = HUGE_VALUE;
+	for (Unum i = 1; i <= TEAMSIZE; ++i) {
+		const PlayerState & opp = world.GetOpponent(i);
+		if (!opp.IsAlive()) continue;
+
+		Simulator::Player chaser(opp);
+		for (int t = 0; t < horizon; ++t) {
+			chaser.Chase(ball_traj[t], turn_buffer);
+		}
+		prediction.Save(i + TEAMSIZE, chaser);
+
+		const double dist = chaser.mPos.Dist(ball_pos);
+		if (dist < min_dist) {
+			min_dist = dist;
+			prediction.mOppUnum = i;
+		}
+	}
+}
+
+/**
+ * 球的位置按1米、速度按0.5米/周期、下一层决策者的位置按2米量化
+ */
+unsigned long long DecisionTree::GetWorldKey(const Prediction & prediction, bool reverse, int step)
+{
+	const Vector & next_pos = prediction.mPos[prediction.mNextUnum];
+	const int fields[] = {
+			int(floor(prediction.mBallPos.X())), int(floor(prediction.mBallPos.Y())),
+			int(floor(prediction.mBallVel.X() * 2.0)), int(floor(prediction.mBallVel.Y() * 2.0)),
+			int(floor(next_pos.X() * 0.5)), int(floor(next_pos.Y() * 0.5)),
+			prediction.mNextUnum, prediction.mOppUnum, step, reverse
+	};
+
+	unsigned long long key = 14695981039346656037ULL; //FNV-1a
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+		key ^= (unsigned long long)(unsigned int)(fields[i]);
+		key *= 1099511628211ULL;
+	}
+
+	return key;
+}
+
+bool DecisionTree::TimeOut() const
+{
+	const RealTime now = GetRealTime();
+	return !(now < mDeadline);
 }
 
 /**
@@ -177,7 +570,7 @@ ActiveBehavior DecisionTree::Search(Agent & agent, int step)
  * 
  * 从所有候选行为中选择评估分数最高的行为：
  * 1. 保存行为列表到智能体，供下一周期决策参考
- * 2. 按评估分数降序排序
+ * 2. 选出评估分数最高的行为
  * 3. 返回分数最高的行为
  * 
  * @param agent 参与决策的智能体引用
@@ -187,7 +580,7 @@ ActiveBehavior DecisionTree::Search(Agent & agent, int step)
  * @note ActiveBehavior重载了>运算符，基于mEvaluation进行比较
  * @note 保存行为列表的目的是为了下一周期的决策优化
  */
-ActiveBehavior DecisionTree::GetBestActiveBehavior(Agent & agent, std::list<ActiveBehavior> & behavior_list)
+ActiveBehavior DecisionTree::GetBestActiveBehavior(Agent & agent, ActiveBehaviorList & behavior_list)
 {
 	// 保存活跃行为列表到智能体
 	// behavior_list里面存储了本周期所有behavior决策出的最优activebehavior
@@ -195,10 +588,9 @@ ActiveBehavior DecisionTree::GetBestActiveBehavior(Agent & agent, std::list<Acti
 	// 这样下一周期就可以参考本周期的决策结果进行优化
 	agent.SaveActiveBehaviorList(behavior_list);
 
-	// 按评估分数降序排序（使用ActiveBehavior重载的>运算符）
-	// 分数越高的行为排在越前面
-	// ActiveBehavior重载了>运算符，基于mEvaluation进行比较
-	behavior_list.sort(std::greater<ActiveBehavior>());
+	// 把评估分数最高的行为换到最前面（使用ActiveBehavior重载的>运算符）
+	// 只需要最优的一个，不用整个排序
+	behavior_list.SelectBest();
 
 	// 返回分数最高的行为（列表的第一个元素）
 	// 这是本轮决策的最终结果
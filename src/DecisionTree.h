@@ -35,12 +35,13 @@
 
 #include <list>
 #include "BehaviorBase.h"
+#include "Simulator.h"
 
 class Agent;
 
 class DecisionTree {
 public:
-	DecisionTree() {}
+	DecisionTree();
 	virtual ~DecisionTree() {}
 
 	/**
@@ -58,13 +59,94 @@ private:
 	*/
 	ActiveBehavior Search(Agent & agent, int step);
 
-	ActiveBehavior GetBestActiveBehavior(Agent & agent, std::list<ActiveBehavior> & behavior_list);
+	ActiveBehavior GetBestActiveBehavior(Agent & agent, ActiveBehaviorList & behavior_list);
+
+	/**
+	 * 按优先级依次调用各 planner，得到当前节点的候选行为
+	 */
+	void Plan(Agent & agent, ActiveBehaviorList & active_behavior_list);
+
+	/**
+	 * 展开评价最高的几个行为：预测执行后的世界，反算对手的应对和我方下一层的决策，
+	 * 用回传的值重新比较这几个行为
+	 * @param value 选中行为回传的值
+	 * @return 选中行为在排序后的 behavior_list 中的下标，一个都没来得及展开时返回-1
+	 */
+	int Expand(Agent & agent, ActiveBehaviorList & behavior_list, int step, double & value);
+
+	/**
+	 * 预测 beh 执行若干周期后的世界，在预测的世界里反算对手和我方下一层
+	 * @return 下一层我方最优评价减去对手最优评价
+	 */
+	double ExpandBehavior(Agent & agent, const ActiveBehavior & beh, int step);
+
+	/**
+	 * 预测的世界，只记录球和动过的球员，下标同WorldStateSetter（1~TEAMSIZE是队友，之后是对手）
+	 */
+	struct Prediction {
+		Vector mBallPos;
+		Vector mBallVel;
+		Array<Vector, TEAMSIZE * 2 + 1> mPos;
+		Array<Vector, TEAMSIZE * 2 + 1> mVel;
+		Array<AngleDeg, TEAMSIZE * 2 + 1> mBodyDir;
+		Array<bool, TEAMSIZE * 2 + 1, true> mMoved;
+
+		Unum mNextUnum; //下一层决策的队友
+		Unum mOppUnum; //反算的对手
+
+		Prediction(): mNextUnum(0), mOppUnum(0) { }
+
+		void Save(int i, const Simulator::Player & player) {
+			mPos[i] = player.mPos;
+			mVel[i] = player.mVel;
+			mBodyDir[i] = player.mBodyDir;
+			mMoved[i] = true;
+		}
+	};
+
+	void Predict(Agent & agent, const ActiveBehavior & beh, Prediction & prediction);
+
+	/**
+	 * 把粗粒度的世界（球和下一层决策者的位置）编码成置换表的键
+	 */
+	static unsigned long long GetWorldKey(const Prediction & prediction, bool reverse, int step);
+
+	bool TimeOut() const;
 
 	template <typename BehaviorDerived>
-	bool MutexPlan(Agent & agent, std::list<ActiveBehavior> & active_behavior_list){
+	bool MutexPlan(Agent & agent, ActiveBehaviorList & active_behavior_list){
 		BehaviorDerived(agent).Plan(active_behavior_list);
 		return !active_behavior_list.empty();
 	}
+
+private:
+	enum {
+		SEARCH_HORIZON = 5, //非传球行为预测的周期数
+		PASS_HORIZON = 10, //传球最多预测的周期数
+		TRANSPOSITION_SIZE = 256 //置换表大小，每次搜索失效
+	};
+
+	static const double SEARCH_DISCOUNT; //下一层回传值的权重
+
+	struct Transposition {
+		unsigned long long mKey;
+		long mSearch;
+		double mValue;
+
+		Transposition(): mKey(0), mSearch(0), mValue(0.0) { }
+	};
+
+	Array<Transposition, TRANSPOSITION_SIZE> mTransposition;
+
+	RealTime mDeadline;
+	Time mSearchTime;
+	long mSearchCount; //每次搜索加一，置换表中不是本次搜索写入的项都失效（同一周期内的推测决策也会重新搜索）
+	int mSearchDepth;
+
+	/** 本周期的统计 */
+	int mExpandedNodes;
+	int mTranspositionHits;
+	int mDepthReached;
 };
 
 #endif /* DECISIONTREE_H_ */
@@ -170,3 +170,49 @@ double Evaluation::EvaluatePosition(const Vector & pos, bool ourside)
     return output[0];
 }
 
+/**
+ * @brief 矩形区域内位置评估的上界
+ *
+ * 与 EvaluatePosition 相同的归一化，把矩形变成网络输入的区间（|y| 的区间要看矩形是否跨过 y = 0），
+ * 再用 Net::RunInterval 做区间前向传播。
+ *
+ * @param low 矩形左下角（x、y 都取最小值）
+ * @param high 矩形右上角
+ * @param ourside 同 EvaluatePosition
+ * @return double 矩形内任一点的评估值都不超过它
+ */
+double Evaluation::EvaluatePositionUpperBound(const Vector & low, const Vector & high, bool ourside)
+{
+	static double input_low[2];
+	static double input_high[2];
+	static double output_high[1];
+
+	const double half_length = ServerParam::instance().PITCH_LENGTH * 0.5;
+	const double half_width = ServerParam::instance().PITCH_WIDTH * 0.5;
+
+	if (ourside) {
+		input_low[0] = low.X() / half_length;
+		input_high[0] = high.X() / half_length;
+	}
+	else {
+		input_low[0] = -high.X() / half_length;
+		input_high[0] = -low.X() / half_length;
+	}
+
+	double abs_y_low = 0.0;
+	if (low.Y() > 0.0) {
+		abs_y_low = low.Y();
+	}
+	else if (high.Y() < 0.0) {
+		abs_y_low = -high.Y();
+	}
+	const double abs_y_high = Max(fabs(low.Y()), fabs(high.Y()));
+
+	input_low[1] = abs_y_low / half_width * 2.0 - 1.0;
+	input_high[1] = abs_y_high / half_width * 2.0 - 1.0;
+
+	mSensitivityNet->RunInterval(input_low, input_high, 0, output_high);
+
+	return output_high[0];
+}
+
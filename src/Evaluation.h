@@ -47,6 +47,11 @@ public:
 
 	double EvaluatePosition(const Vector & pos, bool ourside);
 
+	/**
+	 * 位置在 [low, high] 这个矩形内时 EvaluatePosition 的上界，不用逐点评价就能排除一片区域
+	 */
+	double EvaluatePositionUpperBound(const Vector & low, const Vector & high, bool ourside);
+
 private:
 	Net *mSensitivityNet;
 };
@@ -46,9 +46,11 @@
  * @note 本文件仅补充注释，不改动任何原有逻辑。
  */
 
+#include <fstream>
 #include "InfoState.h"
 #include "InterceptInfo.h"
 #include "PositionInfo.h"
+#include "PlayerParam.h"
 
 
 /**
@@ -75,6 +77,12 @@ InfoState::~InfoState()
 	delete mpInterceptInfo;
 }
 
+void InfoState::Invalidate()
+{
+	mpPositionInfo->Invalidate();
+	mpInterceptInfo->Invalidate();
+}
+
 /**
  * @brief 获取位置信息模块
  *
@@ -100,3 +108,173 @@ InterceptInfo & InfoState::GetInterceptInfo() const
 	mpInterceptInfo->Update();
 	return *mpInterceptInfo;
 }
+
+long InfoCache::mSequenceCounter = 0;
+
+InfoCache::InfoCache(InfoComponent component):
+	mComponent( component ),
+	mTime( Time(-3, 0) ),
+	mRevision( 0 ),
+	mSequence( 0 )
+{
+}
+
+void InfoCache::DependOn(const InfoCache & input)
+{
+	mInput.push_back(&input);
+	mInputSequence.push_back(-1);
+}
+
+/**
+ * @brief 是否是当前周期、当前世界版本下计算的，且所有输入在此之后都没有重新计算过
+ *
+ * 输入本身过期时周期或世界版本必然也变了，所以对输入只需比较计算序号。
+ */
+bool InfoCache::IsUpToDate(const Time & time) const
+{
+	if (mTime != time || mRevision != Updatable::Revision()) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < mInput.size(); ++i) {
+		if (mInput[i]->mSequence != mInputSequence[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void InfoCache::Stamp(const Time & time)
+{
+	mTime = time;
+	mRevision = Updatable::Revision();
+	mSequence = ++mSequenceCounter;
+
+	for (unsigned i = 0; i < mInput.size(); ++i) {
+		mInputSequence[i] = mInput[i]->mSequence;
+	}
+}
+
+InfoCompute::InfoCompute(InfoCache & cache, const Time & time):
+	mCache( cache ),
+	mTime( time ),
+	mIsHit( cache.IsUpToDate(time) )
+{
+	if (mIsHit) {
+		if (PlayerParam::instance().TimeTest()) {
+			InfoStateTest::instance().AddHit(mCache.GetComponent(), mTime);
+		}
+	}
+	else if (PlayerParam::instance().TimeTest()) {
+		mBeginTime = GetRealTime();
+	}
+}
+
+/**
+ * @brief 未命中时，计算已在本对象的生命期内完成，打上时间戳并记录耗时
+ */
+InfoCompute::~InfoCompute()
+{
+	if (mIsHit) return;
+
+	mCache.Stamp(mTime);
+
+	if (PlayerParam::instance().TimeTest()) {
+		RealTime end_time = GetRealTime();
+		InfoStateTest::instance().AddMiss(mCache.GetComponent(), mTime, end_time.Sub(mBeginTime));
+	}
+}
+
+InfoStateTest::InfoStateTest():
+	mCycle( 0 ),
+	mLastTime( Time(-3, 0) ),
+	mUnum( 0 )
+{
+}
+
+InfoStateTest & InfoStateTest::instance()
+{
+	static InfoStateTest info_state_test;
+	return info_state_test;
+}
+
+void InfoStateTest::UpdateCycle(InfoComponent component, const Time & time)
+{
+	if (time != mLastTime) {
+		mLastTime = time;
+		++mCycle;
+	}
+
+	if (time != mRecord[component].mLastTime) {
+		mRecord[component].mLastTime = time;
+		++mRecord[component].mCycle;
+	}
+}
+
+void InfoStateTest::AddHit(InfoComponent component, const Time & time)
+{
+	UpdateCycle(component, time);
+	++mRecord[component].mHit;
+}
+
+void InfoStateTest::AddMiss(InfoComponent component, const Time & time, long cost)
+{
+	UpdateCycle(component, time);
+	++mRecord[component].mMiss;
+	mRecord[component].mCost += cost;
+
+	if (cost > mRecord[component].mMaxCost) {
+		mRecord[component].mMaxCost = cost;
+		mRecord[component].mMaxTime = time;
+	}
+}
+
+/**
+ * @brief 结束时写出统计结果，没用到某信息的周期数即按需计算省下的周期数
+ */
+InfoStateTest::~InfoStateTest()
+{
+	if (mCycle == 0) return;
+
+	static const char *component_name[IC_Max] = {
+			"DistMatrix",
+			"OffsideLine",
+			"OppGoalInfo",
+			"XSortTeammate",
+			"XSortOpponent",
+			"CloseToBall",
+			"CloseToPlayer",
+			"PlayerWithBall",
+			"PlayerIntercept",
+			"OIT"
+	};
+
+	char file_name[256];
+	sprintf(file_name, "Test/InfoState-%d.txt", mUnum);
+
+	std::ofstream out_file(file_name);
+	if (out_file.good() == false) {
+		PRINT_ERROR("open file error  " << file_name);
+		return;
+	}
+
+	out_file << "Cycles: " << mCycle << std::endl << std::endl;
+	out_file << "component\tused\tskipped\thit\tmiss\tave(ms)\tmax(ms)\tmax_time\tper_cycle(ms)" << std::endl;
+
+	for (int i = 0; i < IC_Max; ++i) {
+		const ComponentRecord & record = mRecord[i];
+
+		out_file << component_name[i]
+				<< "\t" << record.mCycle
+				<< "\t" << mCycle - record.mCycle
+				<< "\t" << record.mHit
+				<< "\t" << record.mMiss
+				<< "\t" << (record.mMiss > 0? record.mCost / 1000.0 / record.mMiss: 0.0)
+				<< "\t" << record.mMaxCost / 1000.0
+				<< "\t" << record.mMaxTime
+				<< "\t" << record.mCost / 1000.0 / mCycle << std::endl;
+	}
+
+	out_file.close();
+}
@@ -53,6 +53,120 @@ class InfoState;
 class InterceptInfo;
 class PositionInfo;
 
+/**
+ * 按需计算的派生信息，用于统计
+ * Derived quantities which are computed on first use each cycle.
+ */
+enum InfoComponent {
+	IC_DistMatrix,
+	IC_OffsideLine,
+	IC_OppGoalInfo,
+	IC_XSortTeammate,
+	IC_XSortOpponent,
+	IC_CloseToBall,
+	IC_CloseToPlayer,
+	IC_PlayerWithBall,
+	IC_PlayerIntercept,
+	IC_OIT,
+
+	IC_Max
+};
+
+/**
+ * 派生信息的缓存标记。记录计算时的周期、世界版本（Updatable::Revision()）以及所依赖输入的计算序号，
+ * 任何一个不同都需要重新计算，所以输入被重新计算后依赖它的信息也会失效。
+ * Stamp of a lazily computed quantity: it is stale when the cycle, the world revision or the
+ * compute sequence of any declared input has changed since it was computed.
+ */
+class InfoCache {
+public:
+	explicit InfoCache(InfoComponent component);
+
+	/**
+	 * 声明一个输入
+	 * Declare an input of this quantity.
+	 */
+	void DependOn(const InfoCache & input);
+
+	bool IsUpToDate(const Time & time) const;
+	void Invalidate() { mTime = Time(-3, 0); }
+
+	const InfoComponent & GetComponent() const { return mComponent; }
+
+private:
+	friend class InfoCompute;
+	void Stamp(const Time & time);
+
+	InfoComponent mComponent;
+	Time mTime;
+	int mRevision;
+	long mSequence;
+
+	std::vector<const InfoCache *> mInput;
+	std::vector<long> mInputSequence;
+
+	static long mSequenceCounter;
+};
+
+/**
+ * 在需要某个派生信息的地方构造：已是最新时记一次命中，否则记一次未命中，析构时记录计算耗时（包含输入的计算）并打上时间戳。
+ * Construct where a quantity is needed; if IsHit() is false compute it before the guard goes out of scope.
+ */
+class InfoCompute {
+	InfoCompute(const InfoCompute &);
+	const InfoCompute & operator=(const InfoCompute &);
+
+public:
+	InfoCompute(InfoCache & cache, const Time & time);
+	~InfoCompute();
+
+	bool IsHit() const { return mIsHit; }
+
+private:
+	InfoCache & mCache;
+	const Time mTime;
+	bool mIsHit;
+	RealTime mBeginTime;
+};
+
+/**
+ * 各派生信息每周期的命中、未命中和计算耗时，time_test打开时统计，结束时写到Test/InfoState-<unum>.txt
+ * Per-component hit/miss/compute accounting, enabled together with time_test.
+ */
+class InfoStateTest {
+	InfoStateTest();
+
+public:
+	~InfoStateTest();
+
+	static InfoStateTest & instance();
+
+	void SetUnum(int unum) { mUnum = unum; }
+
+	void AddHit(InfoComponent component, const Time & time);
+	void AddMiss(InfoComponent component, const Time & time, long cost);
+
+private:
+	void UpdateCycle(InfoComponent component, const Time & time);
+
+	struct ComponentRecord {
+		ComponentRecord(): mHit(0), mMiss(0), mCost(0), mMaxCost(0), mMaxTime(Time(-3, 0)), mCycle(0), mLastTime(Time(-3, 0)) {}
+
+		long mHit;
+		long mMiss;
+		long mCost; // 总计算耗时，微秒
+		long mMaxCost;
+		Time mMaxTime;
+		int mCycle; // 被用到的周期数
+		Time mLastTime;
+	};
+
+	Array<ComponentRecord, IC_Max> mRecord;
+	int mCycle; // 总周期数
+	Time mLastTime;
+	int mUnum;
+};
+
 
 /**
  * 这些是由 WorldState 计算出来得信息状态
@@ -85,6 +199,11 @@ public:
 	PositionInfo & GetPositionInfo() const;
 	InterceptInfo & GetInterceptInfo() const;
 
+	/**
+	 * 所有派生信息在下次用到时重新计算，用于世界状态在同一周期内被改过的情况
+	 */
+	void Invalidate();
+
 private:
 	PositionInfo  *mpPositionInfo;
 	InterceptInfo *mpInterceptInfo;
@@ -60,19 +60,45 @@
  * @param pWorldState 世界状态指针
  * @param pInfoState  信息状态指针
  */
-InterceptInfo::InterceptInfo(WorldState *pWorldState, InfoState *pInfoState): InfoStateBase( pWorldState, pInfoState )
+InterceptInfo::InterceptInfo(WorldState *pWorldState, InfoState *pInfoState):
+	InfoStateBase( pWorldState, pInfoState ),
+	mPlayerInterceptCache( 1 + 2 * TEAMSIZE, InfoCache(IC_PlayerIntercept) ),
+	mOITCache( IC_OIT )
 {
+	for (unsigned i = 1; i < mPlayerInterceptCache.size(); ++i) {
+		mOITCache.DependOn(mPlayerInterceptCache[i]);
+	}
 }
 
 /**
  * @brief 每周期更新例程
  *
- * InterceptInfo 的更新主要工作是：
- * - 重新计算/校验所有球员的截球信息并排序（OIT）。
+ * 截球信息和OIT都改为首次用到时才计算（见InfoCache）：只问了自己截球周期的周期不再计算全部22名球员，
+ * 缓存会根据周期和世界版本自己判断是否过期，这里不需要做任何事。
  */
 void InterceptInfo::UpdateRoutine()
 {
-    SortIntercerptInfo();
+}
+
+void InterceptInfo::Invalidate()
+{
+	for (unsigned i = 0; i < mPlayerInterceptCache.size(); ++i) {
+		mPlayerInterceptCache[i].Invalidate();
+	}
+	mOITCache.Invalidate();
+}
+
+/**
+ * @brief 获取截球排序表（OIT），首次用到时才计算
+ */
+const std::vector<OrderedIT> & InterceptInfo::GetOIT() const
+{
+    InfoCompute compute(const_cast<InfoCache &>(mOITCache), mpWorldState->CurrentTime());
+    if (!compute.IsHit()) {
+        const_cast<InterceptInfo *>(this)->SortIntercerptInfo();
+    }
+
+    return mOIT;
 }
 
 /**
@@ -128,12 +154,13 @@ void InterceptInfo::SortIntercerptInfo()
  */
 PlayerInterceptInfo *InterceptInfo::VerifyIntInfo(Unum unum)
 {
-    PlayerInterceptInfo* pInfo = GetPlayerInterceptInfo(unum);
+    PlayerInterceptInfo* pInfo = GetPlayerInterceptSlot(unum);
     if (!pInfo) {
         return 0;
     }
 
-    if(pInfo->mTime != mpWorldState->CurrentTime()){
+    InfoCompute compute(mPlayerInterceptCache[unum > 0? unum: TEAMSIZE - unum], mpWorldState->CurrentTime());
+    if (!compute.IsHit()) {
         CalcTightInterception(mpWorldState->GetBall(), pInfo);
         pInfo->mTime = mpWorldState->CurrentTime();
     }
@@ -309,7 +336,43 @@ void InterceptInfo::CalcTightInterception(const BallState & ball, PlayerIntercep
     AnalyseInterceptSolution(ball, pInfo);
 }
 
+/**
+ * @brief 截球周期的保守下界
+ *
+ * 球只会出现在从 ball_pos 出发、方向为 ball_dir 的射线上，球员到射线的距离减去可踢（守门员取可扑）范围
+ * 和当前速度带来的一个周期的位移后，只能以最大速度去跑。截球模型和 go_to_point 修正都不会比这更快，
+ * 再扣除位置延迟和一个周期的取整余量；截球修正最多算到 MAX_STEP，下界也不超过它。
+ *
+ * @param ball_pos 球的出发点
+ * @param ball_dir 球的运动方向
+ * @param player 球员
+ * @return int 截球周期下界
+ */
+int InterceptInfo::GetMinCycleLowerBound(const Vector & ball_pos, const AngleDeg & ball_dir, const PlayerState & player)
+{
+    const Vector rel_pos = (player.GetPos() - ball_pos).Rotate(-ball_dir);
+    const double dist = (rel_pos.X() < 0.0)? rel_pos.Mod(): fabs(rel_pos.Y());
+
+    double area = player.GetKickableArea();
+    if (player.IsGoalie()) {
+        area = Max(area, Max(ServerParam::instance().catchAreaLength(), player.GetMaxCatchArea()));
+    }
+
+    const double speed = Max(player.GetEffectiveSpeedMax(), player.GetPlayerSpeedMax());
+    const double cycle = (dist - area - player.GetVel().Mod()) / speed - player.GetPosDelay();
+
+    return MinMax(0, int(floor(cycle)) - 1, int(MobileState::Predictor::MAX_STEP));
+}
+
+/**
+ * @brief 获取指定球员的截球信息，首次用到时才计算
+ */
 PlayerInterceptInfo *InterceptInfo::GetPlayerInterceptInfo(Unum unum) const
+{
+    return const_cast<InterceptInfo *>(this)->VerifyIntInfo(unum);
+}
+
+PlayerInterceptInfo *InterceptInfo::GetPlayerInterceptSlot(Unum unum) const
 {
     if (!mpWorldState->GetPlayer(unum).IsAlive()) { return 0; }
 
@@ -100,12 +100,23 @@ public:
     InterceptInfo(WorldState *pWorldState, InfoState *pInfoState);
 
     PlayerInterceptInfo *GetPlayerInterceptInfo(Unum unum) const;
-    const std::vector<OrderedIT> & GetOIT() const { return mOIT; }
+    const std::vector<OrderedIT> & GetOIT() const;
     bool IsPlayerBallInterceptable(Unum unum) const { return GetPlayerInterceptInfo(unum)? GetPlayerInterceptInfo(unum)->mRes == IR_Success: false; } //可以在球出界前拦截到球
 
 	static void CalcTightInterception(const BallState & ball, PlayerInterceptInfo *pInfo, bool can_inverse = true); //求解可踢即可截`紧'截球区间 -- 考虑gotopoint修正
 	static void CalcLooseInterception(const BallState & ball, PlayerInterceptInfo *pInfo, const double & buffer); //求解buffer可截的`松‘截球区间 -- 不考虑gotopoint修正
 
+	/**
+	 * 截到从ball_pos沿ball_dir踢出的球所需周期的保守下界，不大于CalcTightInterception得到的mMinCycle，
+	 * 只用到球员到球路的距离，可以在不解截球模型的情况下剪掉截不过别人的球员
+	 */
+	static int GetMinCycleLowerBound(const Vector & ball_pos, const AngleDeg & ball_dir, const PlayerState & player);
+
+	/**
+	 * 世界状态在同一周期内被改过时，让所有球员的截球信息和OIT都重新计算
+	 */
+	void Invalidate();
+
 private:
 	static void CalcIdealInterception(const BallState & ball, PlayerInterceptInfo *pInfo, const double & buffer);
 	static void AnalyseInterceptSolution(const BallState & ball, PlayerInterceptInfo *pInfo);
@@ -115,11 +126,15 @@ private:
 
 	void SortIntercerptInfo();
 	PlayerInterceptInfo *VerifyIntInfo(Unum unum);
+	PlayerInterceptInfo *GetPlayerInterceptSlot(Unum unum) const;
 
 private:
     PlayerArray<PlayerInterceptInfo> mTeammateInterceptInfo;
     PlayerArray<PlayerInterceptInfo> mOpponentInterceptInfo;
     std::vector<OrderedIT> mOIT; //拦截排序链表
+
+    std::vector<InfoCache> mPlayerInterceptCache; // 按 unum > 0? unum: TEAMSIZE - unum 索引
+    InfoCache mOITCache; // 依赖所有球员的截球信息
 };
 
 #endif
@@ -173,10 +173,11 @@ Kicker::Kicker()
 	}
 
 
-	/** 将要读取或计算mKickerValue表 */
-	memset(mKickerValue, 0, sizeof(mKickerValue));
+	/** 将要读取或计算mKickerValue表，用缓存时等球员类型就绪后由PrepareUtilityTable映射 */
+	mKickerValue = 0;
+	mKickerBuffer = 0;
 
-    if (PlayerParam::instance().KickerMode() == 0)
+    if (PlayerParam::instance().KickerMode() == 0 && !PlayerParam::instance().UseTableCache())
     {
         ReadUtilityTable();
     }
@@ -188,6 +189,7 @@ Kicker::Kicker()
  */
 Kicker::~Kicker()
 {
+	delete[] mKickerBuffer;
 }
 
 
@@ -261,7 +263,7 @@ double Kicker::GetMaxSpeed(const Agent & agent, const Vector & kick_pos, const i
 	UpdateKickData(agent);
 
 	// absolute position of agent before the ball was kicked out
-	Vector player_pos_final = mInput.mPlayerPos + mInput.mPlayerVel.Rotate(mInput.mPlayerBodyDir) * ((1 - pow(PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay(), cycle-1)) / (1 - PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay()));
+	Vector player_pos_final = mInput.mPlayerPos + mInput.mPlayerVel.Rotate(mInput.mPlayerBodyDir) * ((1 - pow(PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay, cycle-1)) / (1 - PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay));
 
 	if (cycle > 3) /** 4脚肯定能踢到最快球速了 */
 	{
@@ -313,7 +315,7 @@ double Kicker::GetMaxSpeed(const Agent & agent, const Vector & kick_pos, const i
 						{
 							if (mPoint[l].Dist(ball_next) < mMaxAccel[k]) // 保证理论上可以从k踢到l
 							{
-								Vector ball_vel_next = (mPoint[l]+mInput.mPlayerVel*PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay() - mPoint[k]) * ServerParam::instance().ballDecay();
+								Vector ball_vel_next = (mPoint[l]+mInput.mPlayerVel*PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay - mPoint[k]) * ServerParam::instance().ballDecay();
 								double speed = GetOneKickMaxSpeed(ball_vel_next, (target-mPoint[l]).Dir(), mMaxAccel[l]);
 								if (max_speed < speed)
 								{
@@ -382,7 +384,7 @@ bool Kicker::KickBall(Agent & agent, const Vector & target, double speed_out, in
 		AtomicAction a;
 		a.mSucceed = false;
 		if((mInput.mBallPos + mInput.mBallVel).Dist(mInput.mPlayerPos + mInput.mPlayerVel) <
-				PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).kickableArea() - 0.05)
+				PlayerParam::instance().Profile(mInput.mPlayerType).mKickableArea - 0.05)
 		{
 			//a.mTurnAngle = mKickTarget.Dir();
 			a.mTurnAngle = GetNormalizeAngleDeg(mKickTarget.Dir());
@@ -513,36 +515,89 @@ void Kicker::ReadUtilityTable()
 		PRINT_ERROR("open file error");
 		return;
 	}
-	in_file.read((char *)mKickerValue, sizeof(mKickerValue));
+
+	if (mKickerBuffer == 0)
+	{
+		mKickerBuffer = new UtilityTable[3];
+	}
+	memset(mKickerBuffer, 0, sizeof(UtilityTable) * 3);
+	in_file.read((char *)mKickerBuffer, sizeof(UtilityTable) * 3);
 	in_file.close();
+	mKickerValue = mKickerBuffer;
 }
 
 
 /**
- * Compute kicker value table.
+ * 球员类型就绪后由Parser调用，只在这时参数才和server一致
  */
-void Kicker::ComputeUtilityTable()
+void Kicker::PrepareUtilityTable()
 {
-	Assert(Parser::IsPlayerTypesReady());
+	if (PlayerParam::instance().KickerMode() != 0 || !PlayerParam::instance().UseTableCache())
+	{
+		return;
+	}
 
-    mInput.mPlayerType = 0;//离线计算只考虑0号类型
-    for (int k = 0; k < POINTS_NUM; ++k)
-    {
-        mKickRate[k] = GetKickRate(mPoint[k], mInput.mPlayerType);
-        mMaxAccel[k] = ServerParam::instance().maxPower() * mKickRate[k];
-    }
+	Array<double, POINTS_NUM> max_accel;
+	GetUtilityMaxAccel(max_accel);
+
+	if (mKickerBuffer == 0)
+	{
+		mKickerBuffer = new UtilityTable[3];
+	}
+
+	UtilityTableGenerator generator(*this, max_accel);
+	const void * table = TableCache::instance().Load("kicker_value", GetUtilityTableKey(max_accel),
+			sizeof(UtilityTable) * 3, generator, mKickerBuffer);
 
-	AngleDeg kick_angle = 0.0;//踢球角度
+	mKickerValue = static_cast<const UtilityTable *>(table);
+	if (table != mKickerBuffer)
+	{
+		delete[] mKickerBuffer; //映射成功，自己的那份不再需要
+		mKickerBuffer = 0;
+	}
+}
+
+
+void Kicker::GetUtilityMaxAccel(Array<double, POINTS_NUM> & max_accel)
+{
+	for (int k = 0; k < POINTS_NUM; ++k)//离线计算只考虑0号类型
+	{
+		max_accel[k] = ServerParam::instance().maxPower() * GetKickRate(mPoint[k], 0);
+	}
+}
+
+
+unsigned long long Kicker::GetUtilityTableKey(const Array<double, POINTS_NUM> & max_accel)
+{
+	static const char name[] = "kicker_value"; //表的算法改了就改这里的名字
+	unsigned long long key = TableCache::Hash(name, sizeof(name));
+	key = TableCache::Hash(ServerParam::instance().ballDecay(), key);
+	key = TableCache::Hash(ServerParam::instance().ballSpeedMax(), key);
+	for (int k = 0; k < POINTS_NUM; ++k)
+	{
+		key = TableCache::Hash(mPoint[k].X(), key);
+		key = TableCache::Hash(mPoint[k].Y(), key);
+		key = TableCache::Hash(max_accel[k], key);
+	}
+	return key;
+}
+
+
+/**
+ * 每个角度内v[1]、v[2]只依赖同一角度的v[0]、v[1]，所以可以按角度分开算
+ */
+void Kicker::FillUtilityTable(UtilityTable * table, const Array<double, POINTS_NUM> & max_accel, int begin, int end)
+{
 	Vector ball_vel     = Vector(0.0, 0.0);
 	Vector ball_next    = Vector(0.0, 0.0);
 	double max_speed    = 0.0;
 
-	for (int v = 0; v < 3; ++v)//3次迭代，分别算v[0], v[1], v[2]
+	for (int i = begin; i < end; ++i)//踢球角度
 	{
-		for (int i = 0; i < 36; ++i)//踢球角度
-		{
-			kick_angle = STEP_KICK_ANGLE * i;
+		AngleDeg kick_angle = STEP_KICK_ANGLE * i;
 
+		for (int v = 0; v < 3; ++v)//3次迭代，分别算v[0], v[1], v[2]
+		{
 			for (int j = 0; j < POINTS_NUM; ++j)//初始位置，即第1脚kick前的位置
 			{
 				for (int k = 0; k < POINTS_NUM; ++k)//第1脚kick后的位置
@@ -551,7 +606,7 @@ void Kicker::ComputeUtilityTable()
 
 					if (v == 0)//v[0]直接算即可
 					{
-						mKickerValue[v][i][j][k] = (float)GetOneKickMaxSpeed(ball_vel, kick_angle, mMaxAccel[k]);
+						table[v][i][j][k] = (float)GetOneKickMaxSpeed(ball_vel, kick_angle, max_accel[k]);
 					}
 					else//v[1]和v[2]要迭代
 					{
@@ -560,18 +615,70 @@ void Kicker::ComputeUtilityTable()
 
 						for (int l = 0; l < POINTS_NUM; ++l)//从j踢到k，再踢到l
 						{
-							if (mPoint[l].Dist(ball_next) < mMaxAccel[k])//保证理论上可以从k踢到l
+							if (mPoint[l].Dist(ball_next) < max_accel[k])//保证理论上可以从k踢到l
 							{
-								max_speed = Max(max_speed, (double)mKickerValue[v - 1][i][k][l]);
+								max_speed = Max(max_speed, (double)table[v - 1][i][k][l]);
 							}
 						}
 
-						mKickerValue[v][i][j][k] = (float)max_speed;
+						table[v][i][j][k] = (float)max_speed;
 					}
 				}
 			}
 		}
 	}
+}
+
+
+void Kicker::UtilityTableGenerator::Generate(void * data)
+{
+	UtilityTable * table = static_cast<UtilityTable *>(data);
+	const int threads = MinMax(1, PlayerParam::instance().TableCacheThreads(), 36);
+	Worker * workers = new Worker[threads - 1];
+
+	for (int t = 0; t < threads; ++t)
+	{
+		const int angle_begin = 36 * t / threads;
+		const int angle_end = 36 * (t + 1) / threads;
+
+		if (t < threads - 1)
+		{
+			workers[t].mpGenerator = this;
+			workers[t].mpTable = table;
+			workers[t].mBegin = angle_begin;
+			workers[t].mEnd = angle_end;
+			workers[t].Start();
+		}
+		else
+		{
+			mKicker.FillUtilityTable(table, mMaxAccel, angle_begin, angle_end); //最后一段自己算
+		}
+	}
+
+	for (int t = 0; t < threads - 1; ++t)
+	{
+		workers[t].Join();
+	}
+	delete[] workers;
+}
+
+
+/**
+ * Compute kicker value table.
+ */
+void Kicker::ComputeUtilityTable()
+{
+	Assert(Parser::IsPlayerTypesReady());
+
+	Array<double, POINTS_NUM> max_accel;
+	GetUtilityMaxAccel(max_accel);
+
+	if (mKickerBuffer == 0)
+	{
+		mKickerBuffer = new UtilityTable[3];
+	}
+	FillUtilityTable(mKickerBuffer, max_accel, 0, 36);
+	mKickerValue = mKickerBuffer;
 
 	//写文件
 	std::ofstream out_file("kicker_value", std::ios::binary);
@@ -580,7 +687,7 @@ void Kicker::ComputeUtilityTable()
 		PRINT_ERROR("open file error");
 		return;
 	}
-	out_file.write((char *)mKickerValue, sizeof(mKickerValue));
+	out_file.write((char *)mKickerBuffer, sizeof(UtilityTable) * 3);
 	out_file.close();
 
     std::cerr << "compute kicker value over ..." << std::endl;
@@ -631,9 +738,9 @@ void Kicker::UpdateKickData(const Agent & agent)
 			angle_diff              = GetNormalizeAngleDeg(angle_diff);
 			double dir_diff         = Deg2Rad(fabs(angle_diff));
 			double dist_2_ball      = mPoint[i].Mod() -
-			    PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerSize() - ServerParam::instance().ballSize();
+			    PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerSize - ServerParam::instance().ballSize();
 			double kick_pos_rand    = dir_diff / M_PI +
-			    dist_2_ball / PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).kickableMargin();
+			    dist_2_ball / PlayerParam::instance().Profile(mInput.mPlayerType).mKickableMargin;
 			mRandEva[i] = mRandCurve.GetOutput(kick_pos_rand);
 		}
 	}
@@ -840,8 +947,8 @@ AtomicAction Kicker::GetTurnAction(const Agent & agent)
 	Vector ball_pos = mInput.mBallPos + mInput.mBallVel - mInput.mPlayerVel;
 	Vector ball_vel = mInput.mBallVel * ServerParam::instance().ballDecay();
 	Vector target   = mKickTarget - mInput.mPlayerVel;
-	if (ball_pos.Mod() < PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).kickableArea() - 0.05 &&
-        ball_pos.Mod() > PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerSize() + ServerParam::instance().ballSize() + 0.01)
+	if (ball_pos.Mod() < PlayerParam::instance().Profile(mInput.mPlayerType).mKickableArea - 0.05 &&
+        ball_pos.Mod() > PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerSize + ServerParam::instance().ballSize() + 0.01)
 	{
         double max_turn_angle = GetMaxTurnAngle(mInput.mPlayerType, mInput.mPlayerVel.Mod());
 		if (max_turn_angle > fabs(ball_pos.Dir()))
@@ -958,7 +1065,7 @@ ActionPlan Kicker::MultiCycleKick(const Agent & agent, int cycle)
 	/** 下面进行多脚踢球的规划 */
 	//target及mPoint都是在踢球的最后一个周期的坐标系中
 	Vector target    = mKickTarget
-	                   - mInput.mPlayerVel * ((1 - pow(PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay(), cycle-1)) / (1 - PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay()));
+	                   - mInput.mPlayerVel * ((1 - pow(PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay, cycle-1)) / (1 - PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay));
 	int best         = -1;
 	double poss      = 0.0;
 	double max_poss  = 0.0;
@@ -975,7 +1082,7 @@ ActionPlan Kicker::MultiCycleKick(const Agent & agent, int cycle)
 		}
 	}
 
-	if (poss < 0.001) {
+	if (poss < 0.001 && mKickerValue != 0) { //表还没准备好时不做多脚规划
 		//std::cerr << agent.GetSelfUnum() << "@" << agent.GetWorldState().CurrentTime() << ": no good" << std::endl;
 
 		for (int k = 0, v = cycle - 2, j = NearestPoint(mInput.mBallPos); k < POINTS_NUM; ++k)
@@ -999,7 +1106,7 @@ ActionPlan Kicker::MultiCycleKick(const Agent & agent, int cycle)
 						if (mPoint[l].Dist(ball_next) < mMaxAccel[k]) // 保证理论上可以从k踢到l
 						{
 							//mPoint[l]+PlayerVel*Decay是mPoint[l]在踢球的第二个周期的坐标系中的位置
-							Vector ball_vel_next = (mPoint[l]+mInput.mPlayerVel*PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay() - mPoint[k]) * ServerParam::instance().ballDecay();
+							Vector ball_vel_next = (mPoint[l]+mInput.mPlayerVel*PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay - mPoint[k]) * ServerParam::instance().ballDecay();
 							if (cycle == 3)
 							{
 								speed = Max(speed, GetOneKickMaxSpeed(ball_vel_next, (target-mPoint[l]).Dir(), mMaxAccel[l]));
@@ -1081,14 +1188,14 @@ AtomicAction Kicker::TurnPlan(const Agent & agent, int index, double turn_max_sp
 	Vector ball_pos     = mInput.mBallPos + ball_vel - mInput.mPlayerVel;
 	ball_vel            = ball_vel * ServerParam::instance().ballDecay();
 	Vector target       = mKickTarget - mInput.mPlayerVel;
-	Vector player_vel   = mInput.mPlayerVel * PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerDecay();
+	Vector player_vel   = mInput.mPlayerVel * PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerDecay;
 
 	// turn-转坐标轴之前的状态
 	ball_pos += ball_vel - player_vel;
 	ball_vel *= ServerParam::instance().ballDecay();
 	target   -= player_vel;
-	if (ball_pos.Mod() > PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).kickableArea() - 0.05 || //保证下周期球可踢
-			ball_pos.Mod() < PlayerParam::instance().HeteroPlayer(mInput.mPlayerType).playerSize() + ServerParam::instance().ballSize() + 0.01) //保证不碰撞
+	if (ball_pos.Mod() > PlayerParam::instance().Profile(mInput.mPlayerType).mKickableArea - 0.05 || //保证下周期球可踢
+			ball_pos.Mod() < PlayerParam::instance().Profile(mInput.mPlayerType).mPlayerSize + ServerParam::instance().ballSize() + 0.01) //保证不碰撞
 	{
 		a.mSucceed = false;
 		return a;
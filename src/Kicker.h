@@ -34,6 +34,7 @@
 #define __Kicker_H__
 
 #include "Agent.h"
+#include "TableCache.h"
 
 enum KickMode
 {
@@ -57,6 +58,12 @@ public:
      */
     void ComputeUtilityTable();
 
+    /**
+     * 球员类型就绪后调用：按当前参数的哈希从缓存目录映射mKickerValue表，没有就生成并写入缓存
+     * Map kicker value table from the table cache, generating it on a miss.
+     */
+    void PrepareUtilityTable();
+
     /**
      * 通过kick的误差模型计算踢球后的max_rand
      * Calculate maximum random error after kick action.
@@ -182,7 +189,47 @@ private:
     Array<double, 3> mDlayer;    /** 每层的半径 */
     Array<Vector, POINTS_NUM> mPoint; /** 存储所有点 */
 
-    float mKickerValue[3][36][POINTS_NUM][POINTS_NUM]; /** 2,3,4脚踢球，36个角度，POINTS_NUM个点 */ // float即可，节省所占空间
+    typedef float UtilityTable[36][POINTS_NUM][POINTS_NUM];
+
+    const UtilityTable * mKickerValue; /** 2,3,4脚踢球，36个角度，POINTS_NUM个点 */ // float即可，节省所占空间；准备好之前为0
+    UtilityTable * mKickerBuffer; /** 不用缓存或缓存未命中时自己存表的地方，[3]个，用到时才分配 */
+
+    /** 缓存未命中时生成mKickerValue表，按角度分给几个线程 */
+    class UtilityTableGenerator: public TableGenerator
+    {
+    public:
+    	UtilityTableGenerator(Kicker & kicker, const Array<double, POINTS_NUM> & max_accel):
+    		mKicker(kicker), mMaxAccel(max_accel) {}
+
+    	void Generate(void * data);
+
+    private:
+    	class Worker: public Thread
+    	{
+    	public:
+    		Worker(): mpGenerator(0), mpTable(0), mBegin(0), mEnd(0) {}
+
+    		UtilityTableGenerator * mpGenerator;
+    		UtilityTable * mpTable;
+    		int mBegin;
+    		int mEnd;
+
+    	private:
+    		void StartRoutine() { mpGenerator->mKicker.FillUtilityTable(mpTable, mpGenerator->mMaxAccel, mBegin, mEnd); }
+    	};
+
+    	Kicker & mKicker;
+    	const Array<double, POINTS_NUM> & mMaxAccel;
+    };
+
+    /** 0号类型在每个点能产生的最大加速度，生成mKickerValue表用，不动成员里的踢球数据 */
+    void GetUtilityMaxAccel(Array<double, POINTS_NUM> & max_accel);
+
+    /** 算出mKickerValue表中角度在[begin, end)内的部分，各角度之间互不依赖 */
+    void FillUtilityTable(UtilityTable * table, const Array<double, POINTS_NUM> & max_accel, int begin, int end);
+
+    /** mKickerValue表依赖的所有参数的哈希 */
+    unsigned long long GetUtilityTableKey(const Array<double, POINTS_NUM> & max_accel);
 
     ReciprocalCurve mOppCurve;      /** 对手的影响 */
     ReciprocalCurve mRandCurve;     /** 误差的影响 */
@@ -289,7 +289,7 @@ class Logger: public Thread
 
 	ThreadCondition mCondFlush;
 
-	Logger(): mpObserver(0), mpWorldState(0), mpSightLogger(0) {}
+	Logger(): Thread(TR_Logger), mpObserver(0), mpWorldState(0), mpSightLogger(0) {}
 
 public:
 	static Logger& instance();
@@ -164,9 +164,11 @@ void Net::Memaloc(){
 	}
 
 	mOutput = new real*[mLayers];
+	mOutputHigh = new real*[mLayers];
 	mDelta = new real*[mLayers];
 	for (int i = 1; i < mLayers; ++i){
 		mOutput[i] = new real[mUnits[i]];
+		mOutputHigh[i] = new real[mUnits[i]];
 		mDelta[i] = new real[mUnits[i]];
 	}
 }
@@ -200,9 +202,11 @@ void Net::Destroy()
 
 	for (int i = 1; i < mLayers; ++i){
 		delete[] mOutput[i];
+		delete[] mOutputHigh[i];
 		delete[] mDelta[i];
 	}
 	delete[] mOutput;
+	delete[] mOutputHigh;
 	delete[] mDelta;
 
 	delete[] mUnits;
@@ -422,6 +426,42 @@ void Net::Run(real *input, real *output)
 	}
 }
 
+/**
+ * 区间前向传播：每个输入在 [input_low, input_high] 内变化时，给出各输出的上下界。
+ * sigmoid 单调递增，每个单元的上界取正权值乘上一层上界、负权值乘上一层下界，下界反之。
+ * 用于不逐点跑网络就排除一整片区域。
+ */
+void Net::RunInterval(real *input_low, real *input_high, real *output_low, real *output_high)
+{
+	if (mUnits == 0)
+		return;
+	mOutput[0] = input_low;
+	mOutputHigh[0] = input_high;
+	for (int i = 1; i < mLayers; ++i){
+		for (int j = 0; j < mUnits[i]; ++j){
+			real low = mWeight[i][j][mUnits[i-1]];              //bias
+			real high = low;
+			for (int k = 0; k < mUnits[i-1]; ++k){
+				const real w = mWeight[i][j][k];
+				if (w > 0.0){
+					low += mOutput[i-1][k] * w;
+					high += mOutputHigh[i-1][k] * w;
+				}
+				else {
+					low += mOutputHigh[i-1][k] * w;
+					high += mOutput[i-1][k] * w;
+				}
+			}
+			mOutput[i][j] = sigmoid(low);
+			mOutputHigh[i][j] = sigmoid(high);
+		}
+	}
+	for (int i = 0; i < mUnits[mLayers-1]; ++i){
+		if (output_low != 0) output_low[i] = mOutput[mLayers-1][i];
+		if (output_high != 0) output_high[i] = mOutputHigh[mLayers-1][i];
+	}
+}
+
 real Net::Error()
 {
 	real error = 0.0;
@@ -43,6 +43,7 @@ class Net {
 	real ***mDeltaWeight;          ///delta weight of each conjuction between units
 	real **mDelta;                 ///delta value of each unit
 	real **mOutput;                ///output value of each unit
+	real **mOutputHigh;            ///upper bound of each unit in RunInterval (mOutput holds the lower bound)
 	real *mDesire;                 ///desired output value of output layer
 
 	real mEta;
@@ -66,6 +67,7 @@ public:
 	void TrainOnFile(const char *fname);
 	real TestOnFile(const char *fname);
 	real Error();
+	void RunInterval(real *input_low, real *input_high, real *output_low, real *output_high); ///bounds of output when each input lies in [input_low, input_high]
 
 	void SetLearningRate(real rate);
 	void SetAlpha(real a);
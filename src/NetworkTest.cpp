@@ -34,6 +34,85 @@
 #include "NetworkTest.h"
 
 
+namespace {
+
+/**
+ * 按命令类型累加计数
+ * Increase the counter of a certain command type.
+ */
+void IncreaseCommandCount(CMDCOUNT & count, CommandType type)
+{
+	switch (type)
+	{
+	case CT_Kick:
+		++count.Kicks;
+		break;
+	case CT_Turn:
+		++count.Turns;
+		break;
+	case CT_Dash:
+		++count.Dashs;
+		break;
+	case CT_Say:
+		++count.Says;
+		break;
+	case CT_TurnNeck:
+		++count.TurnNecks;
+		break;
+	case CT_Catch:
+		++count.Catchs;
+		break;
+	case CT_Move:
+		++count.Moves;
+		break;
+	case CT_ChangeView:
+		++count.ChangeViews;
+		break;
+	case CT_Pointto:
+		++count.Pointtos;
+		break;
+	case CT_Attentionto:
+		++count.Attentiontos;
+		break;
+	case CT_Tackle:
+		++count.Tackles;
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * 互斥的body命令数，每周期server最多执行一个
+ * Number of mutex body commands, of which server executes at most one each cycle.
+ */
+int GetBodyCommandCount(const CMDCOUNT & count)
+{
+	return count.Kicks + count.Dashs + count.Turns + count.Catchs + count.Moves + count.Tackles;
+}
+
+/**
+ * 以毫秒计的时间差，任一时间点没有记录时返回0
+ * Interval in ms between two time stamps, 0 if either of them was not recorded.
+ */
+int GetStageCost(const RealTime & begin, const RealTime & end)
+{
+	if (begin == RealTime(0, 0) || end == RealTime(0, 0) || end < begin)
+	{
+		return 0;
+	}
+	return end - begin;
+}
+
+const char *COMMAND_MISS_CAUSE_NAME[CMC_Max] = {
+		"parse_delay",
+		"decision_overrun",
+		"send_delay"
+};
+
+}
+
+
 
 StatisticUnit::StatisticUnit()
 {
@@ -342,6 +421,29 @@ NetworkTest::NetworkTest()
     CMDExecute.Tackles = 0;
     CMDExecute.Pointtos = 0;
     CMDExecute.Attentiontos = 0;
+
+    for (int i = 0; i < CYCLE_RECORD_SIZE; ++i)
+    {
+        mCycleRecord[i].mTime = Time(-3, 0);
+        memset(&mCycleRecord[i].mSend, 0, sizeof(CMDCOUNT));
+    }
+    mCycleRecordIndex = 0;
+
+    mHasLastExecute = false;
+    memset(&mLastExecute, 0, sizeof(CMDCOUNT));
+    mLastSenseTime = Time(-3, 0);
+
+    mReconcileCycles = 0;
+    mCommandCycles = 0;
+    mMissCycles = 0;
+    mDoubleCycles = 0;
+    mEmptyCycles = 0;
+    mLostCommands = 0;
+    mDoubleCommands = 0;
+    for (int i = 0; i < CMC_Max; ++i)
+    {
+        mMissCause[i] = 0;
+    }
 }
 
 NetworkTest::~NetworkTest()
@@ -496,44 +598,11 @@ void NetworkTest::SetCommandSendCount(const CommandInfo& cmd)
     {
         if (cmd.mType != CT_None)
         {
-            switch (cmd.mType)
-            {
-            case CT_Kick:
-                ++CMDSend.Kicks;
-                break;
-            case CT_Turn:
-                ++CMDSend.Turns;
-                break;
-            case CT_Dash:
-                ++CMDSend.Dashs;
-                break;
-            case CT_Say:
-                ++CMDSend.Says;
-                break;
-            case CT_TurnNeck:
-                ++CMDSend.TurnNecks;
-                break;
-            case CT_Catch:
-                ++CMDSend.Catchs;
-                break;
-            case CT_Move:
-                ++CMDSend.Moves;
-                break;
-            case CT_ChangeView:
-                ++CMDSend.ChangeViews;
-                break;
-            case CT_Pointto:
-                ++CMDSend.Pointtos;
-                break;
-            case CT_Attentionto:
-                ++CMDSend.Attentiontos;
-                break;
-            case CT_Tackle:
-                ++CMDSend.Tackles;
-                break;
-            default:
-                break;
-            }
+            IncreaseCommandCount(CMDSend, cmd.mType);
+
+            mCycleRecordMutex.Lock();
+            IncreaseCommandCount(GetCycleRecord(cmd.mTime).mSend, cmd.mType);
+            mCycleRecordMutex.UnLock();
         }
     }
 }
@@ -554,6 +623,144 @@ void NetworkTest::SetCommandExecuteCount(int d,int k,int tu,int s,int tn,int c,i
         CMDExecute.Pointtos = pt;
         CMDExecute.Tackles = tk;
         CMDExecute.Attentiontos = fc;
+
+        ReconcileCommands(CMDExecute);
+    }
+}
+
+
+/**
+ * 取得某周期的对账记录，没有时覆盖最旧的一条。调用前需要加锁
+ * Get the reconciliation record of a cycle, reusing the oldest slot if absent. Caller holds the lock.
+ */
+CycleCommandRecord & NetworkTest::GetCycleRecord(const Time & time)
+{
+    for (int i = 0; i < CYCLE_RECORD_SIZE; ++i)
+    {
+        if (mCycleRecord[i].mTime == time)
+        {
+            return mCycleRecord[i];
+        }
+    }
+
+    mCycleRecordIndex = (mCycleRecordIndex + 1) % CYCLE_RECORD_SIZE;
+    CycleCommandRecord & record = mCycleRecord[mCycleRecordIndex];
+    record.mTime = time;
+    memset(&record.mSend, 0, sizeof(CMDCOUNT));
+    record.mSenseBegin = RealTime(0, 0);
+    record.mSenseEnd = RealTime(0, 0);
+    record.mDecisionEnd = RealTime(0, 0);
+    record.mSendEnd = RealTime(0, 0);
+    return record;
+}
+
+
+/**
+ * 每次sense到来时，用server返回的执行计数增量与上周期发送的命令比较。
+ * 上周期发出但没有执行的命令是迟到或丢失的，执行数多于发送数说明有之前周期迟到的命令被重复计入。
+ * Called on each sense_body: the increase of execute counters since the last sense is compared to
+ * the commands we sent during the last cycle.
+ */
+void NetworkTest::ReconcileCommands(const CMDCOUNT & execute)
+{
+    mCycleRecordMutex.Lock();
+
+    CycleCommandRecord & current = GetCycleRecord(CurrentTime);
+    current.mSenseBegin = mParserRecord.mBeginTime;
+    current.mSenseEnd = GetRealTime();
+
+    if (mHasLastExecute && mLastSenseTime != CurrentTime)
+    {
+        const CycleCommandRecord & record = GetCycleRecord(mLastSenseTime);
+
+        const int send[] = {
+                record.mSend.Kicks, record.mSend.Dashs, record.mSend.Turns, record.mSend.Says,
+                record.mSend.TurnNecks, record.mSend.Catchs, record.mSend.Moves, record.mSend.ChangeViews,
+                record.mSend.Pointtos, record.mSend.Attentiontos, record.mSend.Tackles };
+        const int executed[] = {
+                execute.Kicks - mLastExecute.Kicks, execute.Dashs - mLastExecute.Dashs,
+                execute.Turns - mLastExecute.Turns, execute.Says - mLastExecute.Says,
+                execute.TurnNecks - mLastExecute.TurnNecks, execute.Catchs - mLastExecute.Catchs,
+                execute.Moves - mLastExecute.Moves, execute.ChangeViews - mLastExecute.ChangeViews,
+                execute.Pointtos - mLastExecute.Pointtos, execute.Attentiontos - mLastExecute.Attentiontos,
+                execute.Tackles - mLastExecute.Tackles };
+
+        int lost = 0;
+        int twice = 0;
+        for (unsigned i = 0; i < sizeof(send) / sizeof(send[0]); ++i)
+        {
+            if (executed[i] < send[i])
+            {
+                lost += send[i] - executed[i];
+            }
+            else if (executed[i] > send[i])
+            {
+                twice += executed[i] - send[i];
+            }
+        }
+
+        ++mReconcileCycles;
+        if (GetBodyCommandCount(record.mSend) > 0)
+        {
+            ++mCommandCycles;
+        }
+        else
+        {
+            ++mEmptyCycles;
+        }
+
+        if (lost > 0 || twice > 0)
+        {
+            CommandMissEvent event;
+            event.mTime = record.mTime;
+            event.mLost = lost;
+            event.mDouble = twice;
+            event.mCause = GetMissCause(record, event.mParseCost, event.mDecisionCost, event.mSendCost);
+            mMissEvents.push_back(event);
+
+            if (lost > 0)
+            {
+                ++mMissCycles;
+                ++mMissCause[event.mCause];
+                mLostCommands += lost;
+            }
+            if (twice > 0)
+            {
+                ++mDoubleCycles;
+                mDoubleCommands += twice;
+            }
+        }
+    }
+
+    mHasLastExecute = true;
+    mLastExecute = execute;
+    mLastSenseTime = CurrentTime;
+
+    mCycleRecordMutex.UnLock();
+}
+
+
+/**
+ * 把漏发归因到 sense 解析、决策、发送三个阶段中耗时最长的一个
+ * Blame the stage which took the longest among parse, decision and send.
+ */
+CommandMissCause NetworkTest::GetMissCause(const CycleCommandRecord & record, int & parse_cost, int & decision_cost, int & send_cost) const
+{
+    parse_cost = GetStageCost(record.mSenseBegin, record.mSenseEnd);
+    decision_cost = GetStageCost(record.mSenseEnd, record.mDecisionEnd);
+    send_cost = GetStageCost(record.mDecisionEnd, record.mSendEnd);
+
+    if (parse_cost >= decision_cost && parse_cost >= send_cost)
+    {
+        return CMC_ParseDelay;
+    }
+    else if (decision_cost >= send_cost)
+    {
+        return CMC_DecisionOverrun;
+    }
+    else
+    {
+        return CMC_SendDelay;
     }
 }
 
@@ -600,6 +807,10 @@ void NetworkTest::AddDecisionEnd(Time current_time)
         mDecisionRecord.mCostTime   = mDecisionRecord.mEndTime - mDecisionRecord.mBeginTime;
         mDecisionRecord.mTime       = current_time;
         mDecisionList.push_back(mDecisionRecord);
+
+        mCycleRecordMutex.Lock();
+        GetCycleRecord(current_time).mDecisionEnd = mDecisionRecord.mEndTime;
+        mCycleRecordMutex.UnLock();
     }
 }
 
@@ -623,6 +834,10 @@ void NetworkTest::AddCommandSendEnd(Time current_time)
         mCommandSendRecord.mCostTime    = mCommandSendRecord.mEndTime - mCommandSendRecord.mBeginTime;
         mCommandSendRecord.mTime        = current_time;
         mCommandSendList.push_back(mCommandSendRecord);
+
+        mCycleRecordMutex.Lock();
+        GetCycleRecord(current_time).mSendEnd = mCommandSendRecord.mEndTime;
+        mCycleRecordMutex.UnLock();
     }
 }
 
@@ -689,5 +904,57 @@ void NetworkTest::WriteRealTimeRecord()
 }
 
 
+//==============================================================================
+void NetworkTest::WriteCommandReconcile()
+{
+    if (PlayerParam::instance().NetworkTest())
+    {
+        char file_name[128];
+        sprintf(file_name, "Test/CommandReconcile-%d.txt", mUnum);
+        FILE *fp = fopen(file_name, "w");
+        if (fp == 0)
+        {
+            PRINT_ERROR("open file error " << file_name);
+            return;
+        }
+
+        mCycleRecordMutex.Lock();
+
+        double late_rate = 0.0;
+        if (mCommandCycles > 0)
+        {
+            late_rate = (double)mMissCycles / mCommandCycles;
+        }
+
+        fprintf(fp, "Cycles:          %d\n", mReconcileCycles);
+        fprintf(fp, "Command cycles:  %d\n", mCommandCycles);
+        fprintf(fp, "Empty cycles:    %d\n", mEmptyCycles);
+        fprintf(fp, "Miss cycles:     %d\n", mMissCycles);
+        fprintf(fp, "Double cycles:   %d\n", mDoubleCycles);
+        fprintf(fp, "Lost commands:   %d\n", mLostCommands);
+        fprintf(fp, "Double commands: %d\n", mDoubleCommands);
+        fprintf(fp, "Late rate:       %1.6f\n", late_rate);
+        fprintf(fp, "\n");
+        for (int i = 0; i < CMC_Max; ++i)
+        {
+            fprintf(fp, "%-18s%d\n", COMMAND_MISS_CAUSE_NAME[i], mMissCause[i]);
+        }
+
+        fprintf(fp, "\nCycle          Lost  Double  Parse(ms)  Decision(ms)  Send(ms)  Cause\n");
+        for (unsigned i = 0; i < mMissEvents.size(); ++i)
+        {
+            const CommandMissEvent & event = mMissEvents[i];
+            fprintf(fp, "(%4d,%3d)     %-6d%-8d%-11d%-14d%-10d%s\n", event.mTime.T(), event.mTime.S(),
+                    event.mLost, event.mDouble, event.mParseCost, event.mDecisionCost, event.mSendCost,
+                    COMMAND_MISS_CAUSE_NAME[event.mCause]);
+        }
+
+        mCycleRecordMutex.UnLock();
+
+        fclose(fp);
+    }
+}
+
+
 // end of NetworkTest.cpp
 
@@ -79,6 +79,7 @@
 #include <cstring>
 #include <fstream>
 #include "ActionEffector.h"
+#include "Thread.h"
 
 
 typedef struct{
@@ -134,6 +135,51 @@ struct RealTimeRecord
 };
 
 
+/**
+ * 漏发命令的原因
+ * Stage blamed for a command that was sent but not executed in its cycle.
+ */
+enum CommandMissCause
+{
+	CMC_ParseDelay,			// sense 解析耗时最长
+	CMC_DecisionOverrun,	// 决策（含等待视觉）耗时最长
+	CMC_SendDelay,			// 决策结束到命令发出耗时最长
+
+	CMC_Max
+};
+
+
+/**
+ * 每周期的命令对账记录，发送计数由 CommandSender 线程写入，时间戳由各阶段写入
+ * Per-cycle record used to reconcile commands sent against sense_body counters.
+ */
+struct CycleCommandRecord
+{
+	Time		mTime;			// 命令所属的周期
+	CMDCOUNT	mSend;			// 本周期发送的命令数
+	RealTime	mSenseBegin;	// sense 开始解析的系统时间
+	RealTime	mSenseEnd;		// sense 解析结束的系统时间
+	RealTime	mDecisionEnd;	// 决策结束的系统时间
+	RealTime	mSendEnd;		// 命令发送结束的系统时间
+};
+
+
+/**
+ * 单次漏发/重复执行事件
+ * One reconciliation event, kept for the summary written at bye.
+ */
+struct CommandMissEvent
+{
+	Time				mTime;		// 命令所属的周期
+	int					mLost;		// 发送了但没有执行的命令数
+	int					mDouble;	// 多执行的命令数
+	CommandMissCause	mCause;		// 归因
+	int					mParseCost;		// ms
+	int					mDecisionCost;	// ms
+	int					mSendCost;		// ms
+};
+
+
 class StatisticUnit{
 public:
 	StatisticUnit();
@@ -234,6 +280,37 @@ public:
 
     void WriteRealTimeRecord();
 
+    /**
+     * 比赛结束（bye）时输出命令对账的汇总
+     * Write the per-cycle command reconciliation summary, called at bye.
+     */
+    void WriteCommandReconcile();
+
+private:
+    CycleCommandRecord & GetCycleRecord(const Time & time);
+    void ReconcileCommands(const CMDCOUNT & execute);
+    CommandMissCause GetMissCause(const CycleCommandRecord & record, int & parse_cost, int & decision_cost, int & send_cost) const;
+
+    static const int CYCLE_RECORD_SIZE = 8;
+
+    ThreadMutex         mCycleRecordMutex;  // 发送线程与解析线程都会访问对账记录
+    CycleCommandRecord  mCycleRecord[CYCLE_RECORD_SIZE];
+    int                 mCycleRecordIndex;
+
+    bool        mHasLastExecute;    // 是否已经收到过sense
+    CMDCOUNT    mLastExecute;       // 上次sense时server返回的命令执行计数
+    Time        mLastSenseTime;     // 上次sense的周期
+
+    int mReconcileCycles;       // 对账的周期数
+    int mCommandCycles;         // 发送过body命令的周期数
+    int mMissCycles;            // 有命令没有被执行的周期数（迟到或丢失）
+    int mDoubleCycles;          // 执行数多于发送数的周期数
+    int mEmptyCycles;           // 没有发送body命令的周期数
+    int mLostCommands;          // 没有被执行的命令总数
+    int mDoubleCommands;        // 多执行的命令总数
+    int mMissCause[CMC_Max];    // 各原因的漏发周期数
+    std::vector<CommandMissEvent> mMissEvents;
+
 private:
     std::vector<RealTimeRecord> mParserList;
     std::vector<RealTimeRecord> mDecisionList;
@@ -55,6 +55,7 @@
  */
 
 #include <cstring>
+#include <algorithm>
 #include "Observer.h"
 #include "PlayerParam.h"
 #include "Logger.h"
@@ -78,6 +79,7 @@ Observer::Observer()
 {
 	// === 基本状态信息初始化 ===
 	mCurrentTime = Time(-1, 0);           // 当前时间，初始化为无效值
+	mSightGeneration = 1;                // 视觉编号，物体初始为0，即没有看到过
     mOurInitSide = '?';                 // 初始边（从init消息获得）
 	mOurSide = '?';                      // 当前边（l或r）
 	mOppSide = '?';                      // 对手边
@@ -318,18 +320,21 @@ void Observer::InitializePlayers()
 
 void Observer::SeeLine(SideLineType line, double dist, double dir)
 {
+	mLineObservers[line].SetGeneration(mSightGeneration);
 	mLineObservers[line].SetDist(dist, mCurrentTime);
 	mLineObservers[line].SetDir(dir, mCurrentTime);
 }
 
 void Observer::SeeMarker(MarkerType marker, double dist, double dir)
 {
+	mMarkerObservers[marker].SetGeneration(mSightGeneration);
 	mMarkerObservers[marker].SetDist(dist, mCurrentTime);
 	mMarkerObservers[marker].SetDir(dir, mCurrentTime);
 }
 
 void Observer::SeeMarker(MarkerType marker, double dist, double dir, double dist_chg, double dir_chg)
 {
+	mMarkerObservers[marker].SetGeneration(mSightGeneration);
 	mMarkerObservers[marker].SetDist(dist, mCurrentTime);
 	mMarkerObservers[marker].SetDir(dir, mCurrentTime);
 	mMarkerObservers[marker].SetDistChg(dist_chg, mCurrentTime);
@@ -338,11 +343,13 @@ void Observer::SeeMarker(MarkerType marker, double dist, double dir, double dist
 
 void Observer::SeeBall(double dist, double dir)
 {
+	mBallObserver.SetGeneration(mSightGeneration);
 	mBallObserver.SetDist(dist, mCurrentTime);
 	mBallObserver.SetDir(dir, mCurrentTime);
 }
 void Observer::SeeBall(double dist, double dir, double dist_chg, double dir_chg)
 {
+	mBallObserver.SetGeneration(mSightGeneration);
 	mBallObserver.SetDist(dist, mCurrentTime);
 	mBallObserver.SetDir(dir, mCurrentTime);
 	mBallObserver.SetDistChg(dist_chg, mCurrentTime);
@@ -353,6 +360,7 @@ void Observer::SeePlayer(double dist, double dir)
 {
 	if (mUnknownPlayerCount < MAX_UNKNOWN_PLAYES){
 		mUnknownPlayers[mUnknownPlayerCount].SetIsKnownSide(false);
+		mUnknownPlayers[mUnknownPlayerCount].SetGeneration(mSightGeneration);
 		mUnknownPlayers[mUnknownPlayerCount].SetDist(dist, mCurrentTime);
 		mUnknownPlayers[mUnknownPlayerCount].SetDir(dir, mCurrentTime);
 		mUnknownPlayersBugInfo[mUnknownPlayerCount] = mCurrentBugInfo;
@@ -373,6 +381,7 @@ void Observer::SeePlayer(char side, double dist, double dir, bool is_tackling, b
 	if (mUnknownPlayerCount < MAX_UNKNOWN_PLAYES){
 		mUnknownPlayers[mUnknownPlayerCount].SetIsKnownSide(true);
 		mUnknownPlayers[mUnknownPlayerCount].SetSide(side);
+		mUnknownPlayers[mUnknownPlayerCount].SetGeneration(mSightGeneration);
 		mUnknownPlayers[mUnknownPlayerCount].SetDist(dist, mCurrentTime);
 		mUnknownPlayers[mUnknownPlayerCount].SetDir(dir, mCurrentTime);
 		mUnknownPlayers[mUnknownPlayerCount].SetIsTcakling(is_tackling, mCurrentTime);
@@ -397,6 +406,7 @@ void Observer::SeePlayer(char side, int num, double dist, double dir, double dis
 		double head_dir, bool is_pointing, double point_dir, bool is_tackling, bool is_kicked, bool is_lying, CardType card_type)
 {
 	if (side == mOurSide){
+		mTeammateObservers[num].SetGeneration(mSightGeneration);
 		mTeammateObservers[num].SetDist(dist, mCurrentTime);
 		mTeammateObservers[num].SetDir(dir, mCurrentTime);
 		mTeammateObservers[num].SetDistChg(dist_chg, mCurrentTime);
@@ -411,6 +421,7 @@ void Observer::SeePlayer(char side, int num, double dist, double dir, double dis
 		mTeammateObservers[num].SetCardType(card_type);
 	}
 	else {
+		mOpponentObservers[num].SetGeneration(mSightGeneration);
 		mOpponentObservers[num].SetDist(dist, mCurrentTime);
 		mOpponentObservers[num].SetDir(dir, mCurrentTime);
 		mOpponentObservers[num].SetDistChg(dist_chg, mCurrentTime);
@@ -440,6 +451,7 @@ void Observer::SeePlayer(char side, int num, double dist, double dir, double dis
 void Observer::SeePlayer(char side, int num, double dist, double dir, bool is_pointing, double point_dir, bool is_tackling, bool is_kicked, bool is_lying, CardType card_type)
 {
 	if (side == mOurSide){
+		mTeammateObservers[num].SetGeneration(mSightGeneration);
 		mTeammateObservers[num].SetDist(dist, mCurrentTime);
 		mTeammateObservers[num].SetDir(dir, mCurrentTime);
 		mTeammateObservers[num].SetIsPointing(is_pointing, mCurrentTime);
@@ -450,6 +462,7 @@ void Observer::SeePlayer(char side, int num, double dist, double dir, bool is_po
 		mTeammateObservers[num].SetCardType(card_type);
 	}
 	else {
+		mOpponentObservers[num].SetGeneration(mSightGeneration);
 		mOpponentObservers[num].SetDist(dist, mCurrentTime);
 		mOpponentObservers[num].SetDir(dir, mCurrentTime);
 		mOpponentObservers[num].SetIsPointing(is_pointing, mCurrentTime);
@@ -684,7 +697,7 @@ void Observer::HearTeammateSay(AngleDeg hear_dir, Unum hear_unum, const std::str
 
 
 //==============================================================================
-bool Observer::WaitForNewInfo()
+bool Observer::WaitForNewInfo(bool sense_only)
 {
 	Lock();
 	Reset();
@@ -701,7 +714,9 @@ bool Observer::WaitForNewInfo()
 		}
 		else {
 			flag = WaitForNewSense(); //首先等到sense信息，然后在花40毫秒等一下hear和sight
-			WaitForNewSight();
+			if (!sense_only) { // 推测决策时在决策之后再等视觉
+				WaitForNewSight();
+			}
 		}
 	}
 
@@ -754,30 +769,91 @@ bool Observer::WaitForNewSight()
 	}
 	else
 	{
-        // TODO: rcssserver13.2.0开始，所有信息均在周期一开始就发，这里暂时不判断是否有视觉，所有周期均等WaitSightBuffer
-        if (true /** WillBeNewSight() */)
-		{
-			max_time = ServerParam::instance().synchSeeOffset() + PlayerParam::instance().WaitSightBuffer();
-		}
-		else
+        // rcssserver13.2.0开始，所有信息均在周期一开始就发，固定等待时间作为上限，学习到的到达时间足够时提前开始决策
+		max_time = (ServerParam::instance().synchSeeOffset() + PlayerParam::instance().WaitSightBuffer()) * ServerParam::instance().slowDownFactor();
+
+		if (PlayerParam::instance().AdaptiveSightWait())
 		{
-			max_time = PlayerParam::instance().WaitHearBuffer(); // though there will be no sight msg, take 10ms to wait for the hear msg
+			max_time = GetAdaptiveSightWaitTime(max_time);
 		}
-		max_time *= ServerParam::instance().slowDownFactor();
 	}
 
 	bool ret = true;
 	if (mSightArrived == false){
-		bool timeout = mCondNewSight.Wait(max_time);
-		if (timeout){
+		if (max_time <= 0) // Wait(0)在windows下是无限等待
+		{
 			ret = false;
 		}
+		else
+		{
+			bool timeout = mCondNewSight.Wait(max_time);
+			if (timeout){
+				ret = false;
+			}
+		}
 	}
 	mSightArrived = false;
 	return ret;
 }
 
 
+/**
+ * 根据本周期是否会有视觉，以及学习到的到达时间分布，计算从现在起还需要等待的时间
+ * Compute how long to wait from now on, using WillBeNewSight() and the learned arrival offsets.
+ * \param max_time the fixed wait time, which is used as the upper bound.
+ */
+int Observer::GetAdaptiveSightWaitTime(int max_time)
+{
+	int offset = -1;
+	Lock(); // 样本由parser线程写入，读时要互斥
+	if (WillBeNewSight())
+	{
+		offset = mArrivalObserver.GetSightOffset(Sense().GetViewWidth(), PlayerParam::instance().SightWaitPercentile());
+		UnLock();
+	}
+	else
+	{
+		offset = mArrivalObserver.GetHearOffset(PlayerParam::instance().SightWaitPercentile());
+		UnLock();
+		if (offset < 0) // 还没有统计，与原来没有视觉时一样只等hear
+		{
+			offset = PlayerParam::instance().WaitHearBuffer() * ServerParam::instance().slowDownFactor();
+		}
+	}
+
+	if (offset < 0) // 样本不足，按固定时间等待
+	{
+		return max_time;
+	}
+
+	offset += PlayerParam::instance().SightWaitMargin() * ServerParam::instance().slowDownFactor();
+	int wait_time = offset - (RealTime(GetRealTime()) - mLastCycleBeginRealTime);
+	return Max(0, Min(wait_time, max_time));
+}
+
+
+//==============================================================================
+void Observer::AddSightArrival(RealTime time)
+{
+	int offset = time - mLastCycleBeginRealTime;
+	if (offset >= 0 && offset < ServerParam::instance().simStep() * ServerParam::instance().slowDownFactor())
+	{
+		mArrivalObserver.AddSightOffset(Sense().GetViewWidth(), offset);
+	}
+}
+
+
+//==============================================================================
+void Observer::AddHearArrival(RealTime time)
+{
+	int offset = time - mLastCycleBeginRealTime;
+	if (offset >= 0 && offset < ServerParam::instance().simStep() * ServerParam::instance().slowDownFactor())
+	{
+		mArrivalObserver.AddHearOffset(offset);
+	}
+}
+
+
 //==============================================================================
 bool Observer::WaitForCommandSend()
 {
@@ -884,3 +960,75 @@ bool Observer::WillBeNewSight()
 		return false;
 	}
 }
+
+
+//==============================================================================
+const int ArrivalObserver::SAMPLE_SIZE = 100;
+const int ArrivalObserver::MIN_SAMPLE_SIZE = 20;
+
+ArrivalObserver::ArrivalObserver()
+{
+	for (int i = 0; i <= VW_Wide; ++i)
+	{
+		mSightOffset[i].reserve(SAMPLE_SIZE); // 预先分配好，添加样本时不再重新分配
+		mSightIndex[i] = 0;
+	}
+	mHearOffset.reserve(SAMPLE_SIZE);
+	mHearIndex = 0;
+}
+
+void ArrivalObserver::AddSightOffset(ViewWidth view_width, int offset)
+{
+	if (view_width > VW_None && view_width <= VW_Wide)
+	{
+		AddSample(mSightOffset[view_width], mSightIndex[view_width], offset);
+	}
+}
+
+void ArrivalObserver::AddHearOffset(int offset)
+{
+	AddSample(mHearOffset, mHearIndex, offset);
+}
+
+int ArrivalObserver::GetSightOffset(ViewWidth view_width, double percentile) const
+{
+	if (view_width > VW_None && view_width <= VW_Wide)
+	{
+		return GetPercentile(mSightOffset[view_width], percentile);
+	}
+	return -1;
+}
+
+int ArrivalObserver::GetHearOffset(double percentile) const
+{
+	return GetPercentile(mHearOffset, percentile);
+}
+
+/**
+ * 样本存成环形队列，满了以后覆盖最旧的样本，以跟上网络环境的变化
+ */
+void ArrivalObserver::AddSample(std::vector<int> & samples, int & index, int offset)
+{
+	if ((int)samples.size() < SAMPLE_SIZE)
+	{
+		samples.push_back(offset);
+	}
+	else
+	{
+		samples[index] = offset;
+		index = (index + 1) % SAMPLE_SIZE;
+	}
+}
+
+int ArrivalObserver::GetPercentile(const std::vector<int> & samples, double percentile)
+{
+	if ((int)samples.size() < MIN_SAMPLE_SIZE)
+	{
+		return -1;
+	}
+
+	std::vector<int> sorted(samples);
+	std::vector<int>::iterator it = sorted.begin() + Min((int)sorted.size() - 1, (int)(percentile * sorted.size()));
+	std::nth_element(sorted.begin(), it, sorted.end());
+	return *it;
+}
@@ -86,14 +86,22 @@ public:
 //======================================================================================================================
 /**
 * 基本的视觉观察类
+* mGeneration 记录最后一次被看到时的视觉编号，与 Observer 当前的视觉编号相同才是最新视觉中看到的，
+* 这样开始新视觉时只需把编号加一，不用清除各个物体上一次的观察值
 */
 class SightObserver {
 	ObserverRecord<double>   mDist;						///相对距离
 	ObserverRecord<AngleDeg> mDir;						///相对自己头部的方向 -- 头部角度指全局的脖子角度
 	ObserverRecord<double>   mDistChg;					///相对距离的变化量 -- 径向速度
 	ObserverRecord<AngleDeg> mDirChg;					///相对角度的变化 --- 法向速度
+	unsigned                 mGeneration;				///最后一次看到时的视觉编号
 
 public:
+	SightObserver(): mGeneration(0) {}
+
+	unsigned Generation() const { return mGeneration; }
+	void SetGeneration(unsigned generation) { mGeneration = generation; }
+
 	const double & Dist() const { return mDist.value(); }
 	const AngleDeg & Dir() const { return mDir.value(); }
 	const double & DistChg() const { return mDistChg.value(); }
@@ -540,6 +548,35 @@ public:
 	}
 };
 
+//======================================================================================================================
+/**
+* 信息到达时间观察类，按视角宽度分别统计 sense 到 sight 的时间间隔，以及 sense 到 hear 的时间间隔（毫秒），
+* 用来决定每周期等待视觉的时间。样本由parser线程在 Observer::Lock() 下写入，读取时也要先加锁
+*/
+class ArrivalObserver {
+public:
+	ArrivalObserver();
+
+	void AddSightOffset(ViewWidth view_width, int offset);
+	void AddHearOffset(int offset);
+
+	/** 样本不足时返回 -1 */
+	int GetSightOffset(ViewWidth view_width, double percentile) const;
+	int GetHearOffset(double percentile) const;
+
+private:
+	static void AddSample(std::vector<int> & samples, int & index, int offset);
+	static int GetPercentile(const std::vector<int> & samples, double percentile);
+
+	static const int SAMPLE_SIZE;		///每种信息最多保留的样本数
+	static const int MIN_SAMPLE_SIZE;	///样本数少于此值时不使用统计结果
+
+	std::vector<int> mSightOffset[VW_Wide + 1];
+	int mSightIndex[VW_Wide + 1];
+	std::vector<int> mHearOffset;
+	int mHearIndex;
+};
+
 //======================================================================================================================
 /**
 * 观察类，存放从 Parser 里得到的第一手数据，其他数据都从此计算得到
@@ -673,7 +710,8 @@ public:
 
 	const Time & CurrentTime() const { return mCurrentTime; }
 	const Time & LatestSightTime() const { return mLatestSightTime; }
-	void SetLatestSightTime(const Time & time) { mLatestSightTime = time; }
+	void BeginSight() { mLatestSightTime = mCurrentTime; ++mSightGeneration; } //开始解析新的视觉，之前看到的都过期
+	bool IsInLatestSight(const SightObserver & obj) const { return obj.Generation() == mSightGeneration; }
 
 	const PlayMode & GetPlayMode() const { return mPlayMode; }
 	const KickOffMode & GetKickOffMode() const {return mKickOffMode;}
@@ -713,6 +751,7 @@ public:
 private:
 	Time mCurrentTime;							//当前时间
 	Time mLatestSightTime;                      //收到最新视觉的时间，在等漏视觉的情况下，比mCurrentTime小
+	unsigned mSightGeneration;                  //最新视觉的编号，每收到一个视觉加一
 
 	PlayMode mPlayMode;
 	KickOffMode mKickOffMode;
@@ -734,15 +773,17 @@ private:
 	bool mIsBallDropped; //球是否被drop
 	bool mIsNewOppType;  //教练是否发来新的对手异构
 
-	SenseObserver  mSenseObserver;
-	AudioObserver  mAudioObserver;
+	//视觉观察按 server 发送的顺序排列（标志、球、球员、边线），解析时顺序写入
 	Array<MarkerObserver, FLAG_MAX> mMarkerObservers;
 	BallObserver   mBallObserver;
 	PlayerArray<PlayerObserver> mTeammateObservers;
 	PlayerArray<PlayerObserver> mOpponentObservers;
-	Array<LineObserver, SL_MAX> mLineObservers;
 	Array<UnknownPlayerObserver, TEAMSIZE * 2> mUnknownPlayers;
-	int mUnknownPlayerCount;							//每个周期更新时都要设为0
+	int mUnknownPlayerCount;							//每个视觉开始时设为0，之前的未知球员不用清除
+	Array<LineObserver, SL_MAX> mLineObservers;
+
+	SenseObserver  mSenseObserver;
+	AudioObserver  mAudioObserver;
 
 	//for using server bug
 	Array<ServerBugInfo, TEAMSIZE * 2> mUnknownPlayersBugInfo;
@@ -763,7 +804,7 @@ public:
 	/*
 	 * synch with parser thread
 	 */
-	bool WaitForNewInfo();
+	bool WaitForNewInfo(bool sense_only = false);
 
 	bool WaitForNewSense();
 	bool WaitForNewSight();
@@ -785,12 +826,17 @@ public:
 
 	bool WillBeNewSight(); /** whether there will be the sight msg in this cycle */
 
+	void AddSightArrival(RealTime time);
+	void AddHearArrival(RealTime time);
+	int GetAdaptiveSightWaitTime(int max_time);
+
 	void SetPlanned() { mIsPlanned = true; }
 	bool IsPlanned() const { return mIsPlanned; }
 
 private:
 	RealTime        mLastCycleBeginRealTime;    /** last cycle begin time */
 	RealTime        mLastSightRealTime;         /** last sight msg time */
+	ArrivalObserver mArrivalObserver;           /** sense->sight/hear arrival offsets */
 
     bool            mIsBeginDecision;
 	bool            mIsNewSense;
@@ -257,6 +257,64 @@ void ParamEngine::DumpParam()
 	DumpParam(std::cout);
 }
 
+/**
+ * @brief 按server消息的格式打印单个参数
+ *
+ * 格式为"(name value)"，字符串加双引号，开关输出为1/0，与rcssserver下发的
+ * server_param/player_param一致，ParseFromServerMsg可以原样读回。
+ *
+ * @param name 参数名
+ * @param os 输出流
+ * @return bool 是否打印成功
+ */
+bool ParamEngine::PrintServerMsg(const char *name, std::ostream &os)
+{
+	ParamPtr it;
+	if (name == 0 || !GetParam(name, it))
+	{
+		std::cerr << __FILE__ << ":" << __LINE__ << ": unknown argument \'" << (name? name: "") << "\'" << std::endl;
+		return false;
+	}
+
+	os << '(' << it->name << ' ';
+	switch(it->type)
+	{
+		case V_INT:
+			os << *static_cast<int*>(it->ptr);
+			break;
+		case V_DOUBLE:
+			os << *static_cast<double*>(it->ptr);
+			break;
+		case V_STRING:
+			os << '\"' << *static_cast<std::string*>(it->ptr) << '\"';
+			break;
+		case V_ONOFF:
+			os << (*static_cast<bool*>(it->ptr)? 1: 0);
+			break;
+		default:
+			return false;
+	}
+	os << ')';
+	return true;
+}
+
+/**
+ * @brief 按server消息的格式导出所有参数，不换行
+ *
+ * @param os 输出流
+ */
+void ParamEngine::DumpServerMsg(std::ostream &os)
+{
+	for (int i = 0; i < HASH_SIZE; ++i)
+	{
+		ParamList &param_list = mParamLists[i];
+		for (ParamPtr it = param_list.begin(); it != param_list.end(); ++it)
+		{
+			PrintServerMsg(it->name.c_str(), os);
+		}
+	}
+}
+
 /**
  * @brief 保存所有参数到配置文件
  *
@@ -193,6 +193,12 @@ public:
 	bool PrintParam(const char *name);
 	void DumpParam(std::ostream &os);
 	void DumpParam();
+
+	/**
+	 * 按server消息的格式输出参数：(name value)，开关输出为1/0，供替身server下发
+	 */
+	bool PrintServerMsg(const char *name, std::ostream &os);
+	void DumpServerMsg(std::ostream &os);
 	bool SaveToConfigFile(const char *file_name);
 
 	/**
@@ -71,6 +71,9 @@
 #include "Logger.h"
 #include "Thread.h"
 #include "NetworkTest.h"
+#include "InfoState.h"
+#include "Agent.h"
+#include "Kicker.h"
 
 // === 静态成员变量初始化 ===
 char Parser::mBuf[MAX_MESSAGE];                                   // 消息缓冲区
@@ -97,7 +100,7 @@ const double Parser::INVALID_VALUE = std::numeric_limits<double>::max();  // 无
  * @note 初始化各种状态标志为false
  * @note 初始化服务器比赛模式映射
  */
-Parser::Parser(Observer *p_observer)
+Parser::Parser(Observer *p_observer): Thread(TR_Parser)
 {
 	// === 设置观察者引用 ===
 	mpObserver = p_observer;
@@ -109,6 +112,7 @@ Parser::Parser(Observer *p_observer)
 	mSynchOk = false;         // 同步状态
 	mEyeOnOk = false;          // 视觉状态
 	mEarOnOk = false;          // 听觉状态
+	mStartupDone = false;      // 各个表是否已构造完
 
 	// === 初始化服务器比赛模式 ===
 	mLastServerPlayMode = SPM_Null;
@@ -168,6 +172,12 @@ void Parser::StartRoutine()
 	// === 连接到服务器 ===
 	ConnectToServer();
 
+	// Dasher、Kicker等的构造函数要读 ServerParam/PlayerParam，与连接同时在别的线程构造，
+	// 构造完之前不能解析 server_param 等参数消息，消息先留在socket的缓冲区里
+	while (!IsStartupDone()) {
+		mStartupCond.Wait(CONNECT_WAIT_SLICE);
+	}
+
 	// === 主消息处理循环 ===
 	while( true )
 	{
@@ -200,6 +210,7 @@ void Parser::ConnectToServer()
 	mOkMutex.Lock();
 	mConnectServerOk = true;
 	mOkMutex.UnLock();
+	mConnectCond.Set();
 
 	DynamicDebug::instance().Initial(mpObserver); // 动态调试的初始化，知道自己是哪边了才能初始化，位置不能动
 	DynamicDebug::instance().AddMessage(mBuf, MT_Parse); // 动态调试记录Parse信息
@@ -207,6 +218,32 @@ void Parser::ConnectToServer()
 	//Logger::instance().GetTextLogger("msg-text") << mBuf << std::endl;
 }
 
+void Parser::SetStartupDone()
+{
+	mOkMutex.Lock();
+	mStartupDone = true;
+	mOkMutex.UnLock();
+	mStartupCond.Set();
+}
+
+bool Parser::WaitForConnectServer(int ms)
+{
+	RealTime deadline = GetRealTime();
+	deadline = deadline + ms;
+
+	while (!IsConnectServerOk()) {
+		RealTime now = GetRealTime();
+		if (!(now < deadline)) {
+			return false;
+		}
+
+		//ThreadCondition 没有谓词，Set 发生在检查和等待之间时会丢失，所以每次最多等一小段
+		mConnectCond.Wait(Min(int(deadline.Sub(now) / 1000) + 1, int(CONNECT_WAIT_SLICE)));
+	}
+
+	return true;
+}
+
 void Parser::SendInitialLizeMsg(){
 	//TODO: how about reconnect
 	std::ostringstream init_string;
@@ -288,6 +325,8 @@ bool Parser::ParseInitializeMsg(const char *msg)
 
 	TimeTest::instance().SetUnum(my_unum); // TimeTest的记录文件名会用到
 	NetworkTest::instance().SetUnum(my_unum);
+	InfoStateTest::instance().SetUnum(my_unum);
+	AgentPoolTest::instance().SetUnum(my_unum);
 
 	return true;
 }
@@ -547,6 +586,7 @@ void Parser::ParseTime(char *msg, char **end_ptr, bool is_new_cycle)
 	int time = parser::get_int(end_ptr);
 
 	RealTime real_time = GetRealTimeParser();
+	mMsgRealTime = real_time;
 
 	/* if (mpObserver->IsPlanned()) { // -- 决策完了，才收到信息
 		std::cerr << "# " << mpObserver->SelfUnum() << " @ " << mpObserver->CurrentTime() << " got a deprecated message" << std::endl;
@@ -604,6 +644,7 @@ void Parser::ParseServerParam(char *msg)
 	msg += 13; // 去掉"(server_param"
 	ServerParam::instance().ParseFromServerMsg(msg);
 	ServerParam::instance().MaintainConsistency();
+	PlayerParam::instance().CheckSightTables();
 }
 
 void Parser::ParsePlayerType(char *msg)
@@ -620,6 +661,10 @@ void Parser::ParsePlayerType(char *msg)
 
 	if (type >= PlayerParam::instance().playerTypes() - 1) {
 		mIsPlayerTypesReady = true;
+
+		if (!PlayerParam::instance().isCoach() && !PlayerParam::instance().isTrainer()) {
+			Kicker::instance().PrepareUtilityTable(); //参数已经和server一致，可以取派生表了
+		}
 	}
 }
 
@@ -640,7 +685,8 @@ void Parser::ParseSight(char *msg)
 	NetworkTest::instance().End("Sense", "Sight");
 
 	mpObserver->SetLastSightRealTime(GetRealTimeParser()); // set the last sight time
-	mpObserver->SetLatestSightTime(mpObserver->CurrentTime());
+	mpObserver->AddSightArrival(mpObserver->GetLastSightRealTime());
+	mpObserver->BeginSight();
 
 	msg = strstr(msg,"((");
 	// 循环解析视觉消息中的所有对象
@@ -1565,6 +1611,7 @@ void Parser::ParseSound(char *msg)
 			buffer[n] = '\0';
 
 			mpObserver->HearTeammateSay(dir, unum, std::string(buffer));
+			mpObserver->AddHearArrival(mMsgRealTime);
 		}
 		else
 		{
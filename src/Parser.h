@@ -310,6 +310,9 @@ private:
   ObjProperty_Fullstate ParseObjProperty_Fullstate(char* msg);
 
 	ThreadMutex mOkMutex; //更新ok信息是要与决策线程互斥
+	ThreadCondition mConnectCond; //连上server时唤醒等待的主线程
+	ThreadCondition mStartupCond; //各个表构造完时唤醒等待的Parser线程
+	bool mStartupDone;
 	int mHalfTime; // 记录是第几个half
     bool mConnectServerOk;
 	bool mClangOk;
@@ -317,11 +320,22 @@ private:
 	bool mEyeOnOk; //only used when is coach
 	bool mEarOnOk;
 	PlayerArray<bool, true> mChangePlayerTypeOk;
+	RealTime mMsgRealTime; // 最近一条带周期信息的消息到达的系统时间
 
 	static char mBuf[MAX_MESSAGE];
 
 public:
     bool IsConnectServerOk() { bool ret; mOkMutex.Lock(); ret = mConnectServerOk; mOkMutex.UnLock(); return ret; }
+
+    /**
+     * 等待Parser线程连上server，最多等ms毫秒，返回是否连上
+     */
+    bool WaitForConnectServer(int ms);
+
+    /**
+     * 各个表都构造完了，Parser线程可以开始解析参数消息，见 StartRoutine()
+     */
+    void SetStartupDone();
 	bool IsClangOk() { bool ret; mOkMutex.Lock(); ret = mClangOk; mOkMutex.UnLock(); return ret; }
 	bool IsSyncOk() { bool ret; mOkMutex.Lock(); ret = mSynchOk; mOkMutex.UnLock(); return ret; }
 	bool IsEyeOnOk() { bool ret; mOkMutex.Lock(); ret = mEyeOnOk; mOkMutex.UnLock(); return ret; }
@@ -331,9 +345,15 @@ public:
 	static bool IsPlayerTypesReady() { return mIsPlayerTypesReady; }
 
 private:
+	bool IsStartupDone() { bool ret; mOkMutex.Lock(); ret = mStartupDone; mOkMutex.UnLock(); return ret; }
+
 	static bool mIsPlayerTypesReady;
 	static const double INVALID_VALUE;
 
+	enum {
+		CONNECT_WAIT_SLICE = 20 // 等待连上server时每次最多睡的毫秒数
+	};
+
 	static bool InvalidValue(const double & x) {
 		return x >= INVALID_VALUE - FLOAT_EPS;
 	}
@@ -57,12 +57,15 @@
 #include "Thread.h"
 #include "UDPSocket.h"
 #include "WorldModel.h"
+#include "WorldState.h"
 #include "Agent.h"
 #include "VisualSystem.h"
 #include "Logger.h"
 #include "CommunicateSystem.h"
 #include "TimeTest.h"
 #include "Dasher.h"
+#include <cstdio>
+#include <fstream>
 
 /**
  * @brief Player 类构造函数
@@ -71,7 +74,9 @@
  * Player 类是整个球员智能体系统的核心控制器。
  */
 Player::Player():
-	mpDecisionTree( new DecisionTree )
+	mpDecisionTree( new DecisionTree ),
+	mSpeculativeCount( 0 ),
+	mReplanCount( 0 )
 {
 	// 决策树是球员的核心决策模块，负责选择最佳行为
 }
@@ -85,6 +90,37 @@ Player::Player():
 Player::~Player()
 {
 	delete mpDecisionTree;  // 释放决策树内存
+
+	if (mSpeculativeCount > 0 && PlayerParam::instance().TimeTest()) {
+		char file_name[256];
+		sprintf(file_name, "Test/Speculative-%d.txt", mpObserver->SelfUnum());
+
+		std::ofstream out_file(file_name);
+		if (out_file.good()) {
+			out_file << "speculative decisions: " << mSpeculativeCount << std::endl;
+			out_file << "replanned: " << mReplanCount << std::endl;
+			out_file.close();
+		}
+		else {
+			PRINT_ERROR("open file error  " << file_name);
+		}
+	}
+
+	if (PlayerParam::instance().TimeTest()) {
+		char file_name[256];
+		sprintf(file_name, "Test/WorldModel-%d.txt", mpObserver->SelfUnum());
+
+		std::ofstream out_file(file_name);
+		if (out_file.good()) {
+			out_file << "world updates: " << mpWorldModel->GetUpdateCount() << std::endl;
+			out_file << "reverse world requested: " << mpWorldModel->GetReverseRequestCount() << std::endl;
+			out_file << "reverse world built: " << mpWorldModel->GetReverseBuildCount() << std::endl;
+			out_file.close();
+		}
+		else {
+			PRINT_ERROR("open file error  " << file_name);
+		}
+	}
 }
 
 /**
@@ -157,6 +193,132 @@ void Player::Run()
 {
     //TIMETEST("Run");  // 性能测试宏，可用于性能分析
 
+	if (IsSpeculativeDecision()) {
+		RunSpeculative();
+		return;
+	}
+
+	UpdateWorld();
+	Decide();
+
+	// 记录历史行为
+	// 保存当前周期的行为信息，供下一周期决策参考
+	mpAgent->SetHistoryActiveBehaviors();
+
+	// 记录视觉日志
+	// 保存当前周期的视觉信息，用于调试和分析
+	Logger::instance().LogSight();
+}
+
+/**
+ * @brief 推测决策
+ *
+ * sense 到来时就用预测的世界（EstimateToNow 之前的一周期预测）决策，然后等视觉。
+ * 视觉到来后从本周期更新前的世界重新更新；只有球或附近球员的位置与推测时相差较大时才重新决策，
+ * 否则直接发送已经算好的命令。
+ */
+void Player::RunSpeculative()
+{
+	UpdateWorld();
+	Decide();
+	++mSpeculativeCount;
+
+	mpObserver->WaitForNewSight();
+
+	if (mpObserver->IsNewSight()) {
+		const Time time = mpAgent->GetWorldState().CurrentTime();
+		TakeSpeculativeSnapshot();
+
+		mpObserver->Lock();
+		CommunicateSystem::instance().Update(); // 等视觉期间可能又收到了hear，要在更新世界前解析
+		mpWorldModel->ReUpdate(mpObserver);
+		mpObserver->UnLock();
+
+		mpAgent->World().SetCurrentTime(time); // 保持UpdateWorld()中对停止时间的修正
+		Formation::instance.UpdateOpponentRole();
+
+		if (IsWorldChangedBySight()) {
+			mpAgent->ResetForReplan(mpObserver);
+			Decide();
+			++mReplanCount;
+		}
+	}
+
+	mpAgent->SetHistoryActiveBehaviors();
+	Logger::instance().LogSight();
+}
+
+/**
+ * @brief 记下推测决策时的球和球员位置，不复制整个世界
+ */
+void Player::TakeSpeculativeSnapshot()
+{
+	const WorldState & world = mpAgent->GetWorldState();
+
+	mSpeculativeSnapshot.mBallPos = world.GetBall().GetPos();
+	mSpeculativeSnapshot.mBallVel = world.GetBall().GetVel();
+
+	for (Unum i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+		if (i == 0) continue;
+
+		const PlayerState & player = world.GetPlayer(i);
+		mSpeculativeSnapshot.mIsAlive[i + TEAMSIZE] = player.IsAlive();
+		mSpeculativeSnapshot.mPlayerPos[i + TEAMSIZE] = player.GetPos();
+	}
+}
+
+/**
+ * @brief 视觉更新后的世界与推测的世界相比，球或附近球员是否有较大变化
+ */
+bool Player::IsWorldChangedBySight() const
+{
+	const WorldState & world = mpAgent->GetWorldState();
+	const SpeculativeSnapshot & snapshot = mSpeculativeSnapshot;
+
+	if (world.GetBall().GetPos().Dist(snapshot.mBallPos) > PlayerParam::instance().SpeculativeBallBuffer() ||
+			world.GetBall().GetVel().Dist(snapshot.mBallVel) > PlayerParam::instance().SpeculativeBallBuffer()) {
+		return true;
+	}
+
+	const Vector & self_pos = mpAgent->GetSelf().GetPos();
+	const Vector & ball_pos = world.GetBall().GetPos();
+	const double range = PlayerParam::instance().SpeculativePlayerRange();
+
+	for (Unum i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+		if (i == 0) continue;
+
+		const PlayerState & player = world.GetPlayer(i);
+
+		if (player.IsAlive() != snapshot.mIsAlive[i + TEAMSIZE]) {
+			return true;
+		}
+
+		if (!player.IsAlive()) continue;
+
+		if (player.GetPos().Dist(self_pos) > range && player.GetPos().Dist(ball_pos) > range) continue;
+
+		if (player.GetPos().Dist(snapshot.mPlayerPos[i + TEAMSIZE]) > PlayerParam::instance().SpeculativePlayerBuffer()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Player::IsSpeculativeDecision() const
+{
+	return PlayerParam::instance().SpeculativeDecision() &&
+			!PlayerParam::instance().DynamicDebugMode() &&
+			!ServerParam::instance().synchMode();
+}
+
+/**
+ * @brief 更新世界模型
+ *
+ * 下面几个更新顺序不能变
+ */
+void Player::UpdateWorld()
+{
 	// 记录上次执行时间，用于时间同步和异常检测
 	static Time last_time = Time(-100, 0);
 
@@ -211,7 +373,13 @@ void Player::Run()
 	// TODO: 暂时放在这里，理想情况下应该由教练发送对手阵型信息
 	// 当教练未发来对手阵型信息时，自己先计算对手角色
 	Formation::instance.UpdateOpponentRole();
+}
 
+/**
+ * @brief 决策，行为、视觉和通信的命令都放入命令队列
+ */
+void Player::Decide()
+{
 	// === 决策阶段开始 ===
 	
 	// 重置视觉请求，为新的决策周期做准备
@@ -235,12 +403,4 @@ void Player::Run()
 	if (ServerParam::instance().synchMode()) {
 		mpAgent->Done();
 	}
-
-	// 记录历史行为
-	// 保存当前周期的行为信息，供下一周期决策参考
-	mpAgent->SetHistoryActiveBehaviors();
-
-	// 记录视觉日志
-	// 保存当前周期的视觉信息，用于调试和分析
-	Logger::instance().LogSight();
 }
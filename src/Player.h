@@ -47,14 +47,31 @@
 #define __Player_H__
 
 #include "Client.h"
+#include "Geometry.h"
+#include "Types.h"
 
 class DecisionTree;
 class  BeliefState;
+class WorldState;
 
 class Player: public Client
 {
+	/**
+	 * 推测决策时世界的快照，只保留视觉到来后要比较的球和球员位置
+	 */
+	struct SpeculativeSnapshot {
+		Vector mBallPos;
+		Vector mBallVel;
+		bool mIsAlive[TEAMSIZE * 2 + 1]; // 下标为 unum + TEAMSIZE
+		Vector mPlayerPos[TEAMSIZE * 2 + 1];
+	};
+
 	DecisionTree *mpDecisionTree;
 
+	SpeculativeSnapshot mSpeculativeSnapshot; // 推测决策时的世界，视觉到来后用来比较
+	int mSpeculativeCount;
+	int mReplanCount;
+
 public:
     /**
      * 构造函数和析构函数
@@ -64,6 +81,14 @@ public:
 
     void Run();
     void SendOptionToServer();
+    bool IsSpeculativeDecision() const;
+
+private:
+    void UpdateWorld();
+    void Decide();
+    void RunSpeculative();
+    void TakeSpeculativeSnapshot();
+    bool IsWorldChangedBySight() const;
 };
 
 #endif
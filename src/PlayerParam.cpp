@@ -75,6 +75,9 @@ const char PlayerParam::HETERO_TEST_MODEL[] = "./conf/hetero.conf";      // 异
 
 // === 训练相关常量 ===
 const char PlayerParam::TRAIN_DATA_FILE[] = "./train/train.conf";          // 训练数据文件
+const char PlayerParam::TABLE_CACHE_DIR[] = "data/cache";                  // 派生表缓存目录
+const char PlayerParam::SCHED_CPUS[] = "";                                 // 默认不绑定CPU
+const char PlayerParam::SCHED_LOGGER_CPUS[] = "";
 
 // === 球员类型配置常量 ===
 const int PlayerParam::DEFAULT_PLAYER_TYPES = 18;                         // 默认球员类型数（[12.0.0] 7 -> 18）
@@ -143,6 +146,41 @@ const bool PlayerParam::TIME_TEST = false;
 const bool PlayerParam::NETWORK_TEST = false;
 const int PlayerParam::WAIT_SIGHT_BUFFER = 40; // 每周期最多等视觉40毫秒
 const int PlayerParam::WAIT_HEAR_BUFFER = 40; // 每周期最多等听觉40毫秒
+const bool PlayerParam::ADAPTIVE_SIGHT_WAIT = false;
+const double PlayerParam::SIGHT_WAIT_PERCENTILE = 0.95;
+const int PlayerParam::SIGHT_WAIT_MARGIN = 5; // 在统计的到达时间之外多等5毫秒
+const bool PlayerParam::SPECULATIVE_DECISION = false;
+const double PlayerParam::SPECULATIVE_BALL_BUFFER = 0.3;
+const double PlayerParam::SPECULATIVE_PLAYER_BUFFER = 1.0;
+const double PlayerParam::SPECULATIVE_PLAYER_RANGE = 20.0;
+const bool PlayerParam::OPTIMAL_UNKNOWN_ASSIGNMENT = true;
+const int PlayerParam::LOCALIZATION_MAX_MARKERS = 10;
+const bool PlayerParam::SHOOT_SHADOW_MODEL = false;
+const bool PlayerParam::PASS_ROLLOUT = false;
+const int PlayerParam::PASS_ROLLOUT_SAMPLES = 32; // 每个传球候选最多模拟32次
+const int PlayerParam::PASS_ROLLOUT_THREADS = 2; // 包括决策线程自己
+const int PlayerParam::PASS_ROLLOUT_BUDGET = 5; // 每周期最多模拟5毫秒
+const int PlayerParam::DECISION_SEARCH_DEPTH = 1; // 默认只做单层选择
+const int PlayerParam::DECISION_SEARCH_WIDTH = 3;
+const int PlayerParam::DECISION_SEARCH_BUDGET = 10; // 每周期最多搜索10毫秒
+const bool PlayerParam::USE_TABLE_CACHE = true;
+const double PlayerParam::SIGHT_TABLE_STEP = 0.1; // data/eps0.1 对应的 quantize_step
+const double PlayerParam::MARK_TABLE_STEP = 0.01; // data/eps0.01 对应的 landmark_quantize_step
+const int PlayerParam::TABLE_CACHE_THREADS = 4; // 只在第一次启动时用到
+const bool PlayerParam::PARALLEL_STARTUP = true;
+const bool PlayerParam::TEAM_PROCESS = false;
+const int PlayerParam::TEAM_PROCESS_PLAYERS = 11;
+const bool PlayerParam::TEAM_PROCESS_COACH = true;
+const int PlayerParam::SCHED_CPUS_PER_PROCESS = 1;
+const bool PlayerParam::USE_SCHED_FIFO = false; // 需要 CAP_SYS_NICE 或 rtprio 限额
+const int PlayerParam::SCHED_FIFO_PRIORITY = 10;
+const int PlayerParam::SCHED_LOGGER_NICE = 10;
+const bool PlayerParam::STAND_IN_SERVER = false;
+const int PlayerParam::STAND_IN_PLAYERS = 22;
+const int PlayerParam::STAND_IN_KICK_OFF_WAIT = 30;
+const int PlayerParam::STAND_IN_THINK_TIMEOUT = 1000;
+const int PlayerParam::STAND_IN_SEED = 0;
+const bool PlayerParam::STAND_IN_GAME_LOG = true;
 const int PlayerParam::WAIT_TIME_OUT = 10; // 每场比赛最多等server10秒
 const double PlayerParam::ROUTE_ANGLE_DIFF = 1.0;
 const double PlayerParam::OPP_TACKLE_THRESHOLD_FORWARD = 0.69;
@@ -231,6 +269,33 @@ void HeteroParam::MaintainConsistency()
 		* ServerParam::instance().catchAreaLength() * catchable_area_l_stretch + ServerParam::instance().catchAreaWidth() * ServerParam::instance().catchAreaWidth() / 4 );
 }
 
+void PlayerTypeProfile::Build(const HeteroParam & hetero)
+{
+	mType = hetero.type();
+
+	mPlayerSpeedMax = hetero.playerSpeedMax();
+	mStaminaIncMax = hetero.staminaIncMax();
+	mPlayerDecay = hetero.playerDecay();
+	mInertiaMoment = hetero.inertiaMoment();
+	mDashPowerRate = hetero.dashPowerRate();
+	mPlayerSize = hetero.playerSize();
+	mKickableMargin = hetero.kickableMargin();
+	mKickRand = hetero.kickRand();
+	mKickPowerRate = hetero.kickPowerRate();
+	mExtraStamina = hetero.extraStamina();
+	mEffortMax = hetero.effortMax();
+	mEffortMin = hetero.effortMin();
+
+	mKickableArea = hetero.kickableArea();
+	mEffectiveSpeedMax = hetero.effectiveSpeedMax();
+	mMinCatchArea = hetero.minCatchArea();
+	mMaxCatchArea = hetero.maxCatchArea();
+
+	mMaxMoment = ServerParam::instance().maxMoment();
+	mKickDistOffset = mPlayerSize + ServerParam::instance().ballSize();
+	mKickMarginInverse = mKickableMargin > FLOAT_EPS? 1.0 / mKickableMargin: 0.0;
+}
+
 PlayerParam &PlayerParam::instance()
 {
 	static PlayerParam player_param;
@@ -240,6 +305,10 @@ PlayerParam &PlayerParam::instance()
 PlayerParam::PlayerParam()
 {
 	mHeteroPlayer = new HeteroParam[DEFAULT_PLAYER_TYPES];
+	mProfile = new PlayerTypeProfile[DEFAULT_PLAYER_TYPES];
+	for (int i = 0; i < DEFAULT_PLAYER_TYPES; ++i) {
+		mProfile[i].Build(mHeteroPlayer[i]);
+	}
 	AddParams();
 	MaintainConsistency();
 }
@@ -247,6 +316,7 @@ PlayerParam::PlayerParam()
 PlayerParam::~PlayerParam()
 {
 	delete[] mHeteroPlayer;
+	delete[] mProfile;
 }
 
 void PlayerParam::AddParams()
@@ -304,6 +374,42 @@ void PlayerParam::AddParams()
     AddParam( "network_test", & mNetworkTest, NETWORK_TEST );
 	AddParam( "wait_sight_buffer", & mWaitSightBuffer, WAIT_SIGHT_BUFFER );
     AddParam( "wait_hear_buffer", & mWaitHearBuffer, WAIT_HEAR_BUFFER );
+    AddParam( "adaptive_sight_wait", & mAdaptiveSightWait, ADAPTIVE_SIGHT_WAIT );
+    AddParam( "sight_wait_percentile", & mSightWaitPercentile, SIGHT_WAIT_PERCENTILE );
+    AddParam( "sight_wait_margin", & mSightWaitMargin, SIGHT_WAIT_MARGIN );
+    AddParam( "speculative_decision", & mSpeculativeDecision, SPECULATIVE_DECISION );
+    AddParam( "speculative_ball_buffer", & mSpeculativeBallBuffer, SPECULATIVE_BALL_BUFFER );
+    AddParam( "speculative_player_buffer", & mSpeculativePlayerBuffer, SPECULATIVE_PLAYER_BUFFER );
+    AddParam( "speculative_player_range", & mSpeculativePlayerRange, SPECULATIVE_PLAYER_RANGE );
+    AddParam( "optimal_unknown_assignment", & mOptimalUnknownAssignment, OPTIMAL_UNKNOWN_ASSIGNMENT );
+    AddParam( "localization_max_markers", & mLocalizationMaxMarkers, LOCALIZATION_MAX_MARKERS );
+    AddParam( "shoot_shadow_model", & mShootShadowModel, SHOOT_SHADOW_MODEL );
+    AddParam( "pass_rollout", & mPassRollout, PASS_ROLLOUT );
+    AddParam( "pass_rollout_samples", & mPassRolloutSamples, PASS_ROLLOUT_SAMPLES );
+    AddParam( "pass_rollout_threads", & mPassRolloutThreads, PASS_ROLLOUT_THREADS );
+    AddParam( "pass_rollout_budget", & mPassRolloutBudget, PASS_ROLLOUT_BUDGET );
+    AddParam( "decision_search_depth", & mDecisionSearchDepth, DECISION_SEARCH_DEPTH );
+    AddParam( "decision_search_width", & mDecisionSearchWidth, DECISION_SEARCH_WIDTH );
+    AddParam( "decision_search_budget", & mDecisionSearchBudget, DECISION_SEARCH_BUDGET );
+    AddParam( "use_table_cache", & mUseTableCache, USE_TABLE_CACHE );
+    AddParam( "table_cache_dir", & mTableCacheDir, std::string(TABLE_CACHE_DIR) );
+    AddParam( "table_cache_threads", & mTableCacheThreads, TABLE_CACHE_THREADS );
+    AddParam( "parallel_startup", & mParallelStartup, PARALLEL_STARTUP );
+    AddParam( "team_process", & mTeamProcess, TEAM_PROCESS );
+    AddParam( "team_process_players", & mTeamProcessPlayers, TEAM_PROCESS_PLAYERS );
+    AddParam( "team_process_coach", & mTeamProcessCoach, TEAM_PROCESS_COACH );
+    AddParam( "sched_cpus", & mSchedCpus, std::string(SCHED_CPUS) );
+    AddParam( "sched_cpus_per_process", & mSchedCpusPerProcess, SCHED_CPUS_PER_PROCESS );
+    AddParam( "sched_logger_cpus", & mSchedLoggerCpus, std::string(SCHED_LOGGER_CPUS) );
+    AddParam( "sched_fifo", & mSchedFifo, USE_SCHED_FIFO );
+    AddParam( "sched_fifo_priority", & mSchedFifoPriority, SCHED_FIFO_PRIORITY );
+    AddParam( "sched_logger_nice", & mSchedLoggerNice, SCHED_LOGGER_NICE );
+    AddParam( "stand_in_server", & mStandInServer, STAND_IN_SERVER );
+    AddParam( "stand_in_players", & mStandInPlayers, STAND_IN_PLAYERS );
+    AddParam( "stand_in_kick_off_wait", & mStandInKickOffWait, STAND_IN_KICK_OFF_WAIT );
+    AddParam( "stand_in_think_timeout", & mStandInThinkTimeout, STAND_IN_THINK_TIMEOUT );
+    AddParam( "stand_in_seed", & mStandInSeed, STAND_IN_SEED );
+    AddParam( "stand_in_game_log", & mStandInGameLog, STAND_IN_GAME_LOG );
 	AddParam( "wait_time_out", & mWaitTimeOut, WAIT_TIME_OUT );
 
     AddParam( "tired_buffer", & mTiredBuffer, TIRED_BUFFER );
@@ -392,6 +498,22 @@ void PlayerParam::init(int argc, char **argv)
 
 }
 
+bool PlayerParam::CheckSightTables() const
+{
+	bool ok = true;
+
+	if (fabs(ServerParam::instance().quantizeStep() - SIGHT_TABLE_STEP) > FLOAT_EPS) {
+		PRINT_ERROR("data/eps0.1 was built for quantize_step " << SIGHT_TABLE_STEP << ", server uses " << ServerParam::instance().quantizeStep());
+		ok = false;
+	}
+	if (fabs(ServerParam::instance().landmarkQuantizeStep() - MARK_TABLE_STEP) > FLOAT_EPS) {
+		PRINT_ERROR("data/eps0.01 was built for landmark_quantize_step " << MARK_TABLE_STEP << ", server uses " << ServerParam::instance().landmarkQuantizeStep());
+		ok = false;
+	}
+
+	return ok;
+}
+
 bool PlayerParam::SaveParam()
 {
 	std::cout << "Saving Player Param To Config File " << M_player_conf_file.c_str() << "..." << std::endl;
@@ -404,6 +526,7 @@ void PlayerParam::AddPlayerType(int type, const char *line)
 
 	mHeteroPlayer[type].ParseFromServerMsg(line);
 	mHeteroPlayer[type].MaintainConsistency();
+	mProfile[type].Build(mHeteroPlayer[type]);
 }
 
 void PlayerParam::MaintainConsistency()
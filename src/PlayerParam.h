@@ -145,6 +145,41 @@ public:
 	void MaintainConsistency();
 };
 
+/**
+ * 某一球员类型的能力档案：收到 (player_type ...) 后由 HeteroParam 一次性算好，之后只读。
+ * 热点路径（转身、踢球、Simulator 等）直接读这里的普通成员，不再经过 ParamEngine 对象
+ * 和重复的推导计算。
+ */
+struct PlayerTypeProfile
+{
+	int    mType;
+
+	double mPlayerSpeedMax;
+	double mStaminaIncMax;
+	double mPlayerDecay;
+	double mInertiaMoment;
+	double mDashPowerRate;
+	double mPlayerSize;
+	double mKickableMargin;
+	double mKickRand;
+	double mKickPowerRate;
+	double mExtraStamina;
+	double mEffortMax;
+	double mEffortMin;
+
+	double mKickableArea;
+	double mEffectiveSpeedMax;
+	double mMinCatchArea;
+	double mMaxCatchArea;
+
+	double mMaxMoment;          // ServerParam::maxMoment() 的拷贝
+	double mKickDistOffset;     // player_size + ball_size，算踢球距离时要减掉的部分
+	double mKickMarginInverse;  // 1 / kickable_margin
+
+public:
+	void Build(const HeteroParam & hetero);
+};
+
 class PlayerParam: public ParamEngine {
 	PlayerParam(); // private
 	PlayerParam( const PlayerParam & ); // not used
@@ -164,6 +199,9 @@ private:
 	static const char HETERO_TEST_MODEL[];
 	
 	static const char TRAIN_DATA_FILE[];
+	static const char TABLE_CACHE_DIR[];
+	static const char SCHED_CPUS[];
+	static const char SCHED_LOGGER_CPUS[];
 
 	static const int DEFAULT_PLAYER_TYPES;
 	static const int DEFAULT_SUBS_MAX;
@@ -304,6 +342,11 @@ private:
 
 	void AddParams();
 public:
+	/**
+	 * data/eps0.1 和 data/eps0.01 是按默认的 quantize_step 和 landmark_quantize_step 离线算好的，
+	 * 收到 server_param 后检查一下是否一致，不一致时打印错误
+	 */
+	bool CheckSightTables() const;
 
 
 	//sight dist 主要指视觉中ball player的dist ,其所加的误差加了0.1的截断
@@ -527,6 +570,8 @@ public:
     const double & kickPowerRateDeltaMin() const { return kick_power_rate_delta_min; }
     const double & kickPowerRateDeltaMax() const { return kick_power_rate_delta_max; }
     const double & foulDetectProbabilityDeltaFactor() const { return foul_detect_probability_delta_factor; }
+    const double & catchableAreaLStretchMin() const { return catchable_area_l_stretch_min; }
+    const double & catchableAreaLStretchMax() const { return catchable_area_l_stretch_max; }
 
 	const double & newDashPowerRateDeltaMin() const { return new_dash_power_rate_delta_min; }
 	const double & newDashPowerRateDeltaMax() const { return new_dash_power_rate_delta_max; }
@@ -552,6 +597,8 @@ public:
 	const int & ourGoalieUnum() const { return M_our_goalie_unum; } //这个量在决策层不应该使用，否则反算对手时会出错
 	const bool & isGoalie() const { return M_is_goalie; } //这个量在决策层不应该使用，否则反算对手时会出错
 	const bool & isCoach() const { return M_is_coach; }
+	void setIsGoalie(bool is_goalie) { M_is_goalie = is_goalie; }
+	void setIsCoach(bool is_coach) { M_is_coach = is_coach; }
 	
 	const bool & isTrainer() const { return M_is_trainer;}
 	
@@ -566,6 +613,7 @@ public:
 
 private:
 	HeteroParam *mHeteroPlayer;
+	PlayerTypeProfile *mProfile;
 
 public:
 	/**
@@ -582,6 +630,17 @@ public:
 		return mHeteroPlayer[type];
 	}
 
+	/**
+	 * 热点路径用：返回该类型预先算好的能力档案
+	 */
+	const PlayerTypeProfile & Profile(const int & type) const
+	{
+		Assert (type >= 0 && type < PlayerParam::instance().playerTypes());
+		Assert(type == 0 || Parser::IsPlayerTypesReady());
+
+		return mProfile[type];
+	}
+
 private:
 	static const bool DYNAMIC_DEBUG_MODE;
 	static const bool SAVE_SERVER_MESSAGE;
@@ -595,6 +654,41 @@ private:
 	static const bool NETWORK_TEST;
 	static const int WAIT_SIGHT_BUFFER;
 	static const int WAIT_HEAR_BUFFER;
+	static const bool ADAPTIVE_SIGHT_WAIT;
+	static const double SIGHT_WAIT_PERCENTILE;
+	static const int SIGHT_WAIT_MARGIN;
+	static const bool SPECULATIVE_DECISION;
+	static const double SPECULATIVE_BALL_BUFFER;
+	static const double SPECULATIVE_PLAYER_BUFFER;
+	static const double SPECULATIVE_PLAYER_RANGE;
+	static const bool OPTIMAL_UNKNOWN_ASSIGNMENT;
+	static const int LOCALIZATION_MAX_MARKERS;
+	static const bool SHOOT_SHADOW_MODEL;
+	static const bool PASS_ROLLOUT;
+	static const int PASS_ROLLOUT_SAMPLES;
+	static const int PASS_ROLLOUT_THREADS;
+	static const int PASS_ROLLOUT_BUDGET;
+	static const int DECISION_SEARCH_DEPTH;
+	static const int DECISION_SEARCH_WIDTH;
+	static const int DECISION_SEARCH_BUDGET;
+	static const bool USE_TABLE_CACHE;
+	static const double SIGHT_TABLE_STEP;
+	static const double MARK_TABLE_STEP;
+	static const int TABLE_CACHE_THREADS;
+	static const bool PARALLEL_STARTUP;
+	static const bool TEAM_PROCESS;
+	static const int TEAM_PROCESS_PLAYERS;
+	static const bool TEAM_PROCESS_COACH;
+	static const int SCHED_CPUS_PER_PROCESS;
+	static const bool USE_SCHED_FIFO;
+	static const int SCHED_FIFO_PRIORITY;
+	static const int SCHED_LOGGER_NICE;
+	static const bool STAND_IN_SERVER;
+	static const int STAND_IN_PLAYERS;
+	static const int STAND_IN_KICK_OFF_WAIT;
+	static const int STAND_IN_THINK_TIMEOUT;
+	static const int STAND_IN_SEED;
+	static const bool STAND_IN_GAME_LOG;
 	static const int WAIT_TIME_OUT;
 	static const double ROUTE_ANGLE_DIFF;
     static const double OPP_TACKLE_THRESHOLD_FORWARD;
@@ -630,6 +724,42 @@ private:
 	bool mNetworkTest;
 	int mWaitSightBuffer; // 等待视觉到来的最大buffer
 	int mWaitHearBuffer; // 等待听觉到来的最大buffer
+	bool mAdaptiveSightWait; // 是否根据统计的视觉到达时间决定等待时间
+	double mSightWaitPercentile; // 等到视觉到达时间分布的哪个分位数
+	int mSightWaitMargin; // 在分位数之外多等的毫秒数
+	bool mSpeculativeDecision; // 是否在sense到来时就推测决策
+	double mSpeculativeBallBuffer; // 视觉与推测的球位置相差超过此值时重新决策
+	double mSpeculativePlayerBuffer; // 视觉与推测的球员位置相差超过此值时重新决策
+	double mSpeculativePlayerRange; // 只考虑离自己或球这么近的球员
+	bool mOptimalUnknownAssignment; // 是否用最优匹配识别未知号码的球员，否则用贪心匹配
+	int mLocalizationMaxMarkers; // 自定位最多融合最近的几个标志，0表示只用最近的标志
+	bool mShootShadowModel; // 射门角度是否按对手能封住的角度区间求，否则按原来的方向空隙求
+	bool mPassRollout; // 是否用带噪声的模拟评估传球
+	int mPassRolloutSamples; // 每个传球候选的模拟次数
+	int mPassRolloutThreads; // 模拟用的线程数，包括决策线程自己
+	int mPassRolloutBudget; // 每周期模拟的最大毫秒数
+	int mDecisionSearchDepth; // 决策树搜索的层数，1表示只做单层选择
+	int mDecisionSearchWidth; // 每层展开评价最高的几个行为
+	int mDecisionSearchBudget; // 每周期搜索的最大毫秒数
+	bool mUseTableCache; // 是否把Kicker表等派生表缓存到磁盘，按参数哈希复用
+	std::string mTableCacheDir; // 派生表缓存目录
+	int mTableCacheThreads; // 缓存未命中时生成表的线程数
+	bool mParallelStartup; // 是否在连接server的同时并行构造各个表和模型
+	bool mTeamProcess; // 是否由一个进程加载只读状态后fork出整队
+	int mTeamProcessPlayers; // team_process时启动的球员数，第一个是守门员
+	bool mTeamProcessCoach; // team_process时是否启动教练
+	std::string mSchedCpus; // 整队可用的CPU列表，如 0-7,9，为空时不绑定
+	int mSchedCpusPerProcess; // 每个进程分到的CPU数
+	std::string mSchedLoggerCpus; // Logger线程单独使用的CPU列表，为空时和本进程其他线程一样
+	bool mSchedFifo; // Parser和决策线程是否用SCHED_FIFO
+	int mSchedFifoPriority; // 决策线程的实时优先级，Parser高一级
+	int mSchedLoggerNice; // Logger线程的nice值
+	bool mStandInServer; // 本进程是否作为替身server运行，而不是球员
+	int mStandInPlayers; // 替身server等到这么多球员连上后开球
+	int mStandInKickOffWait; // 开球前和中场休息的停顿周期数，按sim_step实时推进
+	int mStandInThinkTimeout; // 同步模式下等所有球员(done)的最长时间，毫秒
+	int mStandInSeed; // 替身server的随机种子，0表示按时间取
+	bool mStandInGameLog; // 替身server是否在rcg里逐周期写show；比赛模式和比分总会写，farm.sh 靠文件名读比分
 	int mWaitTimeOut; // 等待server的最大时间
 
     double mTiredBuffer;
@@ -667,6 +797,42 @@ public:
     const bool & UseTeamGraphic() const { return mUseTeamGraphic; }
 	const int & WaitSightBuffer() const { return mWaitSightBuffer; }
 	const int & WaitHearBuffer() const { return mWaitHearBuffer; }
+	const bool & AdaptiveSightWait() const { return mAdaptiveSightWait; }
+	const double & SightWaitPercentile() const { return mSightWaitPercentile; }
+	const int & SightWaitMargin() const { return mSightWaitMargin; }
+	const bool & SpeculativeDecision() const { return mSpeculativeDecision; }
+	const double & SpeculativeBallBuffer() const { return mSpeculativeBallBuffer; }
+	const double & SpeculativePlayerBuffer() const { return mSpeculativePlayerBuffer; }
+	const double & SpeculativePlayerRange() const { return mSpeculativePlayerRange; }
+	const bool & OptimalUnknownAssignment() const { return mOptimalUnknownAssignment; }
+	const int & LocalizationMaxMarkers() const { return mLocalizationMaxMarkers; }
+	const bool & ShootShadowModel() const { return mShootShadowModel; }
+	const bool & PassRollout() const { return mPassRollout; }
+	const int & PassRolloutSamples() const { return mPassRolloutSamples; }
+	const int & PassRolloutThreads() const { return mPassRolloutThreads; }
+	const int & PassRolloutBudget() const { return mPassRolloutBudget; }
+	const int & DecisionSearchDepth() const { return mDecisionSearchDepth; }
+	const int & DecisionSearchWidth() const { return mDecisionSearchWidth; }
+	const int & DecisionSearchBudget() const { return mDecisionSearchBudget; }
+	const bool & UseTableCache() const { return mUseTableCache; }
+	const std::string & TableCacheDir() const { return mTableCacheDir; }
+	const int & TableCacheThreads() const { return mTableCacheThreads; }
+	const bool & ParallelStartup() const { return mParallelStartup; }
+	const bool & TeamProcess() const { return mTeamProcess; }
+	const int & TeamProcessPlayers() const { return mTeamProcessPlayers; }
+	const bool & TeamProcessCoach() const { return mTeamProcessCoach; }
+	const std::string & SchedCpus() const { return mSchedCpus; }
+	const int & SchedCpusPerProcess() const { return mSchedCpusPerProcess; }
+	const std::string & SchedLoggerCpus() const { return mSchedLoggerCpus; }
+	const bool & SchedFifo() const { return mSchedFifo; }
+	const int & SchedFifoPriority() const { return mSchedFifoPriority; }
+	const int & SchedLoggerNice() const { return mSchedLoggerNice; }
+	const bool & StandInServer() const { return mStandInServer; }
+	const int & StandInPlayers() const { return mStandInPlayers; }
+	const int & StandInKickOffWait() const { return mStandInKickOffWait; }
+	const int & StandInThinkTimeout() const { return mStandInThinkTimeout; }
+	const int & StandInSeed() const { return mStandInSeed; }
+	const bool & StandInGameLog() const { return mStandInGameLog; }
 	const int & WaitTimeOut() const { return mWaitTimeOut; }
 
 	const double & minAppearancePoss() const { return M_min_appearance_poss; }
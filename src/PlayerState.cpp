@@ -95,6 +95,8 @@ PlayerState::PlayerState():
 
 	mCardType = CR_None;
 	mIsBodyDirMayChanged = true;
+
+	UpdatePosCovariance(1.0e8, 0.0, 1.0e8);
 }
 
 /**
@@ -128,6 +130,7 @@ void PlayerState::GetReverseFrom(const PlayerState & o)
 
 	UpdateIsGoalie(o.IsGoalie());
 	UpdateIsSensed(o.IsSensed());
+	mPosCovariance = o.mPosCovariance; // 旋转180度协方差不变
 
 	UpdatePlayerType(o.GetPlayerType());
 	UpdateViewWidth(o.GetViewWidth());
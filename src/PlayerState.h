@@ -468,24 +468,36 @@ public:
 private:
     bool        mIsSensed; // 为true表示是可以收到sense信息的球员，即“真正”的自己
 
+public:
+    /**
+     * 位置的协方差 {xx, xy, yy}，目前只对自己有效：由视觉定位给出，EstimateSelf 中随运动误差增大
+     * Position covariance {xx, xy, yy}, only maintained for self.
+     */
+    const Array<double, 3> & GetPosCovariance() const { return mPosCovariance; }
+    void UpdatePosCovariance(double xx, double xy, double yy) { mPosCovariance[0] = xx; mPosCovariance[1] = xy; mPosCovariance[2] = yy; }
+    void InflatePosCovariance(double var) { mPosCovariance[0] += var; mPosCovariance[2] += var; }
+
+private:
+    Array<double, 3> mPosCovariance;
+
 public:
 	/** some useful interfaces */
-	const double & GetPlayerSpeedMax() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).playerSpeedMax(); }
-	const double & GetStaminaIncMax() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).staminaIncMax(); }
-	const double & GetPlayerDecay() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).playerDecay(); }
-	const double & GetInertiaMoment() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).inertiaMoment(); }
-	const double & GetDashPowerRate() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).dashPowerRate(); }
-	const double & GetPlayerSize() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).playerSize(); }
-	const double & GetKickableMargin() const {return PlayerParam::instance().HeteroPlayer(mPlayerType).kickableMargin(); }
-	const double & GetKickRand() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).kickRand(); }
-	const double & GetKickPowerRate() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).kickPowerRate(); }
-	const double & GetExtraStamina() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).extraStamina(); }
-	const double & GetEffortMax() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).effortMax(); }
-	const double & GetEffortMin() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).effortMin(); }
-	virtual const double & GetKickableArea() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).kickableArea(); }
+	const double & GetPlayerSpeedMax() const { return PlayerParam::instance().Profile(mPlayerType).mPlayerSpeedMax; }
+	const double & GetStaminaIncMax() const { return PlayerParam::instance().Profile(mPlayerType).mStaminaIncMax; }
+	const double & GetPlayerDecay() const { return PlayerParam::instance().Profile(mPlayerType).mPlayerDecay; }
+	const double & GetInertiaMoment() const { return PlayerParam::instance().Profile(mPlayerType).mInertiaMoment; }
+	const double & GetDashPowerRate() const { return PlayerParam::instance().Profile(mPlayerType).mDashPowerRate; }
+	const double & GetPlayerSize() const { return PlayerParam::instance().Profile(mPlayerType).mPlayerSize; }
+	const double & GetKickableMargin() const {return PlayerParam::instance().Profile(mPlayerType).mKickableMargin; }
+	const double & GetKickRand() const { return PlayerParam::instance().Profile(mPlayerType).mKickRand; }
+	const double & GetKickPowerRate() const { return PlayerParam::instance().Profile(mPlayerType).mKickPowerRate; }
+	const double & GetExtraStamina() const { return PlayerParam::instance().Profile(mPlayerType).mExtraStamina; }
+	const double & GetEffortMax() const { return PlayerParam::instance().Profile(mPlayerType).mEffortMax; }
+	const double & GetEffortMin() const { return PlayerParam::instance().Profile(mPlayerType).mEffortMin; }
+	virtual const double & GetKickableArea() const { return PlayerParam::instance().Profile(mPlayerType).mKickableArea; }
 	const double & GetCatchAreaLStretch() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).catchableAreaLStretch(); }
-	const double & GetMinCatchArea() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).minCatchArea(); }
-	const double & GetMaxCatchArea() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).maxCatchArea(); }
+	const double & GetMinCatchArea() const { return PlayerParam::instance().Profile(mPlayerType).mMinCatchArea; }
+	const double & GetMaxCatchArea() const { return PlayerParam::instance().Profile(mPlayerType).mMaxCatchArea; }
 	const double & GetFoulDetectProbability() const { return PlayerParam::instance().HeteroPlayer(mPlayerType).foulDetectProbability(); }
 
 	double GetAccelerationRateOnDir(const double dir) const { return PlayerParam::instance().HeteroPlayer(mPlayerType).accelerationRateOnDir(dir); }
@@ -63,11 +63,14 @@
 #include "PositionInfo.h"
 #include "WorldState.h"
 #include "Utilities.h"
+#include "PlayerParam.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 using namespace std;
 
+const double PositionInfo::SHOOT_SHADOW_MAX_RATE = 0.5;
+
 /**
  * @brief PositionInfo 构造函数
  * 
@@ -82,52 +85,64 @@ using namespace std;
  */
 PositionInfo::PositionInfo(WorldState *pWorldState, InfoState *pInfoState):
 	InfoStateBase(pWorldState, pInfoState),
-	mPlayerWithBallList_UpdateTime(Time(-3, 0))  // 初始化为过期时间
+	mDistMatrixCache(IC_DistMatrix),
+	mOffsideLineCache(IC_OffsideLine),
+	mOppGoalInfoCache(IC_OppGoalInfo),
+	mXSortTeammateCache(IC_XSortTeammate),
+	mXSortOpponentCache(IC_XSortOpponent),
+	mCloseToBallCache(IC_CloseToBall),
+	mCloseToPlayerCache(1 + 2 * TEAMSIZE, InfoCache(IC_CloseToPlayer)),
+	mPlayerWithBallCache(IC_PlayerWithBall)
 {
+	mPlayerWithBallCache.DependOn(mCloseToBallCache);
 }
 
 /**
  * @brief 更新位置信息例程
- * 
- * 这是位置信息系统的主更新函数，负责：
- * 1. 更新距离矩阵
- * 2. 更新越位线
- * 3. 更新对方球门信息
- * 4. 清理各种列表
- * 
- * 更新流程：
- * 1. 计算所有球员之间的距离矩阵
- * 2. 计算越位线位置
- * 3. 分析对方球门防守情况
- * 4. 清理各种排序列表
- * 
- * @note 每个周期都会调用此函数
- * @note 会清理所有排序列表以重新计算
- * @note 确保位置信息的实时性
+ *
+ * 位置信息都改为首次用到时才计算（见InfoCache），每周期不再无条件计算距离矩阵、越位线等，
+ * 各个缓存根据周期和世界版本自己判断是否过期，这里不需要做任何事。
  */
 void PositionInfo::UpdateRoutine()
 {
-	// === 核心位置信息更新 ===
-	UpdateDistMatrix();     // 更新距离矩阵
-	UpdateOffsideLine();     // 更新越位线
-    UpdateOppGoalInfo();    // 更新对方球门信息
+}
 
-	// === 清理排序列表 ===
-	/** 每个周期clear一次 */
-	mPlayer2BallList.clear();        // 清理球员到球距离列表
-	mTeammate2BallList.clear();      // 清理队友到球距离列表
-	mOpponent2BallList.clear();      // 清理对手到球距离列表
+void PositionInfo::Invalidate()
+{
+	mDistMatrixCache.Invalidate();
+	mOffsideLineCache.Invalidate();
+	mOppGoalInfoCache.Invalidate();
+	mXSortTeammateCache.Invalidate();
+	mXSortOpponentCache.Invalidate();
+	mCloseToBallCache.Invalidate();
+	for (unsigned i = 0; i < mCloseToPlayerCache.size(); ++i) {
+		mCloseToPlayerCache[i].Invalidate();
+	}
+	mPlayerWithBallCache.Invalidate();
+}
 
-	// === 清理球员间距离列表 ===
-	for (int i = 0; i < 1 + 2 * TEAMSIZE; ++i) {
-		mPlayer2PlayerList[i].clear();   // 清理球员间距离列表
-		mTeammate2PlayerList[i].clear(); // 清理队友间距离列表
-		mOpponent2PlayerList[i].clear(); // 清理对手间距离列表
+void PositionInfo::VerifyDistMatrix() const
+{
+	InfoCompute compute(const_cast<InfoCache &>(mDistMatrixCache), mpWorldState->CurrentTime());
+	if (!compute.IsHit()) {
+		const_cast<PositionInfo *>(this)->UpdateDistMatrix();
 	}
+}
+
+void PositionInfo::VerifyOffsideLine() const
+{
+	InfoCompute compute(const_cast<InfoCache &>(mOffsideLineCache), mpWorldState->CurrentTime());
+	if (!compute.IsHit()) {
+		const_cast<PositionInfo *>(this)->UpdateOffsideLine();
+	}
+}
 
-	// === 清理位置排序列表 ===
-	mXSortTeammateList.clear();   // 清理X坐标排序的队友列表
-	mXSortOpponentList.clear();   // 清理X坐标排序的对手列表
+void PositionInfo::VerifyOppGoalInfo() const
+{
+	InfoCompute compute(const_cast<InfoCache &>(mOppGoalInfoCache), mpWorldState->CurrentTime());
+	if (!compute.IsHit()) {
+		const_cast<PositionInfo *>(this)->UpdateOppGoalInfo();
+	}
 }
 
 /**
@@ -216,11 +231,13 @@ void PositionInfo::UpdateDistMatrix()
 
 const double & PositionInfo::GetBallDistToPlayer(Unum unum) const
 {
+	VerifyDistMatrix();
 	return mDistMatrix[0][Unum2Index(unum)];
 }
 
 const double & PositionInfo::GetPlayerDistToPlayer(Unum unum1, Unum unum2) const
 {
+	VerifyDistMatrix();
 	return mDistMatrix[Unum2Index(unum1)][Unum2Index(unum2)];
 }
 
@@ -355,8 +372,10 @@ void PositionInfo::UpdateOppGoalInfo()
 
 const list<KeyPlayerInfo> & PositionInfo::GetXSortTeammate()
 {
-    if (mXSortTeammateList.empty())
+    InfoCompute compute(mXSortTeammateCache, mpWorldState->CurrentTime());
+    if (!compute.IsHit())
     {
+        mXSortTeammateList.clear();
 		KeyPlayerInfo kp;
 		for (int i=1; i<=TEAMSIZE; i++)
         {
@@ -376,8 +395,10 @@ const list<KeyPlayerInfo> & PositionInfo::GetXSortTeammate()
 
 const list<KeyPlayerInfo> & PositionInfo::GetXSortOpponent()
 {
-    if (mXSortOpponentList.empty())
+    InfoCompute compute(mXSortOpponentCache, mpWorldState->CurrentTime());
+    if (!compute.IsHit())
     {
+        mXSortOpponentList.clear();
 		KeyPlayerInfo kp;
 		for (int i=1; i<=TEAMSIZE; i++)
         {
@@ -394,49 +415,234 @@ const list<KeyPlayerInfo> & PositionInfo::GetXSortOpponent()
     return mXSortOpponentList;
 }
 
-AngleDeg PositionInfo::GetShootAngle(AngleDeg left,AngleDeg right, const PlayerState & state , AngleDeg & interval)
+void PositionInfo::GetShootIntervals(AngleDeg left, AngleDeg right, const PlayerState & state, vector<AngleInterval> & intervals) const
 {
-	vector< pair<Unum, AngleDeg> > tmp;
+	const AngleDeg span = GetNormalizeAngleDeg(right - left, 0.0);
+	const double ball_speed = ServerParam::instance().ballSpeedMax();
+	const double goal_cycle = ServerParam::instance().GetBallCycle(ball_speed, state.GetPos().Dist(ServerParam::instance().oppGoal()));
+	const AngleDeg max_half = span * SHOOT_SHADOW_MAX_RATE * 0.5;
+
+	vector<AngleInterval> shadows;
+	shadows.reserve(mpWorldState->GetPlayerList().size());
+
 	for (vector<PlayerState*>::const_iterator it = mpWorldState->GetPlayerList().begin(); it != mpWorldState->GetPlayerList().end(); ++it){
-    if ((*it)->IsAlive() && (*it)->GetPosConf() > FLOAT_EPS && (*it)->GetUnum() != state.GetUnum() &&((*it)->GetPos()-state.GetPos()).Dir() + Rad2Deg(1/10) >left&&((*it)->GetPos()-state.GetPos()).Dir() - Rad2Deg(1/10) <right){//介于左右门柱之间
-		tmp.push_back(pair<Unum, AngleDeg>((*it)->GetUnum(), ((*it)->GetPos()-state.GetPos()).Dir()));
-	}
-	}
-	if(tmp.size()!=0){
-		sort(tmp.begin(),tmp.end(),PlayerDirCompare());
-			vector<pair<int,AngleDeg> > dis;
-			int i=0;
-	vector<pair<int,AngleDeg> >::const_iterator it;
-	for(it = tmp.begin(); it != tmp.end();++it){
-			if(i==0){
-				dis.push_back(pair<int,AngleDeg>(i++,((*it).second-left/* - Rad2Deg(1/10) - Rad2Deg(1/3)*/)));
-				}
-			else{
-				dis.push_back(pair<int,AngleDeg>(i++,((*it).second-(*(it-1)).second)/*- 2*Rad2Deg(1/10) - Rad2Deg(1/3)*/));
-			}
-			}
-				dis.push_back(pair<int,AngleDeg>(i,(right-(*(it-1)).second)/*- Rad2Deg(1/10) - Rad2Deg(1/3)*/));
-		sort(dis.begin(),dis.end(),PlayerDirCompare());
+		const PlayerState & player = **it;
+		if (!player.IsAlive() || player.GetPosConf() < FLOAT_EPS || player.GetUnum() == state.GetUnum()) continue;
+
+		const Vector rel_pos = player.GetPos() - state.GetPos();
+		const double dist = rel_pos.Mod();
+		if (dist < FLOAT_EPS) continue;
 
-		if(dis.back().first==0){
-			interval = dis.back().second-Rad2Deg(1.0/10.0)-Rad2Deg(1.0/4.0);
-			return MinMax(left + 1,dis.back().second/2+left-Rad2Deg(1.0/10.0)-Rad2Deg(1.0/4.0),right -1 );
+		double reach = player.GetPlayerSize();
+		if (player.GetUnum() < 0) {
+			const double dist_cycle = ServerParam::instance().GetBallCycle(ball_speed, dist);
+			if (dist_cycle >= 1000.0) continue; //球到不了这么远，不会被其封住
+
+			const double cycle = Min(dist_cycle, goal_cycle); //球过了门线就不用再拦
+			const double run_cycle = Max(cycle - 1.0 - GetShadowTurnCycle(player, rel_pos.Dir()), 0.0); //留一个周期反应
+			reach = (player.IsGoalie()? player.GetMaxCatchArea(): player.GetKickableArea()) + player.GetEffectiveSpeedMax() * run_cycle;
 		}
-		else if(dis.back().first == i){
-			interval = dis.back().second-Rad2Deg(1.0/10.0)-Rad2Deg(1.0/4.0);
-			return MinMax(left + 1,right -dis.back().second/2+Rad2Deg(1.0/10.0)+Rad2Deg(1.0/4.0),right -1);
+
+		const AngleDeg half = Min((reach < dist)? ASin(reach / dist): 90.0, max_half); //一个人不能封住整个球门
+		const AngleDeg offset = GetNormalizeAngleDeg(rel_pos.Dir() - left);
+		const AngleDeg begin = Max(offset - half, 0.0);
+		const AngleDeg end = Min(offset + half, span);
+		if (begin < end) {
+			shadows.push_back(AngleInterval(begin, end));
 		}
-		else{
-			interval = dis.back().second  - 2* Rad2Deg(1.0/10.0) - Rad2Deg(1.0/4.0);
-			return MinMax(left +1,(*(tmp.begin()+dis.back().first-1)).second + dis.back().second/2 ,right -1);
+	}
+
+	SweepFreeIntervals(shadows, span, intervals);
+
+	for (vector<AngleInterval>::iterator it = intervals.begin(); it != intervals.end(); ++it) {
+		it->first += left;
+		it->second += left;
+	}
+}
+
+/**
+ * 对手要横向跑到射门线上，先得把身体转到与其方向垂直（可以向后跑）；身体方向不可信时按转一次算
+ */
+double PositionInfo::GetShadowTurnCycle(const PlayerState & player, AngleDeg dir)
+{
+	if (!player.IsBodyDirValid()) {
+		return 1.0;
+	}
+
+	const AngleDeg off = fabs(90.0 - fabs(GetNormalizeAngleDeg(player.GetBodyDir() - dir))); //与垂直方向的夹角，[0, 90]
+	if (off < ServerParam::instance().dashAngleStep() + FLOAT_EPS) {
+		return 0.0;
+	}
+
+	const AngleDeg max_turn = player.GetMaxTurnAngle();
+	return (max_turn > FLOAT_EPS)? ceil(off / max_turn): 1.0;
+}
+
+void PositionInfo::SweepFreeIntervals(vector<AngleInterval> & shadows, AngleDeg span, vector<AngleInterval> & intervals)
+{
+	intervals.clear();
+	sort(shadows.begin(), shadows.end()); //按起点排序
+
+	AngleDeg covered = 0.0; //[0, covered]已被遮挡或已输出
+	for (vector<AngleInterval>::const_iterator it = shadows.begin(); it != shadows.end(); ++it) {
+		if (it->first > covered + FLOAT_EPS) {
+			intervals.push_back(AngleInterval(covered, it->first));
+		}
+		covered = Max(covered, it->second);
+	}
+	if (span > covered + FLOAT_EPS) {
+		intervals.push_back(AngleInterval(covered, span));
+	}
+}
+
+AngleDeg PositionInfo::GetShootAngle(AngleDeg left,AngleDeg right, const PlayerState & state , AngleDeg & interval)
+{
+#ifdef __SHOOT_ANGLE_TEST
+	static bool benchmarked = false;
+	if (!benchmarked) {
+		benchmarked = true;
+		BenchmarkShootAngle();
+	}
+#endif
+
+	if (!PlayerParam::instance().ShootShadowModel()) {
+		vector<AngleDeg> dirs;
+		for (vector<PlayerState*>::const_iterator it = mpWorldState->GetPlayerList().begin(); it != mpWorldState->GetPlayerList().end(); ++it) {
+			const AngleDeg dir = ((*it)->GetPos() - state.GetPos()).Dir();
+			if ((*it)->IsAlive() && (*it)->GetPosConf() > FLOAT_EPS && (*it)->GetUnum() != state.GetUnum() && dir > left && dir < right) { //介于左右门柱之间
+				dirs.push_back(dir);
+			}
+		}
+		return GetShootAngleByDirs(left, right, dirs, interval);
+	}
+
+	GetShootIntervals(left, right, state, mShootIntervals);
+
+	const AngleDeg span = GetNormalizeAngleDeg(right - left, 0.0);
+	if (mShootIntervals.empty()) {
+		interval = 0.0;
+		return left + span / 2;
+	}
+
+	vector<AngleInterval>::const_iterator widest = mShootIntervals.begin();
+	for (vector<AngleInterval>::const_iterator it = widest + 1; it != mShootIntervals.end(); ++it) {
+		if (it->second - it->first > widest->second - widest->first) {
+			widest = it;
 		}
 	}
+
+	interval = widest->second - widest->first;
+	return MinMax(left + 1, (widest->first + widest->second) / 2, left + span - 1);
+}
+
+/**
+ * 原来的算法：把介于左右门柱之间的球员方向排序，取相邻方向之间最大的空隙，减去固定的余量
+ */
+AngleDeg PositionInfo::GetShootAngleByDirs(AngleDeg left, AngleDeg right, vector<AngleDeg> dirs, AngleDeg & interval)
+{
+	if (dirs.empty()) {
+		interval = right - left;
+		return (left + right) / 2;
+	}
+
+	sort(dirs.begin(), dirs.end());
+
+	vector<pair<int, AngleDeg> > dis;
+	dis.push_back(pair<int, AngleDeg>(0, dirs.front() - left));
+	for (unsigned int i = 1; i < dirs.size(); ++i) {
+		dis.push_back(pair<int, AngleDeg>(i, dirs[i] - dirs[i - 1]));
+	}
+	dis.push_back(pair<int, AngleDeg>(dirs.size(), right - dirs.back()));
+	sort(dis.begin(), dis.end(), PlayerDirCompare());
+
+	if (dis.back().first == 0) {
+		interval = dis.back().second - Rad2Deg(1.0/10.0) - Rad2Deg(1.0/4.0);
+		return MinMax(left + 1, dis.back().second / 2 + left - Rad2Deg(1.0/10.0) - Rad2Deg(1.0/4.0), right - 1);
+	}
+	else if (dis.back().first == int(dirs.size())) {
+		interval = dis.back().second - Rad2Deg(1.0/10.0) - Rad2Deg(1.0/4.0);
+		return MinMax(left + 1, right - dis.back().second / 2 + Rad2Deg(1.0/10.0) + Rad2Deg(1.0/4.0), right - 1);
+	}
 	else {
-		interval = right-left  ;
-		return (left+right)/2;
+		interval = dis.back().second - 2 * Rad2Deg(1.0/10.0) - Rad2Deg(1.0/4.0);
+		return MinMax(left + 1, dirs[dis.back().first - 1] + dis.back().second / 2, right - 1);
 	}
 }
 
+#ifdef __SHOOT_ANGLE_TEST
+/**
+ * 随机生成门前的球员方向，原算法和扫描线用同样的输入（扫描线把每个方向当作宽度近似为0的遮挡），
+ * 比较耗时，并统计两者选出的方向是否落在同一个空隙里
+ */
+void PositionInfo::BenchmarkShootAngle()
+{
+	const int case_count = 10000;
+	const AngleDeg left = -20.0;
+	const AngleDeg right = 20.0;
+
+	vector<vector<AngleDeg> > case_dirs(case_count);
+	for (int i = 0; i < case_count; ++i) {
+		const int n = int(drand(0.0, 2 * TEAMSIZE));
+		for (int j = 0; j < n; ++j) {
+			const AngleDeg dir = drand(left - 10.0, right + 10.0);
+			if (dir > left && dir < right) { //与GetShootAngle中原算法的筛选相同
+				case_dirs[i].push_back(dir);
+			}
+		}
+	}
+
+	vector<AngleDeg> old_result(case_count);
+	RealTime begin = GetRealTime();
+	for (int i = 0; i < case_count; ++i) {
+		AngleDeg interval;
+		old_result[i] = GetShootAngleByDirs(left, right, case_dirs[i], interval);
+	}
+	RealTime end = GetRealTime();
+	const long old_cost = end.Sub(begin);
+
+	vector<AngleDeg> new_result(case_count);
+	vector<AngleInterval> shadows;
+	vector<AngleInterval> intervals;
+	int agree = 0;
+	begin = GetRealTime();
+	for (int i = 0; i < case_count; ++i) {
+		shadows.clear();
+		for (unsigned int j = 0; j < case_dirs[i].size(); ++j) {
+			const AngleDeg b = Max(case_dirs[i][j] - FLOAT_EPS - left, 0.0);
+			const AngleDeg e = Min(case_dirs[i][j] + FLOAT_EPS - left, right - left);
+			if (b < e) {
+				shadows.push_back(AngleInterval(b, e));
+			}
+		}
+		SweepFreeIntervals(shadows, right - left, intervals);
+
+		new_result[i] = (left + right) / 2;
+		AngleDeg width = -1.0;
+		for (unsigned int k = 0; k < intervals.size(); ++k) {
+			if (intervals[k].second - intervals[k].first > width) {
+				width = intervals[k].second - intervals[k].first;
+				new_result[i] = left + (intervals[k].first + intervals[k].second) / 2;
+			}
+		}
+	}
+	end = GetRealTime();
+	const long new_cost = end.Sub(begin);
+
+	for (int i = 0; i < case_count; ++i) {
+		bool same_gap = true;
+		for (unsigned int j = 0; j < case_dirs[i].size(); ++j) {
+			if ((case_dirs[i][j] - old_result[i]) * (case_dirs[i][j] - new_result[i]) < 0.0) {
+				same_gap = false;
+				break;
+			}
+		}
+		if (same_gap) ++agree;
+	}
+
+	std::cout << "shoot angle benchmark: " << case_count << " cases, sort " << old_cost << "us, sweep " << new_cost
+			<< "us, same gap " << agree << "/" << case_count << std::endl;
+}
+#endif
 
 //到某个点距离的按大小排列队员（F）
 vector<Unum> PositionInfo::GetClosePlayerToPoint(const Vector & bp, const Unum & exclude_unum) const
@@ -461,35 +667,33 @@ vector<Unum> PositionInfo::GetClosePlayerToPoint(const Vector & bp, const Unum &
 
 const vector<Unum> & PositionInfo::GetClosePlayerToBall()
 {
-	if (mPlayer2BallList.empty()){
+	InfoCompute compute(mCloseToBallCache, mpWorldState->CurrentTime());
+	if (!compute.IsHit()){
 		mPlayer2BallList = GetClosePlayerToPoint(mpWorldState->GetBall().GetPos());
-	}
-	return mPlayer2BallList;
-}
 
-const vector<Unum> & PositionInfo::GetCloseTeammateToBall()
-{
-	if (mTeammate2BallList.empty()){
-		const vector<Unum> & player2ball = GetClosePlayerToBall();
-		for (vector<Unum>::const_iterator it = player2ball.begin(); it != player2ball.end(); ++it){
+		mTeammate2BallList.clear();
+		mOpponent2BallList.clear();
+		for (vector<Unum>::const_iterator it = mPlayer2BallList.begin(); it != mPlayer2BallList.end(); ++it){
 			if ((*it) > 0){
 				mTeammate2BallList.push_back(*it);
 			}
+			else {
+				mOpponent2BallList.push_back(-(*it));
+			}
 		}
 	}
+	return mPlayer2BallList;
+}
+
+const vector<Unum> & PositionInfo::GetCloseTeammateToBall()
+{
+	GetClosePlayerToBall();
 	return mTeammate2BallList;
 }
 
 const vector<Unum> & PositionInfo::GetCloseOpponentToBall()
 {
-	if (mOpponent2BallList.empty()){
-		const vector<Unum> & player2ball = GetClosePlayerToBall();
-		for (vector<Unum>::const_iterator it = player2ball.begin(); it != player2ball.end(); ++it){
-			if ((*it) < 0){
-				mOpponent2BallList.push_back(-(*it));
-			}
-		}
-	}
+	GetClosePlayerToBall();
 	return mOpponent2BallList;
 }
 
@@ -509,54 +713,49 @@ vector<Unum>  PositionInfo::GetCloseOpponentToPoint(const Vector& bp )
 const vector<Unum> & PositionInfo::GetClosePlayerToPlayer(Unum i)
 {
 	int index = Unum2Index(i);
-	if (mPlayer2PlayerList[index].empty()){
+	InfoCompute compute(mCloseToPlayerCache[index], mpWorldState->CurrentTime());
+	if (!compute.IsHit()){
 		mPlayer2PlayerList[index] = GetClosePlayerToPoint(mpWorldState->GetPlayer(i).GetPos(), i);
-	}
-	return mPlayer2PlayerList[index];
-}
 
-const vector<Unum> & PositionInfo::GetCloseTeammateToPlayer(Unum i)
-{
-	int index = Unum2Index(i);
-	if (mTeammate2PlayerList[index].empty()){
-		const vector<Unum> & player2player = GetClosePlayerToPlayer(i);
-		for (vector<Unum>::const_iterator it = player2player.begin(); it != player2player.end(); ++it){
+		mTeammate2PlayerList[index].clear();
+		mOpponent2PlayerList[index].clear();
+		for (vector<Unum>::const_iterator it = mPlayer2PlayerList[index].begin(); it != mPlayer2PlayerList[index].end(); ++it){
 			if ((*it) > 0){
 				mTeammate2PlayerList[index].push_back(*it);
 			}
+			else {
+				mOpponent2PlayerList[index].push_back(-(*it));
+			}
 		}
 	}
-	return mTeammate2PlayerList[index];
+	return mPlayer2PlayerList[index];
+}
+
+const vector<Unum> & PositionInfo::GetCloseTeammateToPlayer(Unum i)
+{
+	GetClosePlayerToPlayer(i);
+	return mTeammate2PlayerList[Unum2Index(i)];
 }
 
 const vector<Unum> & PositionInfo::GetCloseOpponentToPlayer(Unum i)
 {
-	int index = Unum2Index(i);
-	if (mOpponent2PlayerList[index].empty()){
-		const vector<Unum> & player2player = GetClosePlayerToPlayer(i);
-		for (vector<Unum>::const_iterator it = player2player.begin(); it != player2player.end(); ++it){
-			if ((*it) < 0){
-				mOpponent2PlayerList[index].push_back(-(*it));
-			}
-		}
-	}
-	return mOpponent2PlayerList[index];
+	GetClosePlayerToPlayer(i);
+	return mOpponent2PlayerList[Unum2Index(i)];
 }
 
 //距离球最近按距离且可踢（F）
 const vector<Unum> & PositionInfo::GetPlayerWithBallList()
 {
-	if (mPlayerWithBallList_UpdateTime != mpWorldState->CurrentTime()){
+	InfoCompute compute(mPlayerWithBallCache, mpWorldState->CurrentTime());
+	if (!compute.IsHit()){
 		mPlayerWithBallList.clear();
-		if (GetClosePlayerToBall().size() > 0) {
-			for (unsigned int i = 0; i < GetClosePlayerToBall().size(); ++i) {
-				Unum unum = GetClosePlayerToBall()[i];
-				if (mpWorldState->GetPlayer(unum).IsKickable()) {
-					mPlayerWithBallList.push_back(unum);
-				}
+		const vector<Unum> & player2ball = GetClosePlayerToBall();
+		for (unsigned int i = 0; i < player2ball.size(); ++i) {
+			Unum unum = player2ball[i];
+			if (mpWorldState->GetPlayer(unum).IsKickable()) {
+				mPlayerWithBallList.push_back(unum);
 			}
 		}
-		mPlayerWithBallList_UpdateTime = mpWorldState->CurrentTime();
 	}
 	return mPlayerWithBallList;
 }
@@ -39,6 +39,8 @@
 #include <utility>
 #include <deque>
 
+//#define __SHOOT_ANGLE_TEST //随机对手分布下比较扫描线求射门角度与原来按方向排序求空隙的结果和耗时
+
 class WorldState;
 
 /**
@@ -97,15 +99,30 @@ public:
 	double GetClosestTeammateDistToBall() { return GetClosestTeammateToBall() == 0? HUGE_VALUE: mpWorldState->GetTeammate(GetClosestTeammateToBall()).GetPos().Dist(mpWorldState->GetBall().GetPos()); }
 	double GetClosestOpponentDistToBall() { return GetClosestOpponentToBall() == 0? HUGE_VALUE: mpWorldState->GetOpponent(GetClosestOpponentToBall()).GetPos().Dist(mpWorldState->GetBall().GetPos()); }
 
-	const Unum & GetTeammateOffsideLineOpp() const     { return mTeammateOffsideLineOpp; }
-	const double & GetTeammateOffsideLine() const       { return mTeammateOffsideLine; }
-	const double & GetTeammateOffsideLineConf() const   { return mTeammateOffsideLineConf; }
-	const double & GetTeammateOffsideLineSpeed() const  { return mTeammateOffsideLineSpeed; }
-
-	const Unum & GetOpponentOffsideLineTm() const     { return mOpponentOffsideLineTm; }
-	const double & GetOpponentOffsideLine() const       { return mOpponentOffsideLine; }
-	const double & GetOpponentOffsideLineConf() const   { return mOpponentOffsideLineConf; }
-	const double & GetOpponentOffsideLineSpeed() const  { return mOpponentOffsideLineSpeed; }
+	const Unum & GetTeammateOffsideLineOpp() const     { VerifyOffsideLine(); return mTeammateOffsideLineOpp; }
+	const double & GetTeammateOffsideLine() const       { VerifyOffsideLine(); return mTeammateOffsideLine; }
+	const double & GetTeammateOffsideLineConf() const   { VerifyOffsideLine(); return mTeammateOffsideLineConf; }
+	const double & GetTeammateOffsideLineSpeed() const  { VerifyOffsideLine(); return mTeammateOffsideLineSpeed; }
+
+	const Unum & GetOpponentOffsideLineTm() const     { VerifyOffsideLine(); return mOpponentOffsideLineTm; }
+	const double & GetOpponentOffsideLine() const       { VerifyOffsideLine(); return mOpponentOffsideLine; }
+	const double & GetOpponentOffsideLineConf() const   { VerifyOffsideLine(); return mOpponentOffsideLineConf; }
+	const double & GetOpponentOffsideLineSpeed() const  { VerifyOffsideLine(); return mOpponentOffsideLineSpeed; }
+
+	/** 角度区间 [first, second]，first <= second */
+	typedef std::pair<AngleDeg, AngleDeg> AngleInterval;
+
+	/**
+	 * 从state位置看过去，[left, right]之间没有被对手封住的角度区间，按角度从小到大排列
+	 * 守门员按扑球范围、其他对手按踢球范围，再加上球飞到其所在距离（最多到球门）前除去反应和转身后能跑到的距离遮挡，
+	 * 队友按身体大小遮挡；一个人最多遮住 SHOOT_SHADOW_MAX_RATE 的球门宽度。对各遮挡区间排序后扫描一遍得到，O(n log n)
+	 */
+	void GetShootIntervals(AngleDeg left, AngleDeg right, const PlayerState & state, std::vector<AngleInterval> & intervals) const;
+
+	/**
+	 * shoot_shadow_model 打开时取GetShootIntervals中最宽的区间，返回其中间方向，interval为其宽度；
+	 * 否则按原来的方法在球员方向之间找最大的空隙
+	 */
 	AngleDeg GetShootAngle(AngleDeg left,AngleDeg right , const PlayerState & state  , AngleDeg & interval);
 
 	/** 得到当前可以踢到球的球员列表 */
@@ -141,6 +158,11 @@ public:
      */
     Unum GetOpponentWithBall(const double buffer);
 
+    /**
+     * 世界状态在同一周期内被改过（反算时的WorldStateSetter）时，让所有缓存都重新计算
+     */
+    void Invalidate();
+
 private:
 	/** 更新函数 */
 	void UpdateRoutine();
@@ -154,10 +176,29 @@ private:
 		return index <= TEAMSIZE? index: TEAMSIZE - index;
 	}
 
+	/** 把以left为0的遮挡区间排序后扫描，求出[0, span]中没有被遮挡的区间，结果仍以left为0 */
+	static void SweepFreeIntervals(std::vector<AngleInterval> & shadows, AngleDeg span, std::vector<AngleInterval> & intervals);
+
+	/** 对手横向封堵射门线前要转身的周期数 */
+	static double GetShadowTurnCycle(const PlayerState & player, AngleDeg dir);
+
+	static AngleDeg GetShootAngleByDirs(AngleDeg left, AngleDeg right, std::vector<AngleDeg> dirs, AngleDeg & interval);
+
+#ifdef __SHOOT_ANGLE_TEST
+	static void BenchmarkShootAngle();
+#endif
+
+	static const double SHOOT_SHADOW_MAX_RATE; //一个人的遮挡最多占球门角度的比例
+
 	void UpdateDistMatrix();
 	void UpdateOffsideLine();
     void UpdateOppGoalInfo(); /** 暂时这样命名，以后有需要再改 */
 
+	/** 首次用到时才计算，见InfoCache */
+	void VerifyDistMatrix() const;
+	void VerifyOffsideLine() const;
+	void VerifyOppGoalInfo() const;
+
 private:
 	Array<Array<double, 1 + 2 * TEAMSIZE>, 1 + 2 * TEAMSIZE > mDistMatrix; // 22名球员和球相互之间的距离，0为球，1-11为队友，12到22为对手
 
@@ -183,7 +224,17 @@ private:
 	double mOpponentOffsideLineSpeed;
 
 	std::vector<Unum> mPlayerWithBallList; //当前可以踢球的队员集合 -- 不加buffer的判断
-	Time mPlayerWithBallList_UpdateTime;
+
+	InfoCache mDistMatrixCache;
+	InfoCache mOffsideLineCache;
+	InfoCache mOppGoalInfoCache;
+	InfoCache mXSortTeammateCache;
+	InfoCache mXSortOpponentCache;
+	InfoCache mCloseToBallCache;
+	std::vector<InfoCache> mCloseToPlayerCache;
+	InfoCache mPlayerWithBallCache;
+
+	std::vector<AngleInterval> mShootIntervals; //GetShootAngle用，避免每次重新分配
 
 private:
 	class PlayerDistCompare {
@@ -205,10 +256,12 @@ public:
     }
 
     const AngleDeg & GetTeammateDir2Ball(Unum unum) const {
+        VerifyDistMatrix();
         return mTeammateDir2Ball[unum - 1];
     }
 
     const AngleDeg & GetOpponentDir2Ball(Unum unum) const {
+        VerifyDistMatrix();
         return mOpponentDir2Ball[unum - 1];
     }
 
@@ -217,12 +270,12 @@ private:
     Array<AngleDeg, TEAMSIZE> mOpponentDir2Ball; // 对手相对球的角度
 
 public:
-    const Vector & GetOppGoal2Ball() const      { return mOppGoal2Ball; }
-    const Vector & GetOppLeftPost2Ball() const  { return mOppLeftPost2Ball; }
-    const Vector & GetOppRightPost2Ball() const { return mOppRightPost2Ball; }
-    const AngleDeg & GetOppGoal2BallAngle() const       { return mOppGoal2BallAngle; }
-    const AngleDeg & GetOppLeftPost2BallAngle() const   { return mOppLeftPost2BallAngle; }
-    const AngleDeg & GetOppRightPost2BallAngle() const  { return mOppRightPost2BallAngle; }
+    const Vector & GetOppGoal2Ball() const      { VerifyOppGoalInfo(); return mOppGoal2Ball; }
+    const Vector & GetOppLeftPost2Ball() const  { VerifyOppGoalInfo(); return mOppLeftPost2Ball; }
+    const Vector & GetOppRightPost2Ball() const { VerifyOppGoalInfo(); return mOppRightPost2Ball; }
+    const AngleDeg & GetOppGoal2BallAngle() const       { VerifyOppGoalInfo(); return mOppGoal2BallAngle; }
+    const AngleDeg & GetOppLeftPost2BallAngle() const   { VerifyOppGoalInfo(); return mOppLeftPost2BallAngle; }
+    const AngleDeg & GetOppRightPost2BallAngle() const  { VerifyOppGoalInfo(); return mOppRightPost2BallAngle; }
 
 private:
     Vector mOppGoal2Ball;       // 球门中心
@@ -0,0 +1,286 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file RolloutEvaluator.cpp
+ * @brief 传球的蒙特卡洛模拟评估（RolloutEvaluator）实现
+ *
+ * 同步方式：
+ * - 每批模拟开始时加一 mGeneration 并唤醒工作线程，工作线程比较自己记下的批号发现新的一批；
+ * - 块通过 mNextChunk 在 mMutex 下领取，决策线程自己也领取，领完或超时后等待 mBusyWorkers 归零；
+ * - ThreadCondition 没有谓词，可能丢失唤醒，所以等待都带超时，醒来后重新检查状态。
+ */
+
+#include "RolloutEvaluator.h"
+#include "PlayerState.h"
+#include <ctime>
+
+RolloutEvaluator::Chaser::Chaser(const PlayerState & player):
+	mPlayer(player),
+	mControlArea(player.GetKickableArea())
+{
+	if (player.IsGoalie()) {
+		mControlArea = Max(mControlArea, ServerParam::instance().catchAreaLength());
+	}
+}
+
+RolloutEvaluator::PassTask::PassTask(const Vector & ball_pos, const Vector & ball_vel, const PlayerState & receiver, int samples):
+	mBallPos(ball_pos),
+	mBallVel(ball_vel),
+	mReceiver(receiver),
+	mSamples(samples),
+	mRollouts(0),
+	mSuccess(0),
+	mSuccessPosSum(0.0, 0.0)
+{
+}
+
+RolloutEvaluator::RolloutEvaluator():
+	mRandom(time(0)),
+	mpTasks(0),
+	mNextChunk(0),
+	mGeneration(0),
+	mBusyWorkers(0),
+	mLastRollouts(0),
+	mLastCost(0),
+	mTotalRollouts(0),
+	mTotalCost(0)
+{
+}
+
+RolloutEvaluator::~RolloutEvaluator()
+{
+	//工作线程阻塞在等待上，随进程一起结束，与其他后台线程一样不做回收
+}
+
+RolloutEvaluator & RolloutEvaluator::instance()
+{
+	static RolloutEvaluator rollout_evaluator;
+	return rollout_evaluator;
+}
+
+RolloutEvaluator::Worker::Worker(RolloutEvaluator & evaluator, unsigned long long seed):
+	mEvaluator(evaluator),
+	mRandom(seed),
+	mGeneration(0)
+{
+}
+
+void RolloutEvaluator::Worker::StartRoutine()
+{
+	for (;;) {
+		mEvaluator.mMutex.Lock();
+		const bool has_work = mGeneration != mEvaluator.mGeneration;
+		if (has_work) {
+			mGeneration = mEvaluator.mGeneration;
+			++mEvaluator.mBusyWorkers;
+		}
+		mEvaluator.mMutex.UnLock();
+
+		if (!has_work) {
+			mWake.Wait(20);
+			continue;
+		}
+
+		mEvaluator.RunChunks(mRandom, mBuffer);
+
+		mEvaluator.mMutex.Lock();
+		--mEvaluator.mBusyWorkers;
+		mEvaluator.mMutex.UnLock();
+		mEvaluator.mDone.Set();
+	}
+}
+
+/**
+ * @brief 模拟所有候选
+ *
+ * 第一次调用时按 pass_rollout_threads 启动工作线程。每个候选的模拟次数切成 CHUNK_SIZE 一块，
+ * 按候选轮流排列，这样超时后各个候选的模拟次数差不多。
+ *
+ * @param tasks 传球候选
+ * @param budget 时间预算（毫秒）
+ * @return int 实际模拟的总次数
+ */
+int RolloutEvaluator::Evaluate(std::vector<PassTask> & tasks, int budget)
+{
+	if (mWorkers.empty()) {
+#ifdef __SIMULATOR_BENCHMARK
+		Simulator::BenchmarkBatch();
+#endif
+		for (int i = 1; i < PlayerParam::instance().PassRolloutThreads(); ++i) {
+			mWorkers.push_back(new Worker(*this, mRandom.Next()));
+			mWorkers.back()->Start();
+		}
+	}
+
+	RealTime begin = GetRealTime();
+
+	mMutex.Lock();
+	mpTasks = & tasks;
+	mChunks.clear();
+	for (int done = 0; ; done += CHUNK_SIZE) {
+		bool added = false;
+		for (unsigned int i = 0; i < tasks.size(); ++i) {
+			if (done < tasks[i].mSamples) {
+				mChunks.push_back(std::make_pair(int(i), Min(int(CHUNK_SIZE), tasks[i].mSamples - done)));
+				added = true;
+			}
+		}
+		if (!added) break;
+	}
+	mNextChunk = 0;
+	mDeadline = begin + budget;
+	++mGeneration;
+	mMutex.UnLock();
+
+	for (unsigned int i = 0; i < mWorkers.size(); ++i) {
+		mWorkers[i]->Wake();
+	}
+
+	RunChunks(mRandom, mBuffer);
+
+	for (;;) {
+		mMutex.Lock();
+		const bool busy = mBusyWorkers > 0;
+		if (!busy) {
+			mChunks.clear(); //之后才醒来的工作线程领不到块，不会再访问tasks
+			mpTasks = 0;
+		}
+		mMutex.UnLock();
+
+		if (!busy) break;
+		mDone.Wait(1);
+	}
+
+	RealTime end = GetRealTime();
+
+	mLastRollouts = 0;
+	for (unsigned int i = 0; i < tasks.size(); ++i) {
+		mLastRollouts += tasks[i].mRollouts;
+	}
+	mLastCost = end.Sub(begin);
+	mTotalRollouts += mLastRollouts;
+	mTotalCost += mLastCost;
+
+	return mLastRollouts;
+}
+
+void RolloutEvaluator::RunChunks(Simulator::Random & random, RolloutBuffer & buffer)
+{
+	for (;;) {
+		const RealTime now = GetRealTime();
+
+		mMutex.Lock();
+		if (mNextChunk >= mChunks.size() || !(now < mDeadline)) {
+			mMutex.UnLock();
+			break;
+		}
+		PassTask & task = (*mpTasks)[mChunks[mNextChunk].first];
+		const int count = mChunks[mNextChunk].second;
+		++mNextChunk;
+		mMutex.UnLock();
+
+		Vector success_pos_sum(0.0, 0.0);
+		const int success = RolloutBatch(task, count, random, buffer, success_pos_sum);
+
+		mMutex.Lock();
+		task.mRollouts += count;
+		task.mSuccess += success;
+		task.mSuccessPosSum += success_pos_sum;
+		mMutex.UnLock();
+	}
+}
+
+/**
+ * @brief 批量模拟一个块
+ *
+ * 每周期所有人先追向球下一周期的位置，然后球加噪声前进一步；对手先判断，同时碰到球算失败。
+ * 球出界或 MAX_CYCLE 周期内没人碰到球也算失败。已经有结果的假设继续跟着推进（保持循环没有分支），
+ * 只是不再判断，所有假设都有结果后提前结束。
+ */
+int RolloutEvaluator::RolloutBatch(const PassTask & task, int count, Simulator::Random & random, RolloutBuffer & buffer, Vector & success_pos_sum)
+{
+	buffer.mBall.Assign(task.mBallPos, task.mBallVel, count);
+	buffer.mReceiver.Assign(task.mReceiver.mPlayer, count);
+	if (buffer.mOpponents.size() < task.mOpponents.size()) {
+		buffer.mOpponents.resize(task.mOpponents.size());
+	}
+	for (unsigned int j = 0; j < task.mOpponents.size(); ++j) {
+		buffer.mOpponents[j].Assign(task.mOpponents[j].mPlayer, count);
+	}
+	buffer.mTargetX.resize(count);
+	buffer.mTargetY.resize(count);
+	buffer.mActive.assign(count, 1);
+
+	const Simulator::BallBatch & ball = buffer.mBall;
+	const double receiver_area2 = task.mReceiver.mControlArea * task.mReceiver.mControlArea;
+	int success = 0;
+	int active = count;
+
+	for (int cycle = 0; cycle < MAX_CYCLE && active > 0; ++cycle) {
+		for (int k = 0; k < count; ++k) {
+			buffer.mTargetX[k] = ball.mPosX[k] + ball.mVelX[k];
+			buffer.mTargetY[k] = ball.mPosY[k] + ball.mVelY[k];
+		}
+
+		buffer.mReceiver.Chase(&buffer.mTargetX[0], &buffer.mTargetY[0], TURN_BUFFER);
+		for (unsigned int j = 0; j < task.mOpponents.size(); ++j) {
+			buffer.mOpponents[j].Chase(&buffer.mTargetX[0], &buffer.mTargetY[0], TURN_BUFFER);
+		}
+
+		buffer.mBall.RandomizedStep(random);
+
+		for (int k = 0; k < count; ++k) {
+			if (!buffer.mActive[k]) continue;
+
+			const Vector ball_pos = ball.GetPos(k);
+			bool lost = !ServerParam::instance().pitchRectanglar().IsWithin(ball_pos);
+			for (unsigned int j = 0; !lost && j < task.mOpponents.size(); ++j) {
+				const double area = task.mOpponents[j].mControlArea;
+				lost = buffer.mOpponents[j].GetPos(k).Dist2(ball_pos) < area * area;
+			}
+
+			if (lost) {
+				buffer.mActive[k] = 0;
+				--active;
+			}
+			else if (buffer.mReceiver.GetPos(k).Dist2(ball_pos) < receiver_area2) {
+				buffer.mActive[k] = 0;
+				--active;
+				++success;
+				success_pos_sum += ball_pos;
+			}
+		}
+	}
+
+	return success;
+}
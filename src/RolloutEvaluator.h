@@ -0,0 +1,158 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file RolloutEvaluator.h
+ * @brief 传球的蒙特卡洛模拟评估（RolloutEvaluator）接口定义
+ *
+ * 对每个传球候选用 Simulator 模拟若干次：球按 ball_rand 加噪声运动，接球队友和对手都
+ * 贪心地追球，队友先于所有对手碰到球算一次成功，由此得到成功率和成功时的平均接球点。
+ * 一个块里的各次模拟作为 BallBatch/PlayerBatch 的假设一起推进。
+ * 模拟按块分给线程池，决策线程自己也参与，超过时间预算后不再派发新的块。
+ */
+
+#ifndef __RolloutEvaluator_H__
+#define __RolloutEvaluator_H__
+
+#include "Simulator.h"
+#include "Thread.h"
+#include <vector>
+
+class RolloutEvaluator
+{
+	RolloutEvaluator();
+
+public:
+	~RolloutEvaluator();
+
+	static RolloutEvaluator & instance();
+
+	/** 追球的球员和他能控到球的范围（可踢，守门员取可扑） */
+	struct Chaser {
+		Simulator::Player mPlayer;
+		double mControlArea;
+
+		Chaser(const PlayerState & player);
+	};
+
+	/** 一个传球候选，前面是输入，后面是模拟结果 */
+	struct PassTask {
+		Vector mBallPos;
+		Vector mBallVel;
+		Chaser mReceiver;
+		std::vector<Chaser> mOpponents;
+		int mSamples; // 最多模拟的次数
+
+		int mRollouts; // 实际模拟的次数
+		int mSuccess; // 成功的次数
+		Vector mSuccessPosSum; // 成功时接球点之和
+
+		PassTask(const Vector & ball_pos, const Vector & ball_vel, const PlayerState & receiver, int samples);
+
+		double GetSuccessProb() const { return mRollouts > 0? double(mSuccess) / mRollouts: 0.0; }
+		Vector GetMeanSuccessPos() const { return mSuccess > 0? mSuccessPosSum / mSuccess: mBallPos; }
+	};
+
+	/**
+	 * 在budget毫秒内模拟tasks中的所有候选，结果写回各个PassTask
+	 * @return 实际模拟的总次数
+	 */
+	int Evaluate(std::vector<PassTask> & tasks, int budget);
+
+	/** 最近一次和累计的吞吐量，单位：次/毫秒 */
+	double GetLastRolloutsPerMs() const { return mLastCost > 0? mLastRollouts * 1000.0 / mLastCost: 0.0; }
+	double GetRolloutsPerMs() const { return mTotalCost > 0? mTotalRollouts * 1000.0 / mTotalCost: 0.0; }
+
+private:
+	/** 每个线程一份的批量模拟状态，块与块之间、每次Evaluate之间都复用，不重新分配 */
+	struct RolloutBuffer {
+		Simulator::BallBatch mBall;
+		Simulator::PlayerBatch mReceiver;
+		std::vector<Simulator::PlayerBatch> mOpponents;
+		std::vector<double> mTargetX;
+		std::vector<double> mTargetY;
+		std::vector<char> mActive;
+	};
+
+	class Worker: public Thread
+	{
+	public:
+		Worker(RolloutEvaluator & evaluator, unsigned long long seed);
+
+		void Wake() { mWake.Set(); }
+
+	private:
+		void StartRoutine();
+
+	private:
+		RolloutEvaluator & mEvaluator;
+		Simulator::Random mRandom;
+		RolloutBuffer mBuffer;
+		ThreadCondition mWake;
+		int mGeneration; // 已经处理过的那一批
+	};
+
+	enum {
+		CHUNK_SIZE = 16, // 每次派发的模拟次数，也是批量模拟的假设个数
+		MAX_CYCLE = 30, // 每次最多模拟的周期数
+		TURN_BUFFER = 15 // 追球时不转身可以容忍的方向偏差
+	};
+
+	/** 领取并模拟块，直到没有块或者超时 */
+	void RunChunks(Simulator::Random & random, RolloutBuffer & buffer);
+
+	/** 把一个块的count次模拟作为count个假设一起推进，返回成功次数并累加成功时的接球点 */
+	static int RolloutBatch(const PassTask & task, int count, Simulator::Random & random, RolloutBuffer & buffer, Vector & success_pos_sum);
+
+private:
+	std::vector<Worker *> mWorkers;
+	Simulator::Random mRandom; // 决策线程自己用
+	RolloutBuffer mBuffer; // 决策线程自己用
+
+	/** 以下由mMutex保护 */
+	ThreadMutex mMutex;
+	std::vector<PassTask> * mpTasks;
+	std::vector<std::pair<int, int> > mChunks; // (候选下标, 模拟次数)
+	unsigned int mNextChunk;
+	RealTime mDeadline;
+	int mGeneration; // 每批加一，工作线程据此发现新的一批
+	int mBusyWorkers;
+
+	ThreadCondition mDone;
+
+	long mLastRollouts;
+	long mLastCost; // 微秒
+	long long mTotalRollouts;
+	long long mTotalCost;
+};
+
+#endif
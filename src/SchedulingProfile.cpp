@@ -0,0 +1,277 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file SchedulingProfile.cpp
+ * @brief 线程的CPU绑定和调度优先级（SchedulingProfile）实现
+ */
+
+#include "SchedulingProfile.h"
+#include "PlayerParam.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#ifndef WIN32
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+SchedulingProfile::SchedulingProfile():
+	mUnum(0),
+	mErrorReported(false),
+	mLastInvoluntary(-1),
+	mCycles(0),
+	mInvoluntarySum(0),
+	mInvoluntaryMax(0)
+{
+}
+
+SchedulingProfile::~SchedulingProfile()
+{
+}
+
+SchedulingProfile & SchedulingProfile::instance()
+{
+	static SchedulingProfile scheduling_profile;
+	return scheduling_profile;
+}
+
+bool SchedulingProfile::ParseCpuList(const std::string & text, std::vector<int> & cpus)
+{
+	cpus.clear();
+
+	const char *p = text.c_str();
+	while (*p != '\0') {
+		if (*p == ',' || *p == ' ') {
+			++p;
+			continue;
+		}
+
+		char *end = 0;
+		long first = strtol(p, & end, 10);
+		if (end == p || first < 0) return false;
+		long last = first;
+		p = end;
+		if (*p == '-') {
+			++p;
+			last = strtol(p, & end, 10);
+			if (end == p || last < first) return false;
+			p = end;
+		}
+		for (long cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+	return true;
+}
+
+void SchedulingProfile::GetCpus(ThreadRole role, std::vector<int> & cpus) const
+{
+	cpus.clear();
+
+	if (role == TR_Logger && !PlayerParam::instance().SchedLoggerCpus().empty()) {
+		if (!ParseCpuList(PlayerParam::instance().SchedLoggerCpus(), cpus)) {
+			cpus.clear();
+		}
+		return;
+	}
+
+	std::vector<int> all;
+	if (!ParseCpuList(PlayerParam::instance().SchedCpus(), all) || all.empty()) return;
+
+	// 球员按号码排，教练和训练师排在最后
+	int slot = mUnum - 1;
+	if (mUnum <= 0) {
+		slot = TEAMSIZE;
+	}
+	else if (mUnum > TEAMSIZE) {
+		slot = TEAMSIZE + 1;
+	}
+
+	int per = Max(PlayerParam::instance().SchedCpusPerProcess(), 1);
+	for (int k = 0; k < per; ++k) {
+		int cpu = all[(slot * per + k) % all.size()];
+		if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+			cpus.push_back(cpu);
+		}
+	}
+}
+
+#ifndef WIN32
+
+void SchedulingProfile::SetAffinity(const Entry & entry)
+{
+	std::vector<int> cpus;
+	GetCpus(entry.mRole, cpus);
+	if (cpus.empty()) return;
+
+	cpu_set_t cpu_set;
+	CPU_ZERO(& cpu_set);
+	for (std::vector<int>::iterator it = cpus.begin(); it != cpus.end(); ++it) {
+		if (*it < CPU_SETSIZE) {
+			CPU_SET(*it, & cpu_set);
+		}
+	}
+
+	int ret = pthread_setaffinity_np(entry.mThread, sizeof(cpu_set), & cpu_set);
+	if (ret != 0 && !mErrorReported) {
+		mErrorReported = true;
+		PRINT_ERROR("pthread_setaffinity_np failed: " << strerror(ret));
+	}
+}
+
+void SchedulingProfile::Apply(ThreadRole role)
+{
+	const PlayerParam & param = PlayerParam::instance();
+
+	if (param.SchedFifo() && (role == TR_Parser || role == TR_Decision)) {
+		struct sched_param sched;
+		memset(& sched, 0, sizeof(sched));
+		sched.sched_priority = param.SchedFifoPriority() + (role == TR_Parser ? 1 : 0); // 视觉到达时 Parser 要能抢占决策
+		int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, & sched);
+		if (ret != 0 && !mErrorReported) {
+			mErrorReported = true;
+			PRINT_ERROR("SCHED_FIFO failed: " << strerror(ret) << " (need CAP_SYS_NICE or rtprio limit)");
+		}
+	}
+
+	if (role == TR_Logger && param.SchedLoggerNice() != 0) {
+		// Linux 下 nice 值是按线程的，所以用线程自己的 tid
+		pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+		if (setpriority(PRIO_PROCESS, tid, param.SchedLoggerNice()) != 0 && !mErrorReported) {
+			mErrorReported = true;
+			PRINT_ERROR("setpriority failed: " << strerror(errno));
+		}
+	}
+
+	Entry entry;
+	entry.mThread = pthread_self();
+	entry.mRole = role;
+
+	mMutex.Lock();
+	mThreads.push_back(entry);
+	if (mUnum != 0) {
+		SetAffinity(entry);
+	}
+	mMutex.UnLock();
+}
+
+void SchedulingProfile::Remove()
+{
+	pthread_t self = pthread_self();
+
+	mMutex.Lock();
+	for (std::vector<Entry>::iterator it = mThreads.begin(); it != mThreads.end(); ++it) {
+		if (pthread_equal(it->mThread, self)) {
+			mThreads.erase(it);
+			break;
+		}
+	}
+	mMutex.UnLock();
+}
+
+void SchedulingProfile::SetUnum(Unum unum)
+{
+	mMutex.Lock();
+	mUnum = unum;
+	for (std::vector<Entry>::iterator it = mThreads.begin(); it != mThreads.end(); ++it) {
+		SetAffinity(*it);
+	}
+	mMutex.UnLock();
+}
+
+void SchedulingProfile::AddCycle(const Time & time)
+{
+	struct rusage usage;
+	memset(& usage, 0, sizeof(usage));
+	getrusage(RUSAGE_SELF, & usage);
+
+	long involuntary = usage.ru_nivcsw;
+	if (mLastInvoluntary >= 0) {
+		long delta = involuntary - mLastInvoluntary;
+		mInvoluntarySum += delta;
+		mInvoluntaryMax = Max(mInvoluntaryMax, delta);
+		++mCycles;
+
+		if (PlayerParam::instance().SaveTextLog()) {
+			Logger::instance().GetTextLogger("sched") << time << " involuntary switches: " << delta << std::endl;
+		}
+	}
+	mLastInvoluntary = involuntary;
+}
+
+#else
+
+void SchedulingProfile::Apply(ThreadRole)
+{
+}
+
+void SchedulingProfile::Remove()
+{
+}
+
+void SchedulingProfile::SetUnum(Unum unum)
+{
+	mUnum = unum;
+}
+
+void SchedulingProfile::AddCycle(const Time &)
+{
+}
+
+#endif
+
+void SchedulingProfile::WriteStats() const
+{
+	char file_name[256];
+	sprintf(file_name, "Test/Sched-%d.txt", mUnum);
+
+	std::ofstream out_file(file_name);
+	if (out_file.good() == false) {
+		PRINT_ERROR("open file error  " << file_name);
+		return;
+	}
+
+	out_file << "cpus: " << PlayerParam::instance().SchedCpus() << " x " << PlayerParam::instance().SchedCpusPerProcess() << std::endl;
+	out_file << "sched_fifo: " << PlayerParam::instance().SchedFifo() << std::endl;
+	out_file << "cycles: " << mCycles << std::endl;
+	out_file << "involuntary switches: " << mInvoluntarySum << std::endl;
+	out_file << "involuntary switches per cycle: " << (mCycles > 0 ? double(mInvoluntarySum) / mCycles : 0.0) << std::endl;
+	out_file << "involuntary switches max: " << mInvoluntaryMax << std::endl;
+	out_file.close();
+}
@@ -0,0 +1,118 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file SchedulingProfile.h
+ * @brief 线程的CPU绑定和调度优先级（SchedulingProfile）接口定义
+ *
+ * 每个线程启动时按角色登记：
+ * - sched_cpus 给出整队可用的CPU，每个进程按号码分到 sched_cpus_per_process 个，
+ *   决策、Parser、CommandSender 和工作线程都绑在这几个CPU上，Logger 可以用 sched_logger_cpus 单独指定；
+ *   号码要连上server后才知道，所以 SetUnum 时再把已经登记的线程统一绑一次；
+ * - sched_fifo 打开时 Parser 和决策线程用 SCHED_FIFO，Parser 高一级，视觉一到就能抢占决策；
+ * - Logger 线程用 sched_logger_nice 降低优先级。
+ * 另外每周期统计整个进程的非自愿上下文切换次数，用来检查配置的效果。
+ */
+
+#ifndef __SchedulingProfile_H__
+#define __SchedulingProfile_H__
+
+#include "Thread.h"
+#include "Types.h"
+#include <string>
+#include <vector>
+
+class Time;
+
+class SchedulingProfile
+{
+	SchedulingProfile();
+
+public:
+	~SchedulingProfile();
+
+	static SchedulingProfile & instance();
+
+	/**
+	 * 在线程自己里调用，登记并按角色设置CPU和优先级
+	 */
+	void Apply(ThreadRole role);
+
+	/**
+	 * 线程退出前调用，注销登记
+	 */
+	void Remove();
+
+	/**
+	 * 知道号码后，把已经登记的线程绑到本进程分到的CPU上
+	 */
+	void SetUnum(Unum unum);
+
+	/**
+	 * 每周期决策后调用，记录这一周期内整个进程的非自愿上下文切换次数
+	 */
+	void AddCycle(const Time & time);
+
+	/**
+	 * time_test 时把统计写到 Test/Sched-<unum>.txt
+	 */
+	void WriteStats() const;
+
+	/** 解析 "0-3,6,8-9" 这样的CPU列表 */
+	static bool ParseCpuList(const std::string & text, std::vector<int> & cpus);
+
+private:
+	/** 某个角色应该绑的CPU，为空表示不绑 */
+	void GetCpus(ThreadRole role, std::vector<int> & cpus) const;
+
+#ifndef WIN32
+	struct Entry {
+		pthread_t mThread;
+		ThreadRole mRole;
+	};
+
+	void SetAffinity(const Entry & entry);
+
+	std::vector<Entry> mThreads;
+#endif
+	ThreadMutex mMutex;
+
+	Unum mUnum;
+	bool mErrorReported; // 没有权限等错误只报一次
+
+	long mLastInvoluntary;
+	long mCycles;
+	long mInvoluntarySum;
+	long mInvoluntaryMax;
+};
+
+#endif
@@ -473,6 +473,13 @@ bool ServerParam::SaveParam()
     return SaveToConfigFile(M_server_conf_file.c_str());
 }
 
+void ServerParam::DumpServerMsg(std::ostream &os)
+{
+	ParamEngine::DumpServerMsg(os);
+	os << "(half_time " << M_half_time * M_simulator_step / 1000 << ")";
+	os << "(extra_half_time " << M_extra_half_time * M_simulator_step / 1000 << ")";
+}
+
 void ServerParam::MaintainConsistency()
 {
 	M_kickable_area = M_player_size + M_kickable_margin + M_ball_size;
@@ -459,6 +459,12 @@ private:
 public:
     bool SaveParam();
 
+    /**
+     * 按server消息的格式输出，half_time和extra_half_time已在MaintainConsistency里换算成周期，
+     * 末尾再按秒输出一次，接收方依次赋值，以后者为准
+     */
+    void DumpServerMsg(std::ostream &os);
+
     // access methods
 
     const double & effortDecStamina() const { return M_effort_dec_stamina; }
@@ -40,10 +40,9 @@
  * - 估算控球概率（考虑铲球与扑球）；
  * - 随机化初始化（用于测试/蒙特卡洛）。
  *
- * 本文件仅实现 Simulator 单例与 Player::Dash/Act，Ball 与 Player 的主要逻辑
- * 均在头文件中以 inline 形式实现。
- *
- * @note 本文件仅补充注释，不改动任何原有逻辑。
+ * 本文件实现 Simulator 单例、Player::Dash（按方向下标和按任意方向两种）/Chase/Act，
+ * 以及成批模拟的 BallBatch/PlayerBatch 和它们的基准测试；Ball 与 Player 的单步逻辑
+ * 仍在头文件中以 inline 形式实现。
  */
 
 #include "Simulator.h"
@@ -82,18 +81,31 @@ Simulator & Simulator::instance()
  * @param dir_idx 方向索引（参见 Dasher::DASH_DIR）
  */
 void Simulator::Player::Dash(double power, int dir_idx)
+{
+	Dash(power, Dasher::DASH_DIR[dir_idx], Dasher::DIR_RATE[dir_idx]);
+}
+
+/**
+ * @brief 球员向任意方向 dash
+ *
+ * 替身server执行 (dash power dir) 时用，dash_dir 已按 dash_angle_step 离散。
+ *
+ * @param power dash 力度（可为负，表示后撤）
+ * @param dash_dir 相对身体的方向
+ * @param dir_rate 该方向的加速度系数（参见 GetDashDirRate）
+ */
+void Simulator::Player::Dash(double power, const AngleDeg & dash_dir, double dir_rate)
 {
 	power = GetNormalizeDashPower(power);
 
-	AngleDeg dir = Dasher::DASH_DIR[dir_idx];
-	double dir_rate = Dasher::DIR_RATE[dir_idx];;
+	AngleDeg dir = dash_dir;
 
 	bool back_dash = power < 0.0;
 
 	double power_need = ( back_dash
 			? power * -2.0
 					: power );
-	power_need = std::min( power_need, mStamina + PlayerParam::instance().HeteroPlayer(mPlayerType).extraStamina() );
+	power_need = std::min( power_need, mStamina + mpProfile->mExtraStamina );
 	mStamina = std::max( 0.0, mStamina - power_need );
 
 	power = ( back_dash
@@ -101,7 +113,7 @@ void Simulator::Player::Dash(double power, int dir_idx)
 					: power_need );
 
 
-	double acc = std::fabs(mEffort * power * dir_rate * PlayerParam::instance().HeteroPlayer(mPlayerType).dashPowerRate());
+	double acc = std::fabs(mEffort * power * dir_rate * mpProfile->mDashPowerRate);
 
 	if ( back_dash ) {
 		dir += 180.0;
@@ -112,12 +124,27 @@ void Simulator::Player::Dash(double power, int dir_idx)
 }
 
 /**
- * @brief 执行原子动作
+ * @brief 球员贪心追向目标点
  *
- * 支持 Turn、Dash、Kick 的模拟；Kick 在此仅执行 Step（无球模型）。
+ * 用于截球的蒙特卡洛模拟：不做规划，每周期只看下一周期自己所在位置到目标的方向，
+ * 偏差大就转身，否则全力向前 dash。
  *
- * @param act 原子动作
+ * @param target 目标点（通常是球下一周期的位置）
+ * @param turn_buffer 不转身可以容忍的方向偏差
  */
+void Simulator::Player::Chase(const Vector & target, const AngleDeg & turn_buffer)
+{
+	static const int forward_idx = Dasher::GetDashDirIdx(0.0);
+
+	const AngleDeg differ = GetNormalizeAngleDeg((target - mPos - mVel).Dir() - mBodyDir);
+	if (std::fabs(differ) > turn_buffer) {
+		Turn(GetTurnMoment(differ, mPlayerType, mVel.Mod()));
+	}
+	else {
+		Dash(ServerParam::instance().maxDashPower(), forward_idx);
+	}
+}
+
 /**
  * @brief 执行原子动作
  *
@@ -135,3 +162,274 @@ void Simulator::Player::Act(const AtomicAction & act)
 	default: Assert(0); break;
 	}
 }
+
+/**
+ * @brief 批量球：所有假设设为同一状态
+ */
+void Simulator::BallBatch::Assign(const Vector & pos, const Vector & vel, int size)
+{
+	mPosX.assign(size, pos.X());
+	mPosY.assign(size, pos.Y());
+	mVelX.assign(size, vel.X());
+	mVelY.assign(size, vel.Y());
+
+	mDecay = ServerParam::instance().ballDecay();
+	mRand = ServerParam::instance().ballRand();
+}
+
+void Simulator::BallBatch::Step()
+{
+	const int size = Size();
+	double * px = &mPosX[0], * py = &mPosY[0], * vx = &mVelX[0], * vy = &mVelY[0];
+
+	for (int k = 0; k < size; ++k) {
+		px[k] += vx[k];
+		py[k] += vy[k];
+		vx[k] *= mDecay;
+		vy[k] *= mDecay;
+	}
+}
+
+/**
+ * @brief 批量球：加噪声后前进一步
+ *
+ * 与 Ball::noise 一样，噪声大小在 [0, ball_rand * speed] 上均匀、方向均匀；方向取自 256 个单位向量的表，
+ * 随机数是串行的，先单独一个循环生成，后面的更新循环不依赖随机数发生器。
+ */
+void Simulator::BallBatch::RandomizedStep(Random & random)
+{
+	enum { DIR_SAMPLES = 256 };
+	static struct UnitTable {
+		Array<double, DIR_SAMPLES> mCos;
+		Array<double, DIR_SAMPLES> mSin;
+
+		UnitTable() {
+			for (int i = 0; i < DIR_SAMPLES; ++i) {
+				mCos[i] = Cos(-180.0 + 360.0 * i / DIR_SAMPLES);
+				mSin[i] = Sin(-180.0 + 360.0 * i / DIR_SAMPLES);
+			}
+		}
+	} unit;
+
+	const int size = Size();
+	double * vx = &mVelX[0], * vy = &mVelY[0];
+
+	for (int k = 0; k < size; ++k) {
+		const unsigned long long bits = random.Next();
+		const double r = mRand * ((bits >> 11) * (1.0 / 9007199254740992.0)) * Sqrt(vx[k] * vx[k] + vy[k] * vy[k]);
+		const int idx = bits & (DIR_SAMPLES - 1);
+		vx[k] += r * unit.mCos[idx];
+		vy[k] += r * unit.mSin[idx];
+	}
+
+	Step();
+}
+
+/**
+ * @brief 批量球员：所有假设设为同一状态，并取出本类型的参数
+ */
+void Simulator::PlayerBatch::Assign(const Player & player, int size)
+{
+	mPosX.assign(size, player.mPos.X());
+	mPosY.assign(size, player.mPos.Y());
+	mVelX.assign(size, player.mVel.X());
+	mVelY.assign(size, player.mVel.Y());
+	mBodyDir.assign(size, player.mBodyDir);
+	mStamina.assign(size, player.mStamina);
+	mEffort.assign(size, player.mEffort);
+
+	const PlayerTypeProfile & profile = *player.mpProfile;
+	mDecay = profile.mPlayerDecay;
+	mInertiaMoment = profile.mInertiaMoment;
+	mDashPowerRate = profile.mDashPowerRate;
+	mExtraStamina = profile.mExtraStamina;
+	mEffortMin = profile.mEffortMin;
+	mEffortMax = profile.mEffortMax;
+	mStaminaIncMax = profile.mStaminaIncMax;
+
+	Dasher::instance(); //DIR_RATE 在 Dasher 构造时才算好
+	mForwardDirRate = Dasher::DIR_RATE[Dasher::GetDashDirIdx(0.0)];
+
+	const ServerParam & sp = ServerParam::instance();
+	mStaminaMax = sp.staminaMax();
+	mEffortDecStamina = sp.effortDecThr() * sp.staminaMax();
+	mEffortIncStamina = sp.effortIncThr() * sp.staminaMax();
+	mEffortDec = sp.effortDec();
+	mEffortInc = sp.effortInc();
+	mMinMoment = sp.minMoment();
+	mMaxMoment = sp.maxMoment();
+	mMaxDashPower = sp.maxDashPower();
+}
+
+void Simulator::PlayerBatch::Step()
+{
+	const int size = Size();
+	double * px = &mPosX[0], * py = &mPosY[0], * vx = &mVelX[0], * vy = &mVelY[0];
+
+	for (int k = 0; k < size; ++k) {
+		px[k] += vx[k];
+		py[k] += vy[k];
+		vx[k] *= mDecay;
+		vy[k] *= mDecay;
+	}
+
+	UpdateStamina();
+}
+
+/**
+ * @brief 与 Player::UpdateStamina 相同，分支都写成取大取小，便于向量化
+ */
+void Simulator::PlayerBatch::UpdateStamina()
+{
+	const int size = Size();
+	double * stamina = &mStamina[0], * effort = &mEffort[0];
+
+	for (int k = 0; k < size; ++k) {
+		double e = effort[k];
+		const double dec = (stamina[k] <= mEffortDecStamina && e > mEffortMin)? mEffortDec: 0.0;
+		e -= dec;
+		e = (stamina[k] <= mEffortDecStamina && e < mEffortMin)? mEffortMin: e;
+
+		const double inc = (stamina[k] >= mEffortIncStamina && e < mEffortMax)? mEffortInc: 0.0;
+		e += inc;
+		e = (inc > 0.0 && e > mEffortMax)? mEffortMax: e;
+		effort[k] = e;
+
+		double s = stamina[k] + Min(mStaminaIncMax, mStaminaMax - stamina[k]);
+		stamina[k] = (s > mStaminaMax)? mStaminaMax: s;
+	}
+}
+
+/**
+ * @brief 与 Player::Dash(power, 向前) 相同，只是体力不取整
+ */
+void Simulator::PlayerBatch::Dash(double power)
+{
+	power = MinMax(0.0, GetNormalizeDashPower(power), mMaxDashPower);
+
+	const int size = Size();
+	double * vx = &mVelX[0], * vy = &mVelY[0], * body = &mBodyDir[0], * stamina = &mStamina[0], * effort = &mEffort[0];
+
+	for (int k = 0; k < size; ++k) {
+		const double power_need = Min(power, stamina[k] + mExtraStamina);
+		stamina[k] = Max(0.0, stamina[k] - power_need);
+
+		const double acc = effort[k] * power_need * mForwardDirRate * mDashPowerRate;
+		vx[k] += acc * Cos(body[k]);
+		vy[k] += acc * Sin(body[k]);
+	}
+
+	Step();
+}
+
+/**
+ * @brief 批量贪心追球
+ *
+ * 与 Player::Chase 一致：逐个假设算出目标方向，偏差大的转身，否则 dash 累加加速度，
+ * 最后所有假设一起前进一步（Turn 和 Dash 都以 Step 结束，所以可以合并）。只有最后的 Step 是无分支的。
+ */
+void Simulator::PlayerBatch::Chase(const double * target_x, const double * target_y, const AngleDeg & turn_buffer)
+{
+	const int size = Size();
+	double * px = &mPosX[0], * py = &mPosY[0], * vx = &mVelX[0], * vy = &mVelY[0];
+	double * body = &mBodyDir[0], * stamina = &mStamina[0], * effort = &mEffort[0];
+
+	for (int k = 0; k < size; ++k) {
+		const double speed = Sqrt(vx[k] * vx[k] + vy[k] * vy[k]);
+		const AngleDeg differ = GetNormalizeAngleDeg(ATan2(target_y[k] - py[k] - vy[k], target_x[k] - px[k] - vx[k]) - body[k]);
+
+		if (std::fabs(differ) > turn_buffer) {
+			body[k] = GetNormalizeAngleDeg(body[k] + MinMax(mMinMoment, differ * (1.0 + mInertiaMoment * speed), mMaxMoment) / (1.0 + mInertiaMoment * speed));
+		}
+		else {
+			const double power_need = Min(mMaxDashPower, stamina[k] + mExtraStamina);
+			stamina[k] = Max(0.0, stamina[k] - power_need);
+
+			const double acc = effort[k] * power_need * mForwardDirRate * mDashPowerRate;
+			vx[k] += acc * Cos(body[k]);
+			vy[k] += acc * Sin(body[k]);
+		}
+	}
+
+	Step();
+}
+
+#ifdef __SIMULATOR_BENCHMARK
+/**
+ * @brief 比较逐个模拟与批量模拟
+ *
+ * 同一个球员（0号类型）的 K 个假设追同一个匀减速的球，分别用 Player::Chase 和 PlayerBatch::Chase 模拟，
+ * 输出每秒模拟的假设步数和两者位置的最大差别（体力取整不同，差别应在 1e-6 量级以内）；
+ * 再比较 Ball::RandomizedStep 与 BallBatch::RandomizedStep 的每秒步数。
+ */
+void Simulator::BenchmarkBatch()
+{
+	const int hypotheses = 64;
+	const int steps = 2000;
+
+	Player origin(Vector(-10.0, 5.0), Vector(0.2, 0.0), 30.0, 0);
+	Ball ball(Vector(0.0, 0.0), Vector(2.0, 1.0));
+
+	std::vector<Player> players(hypotheses, origin);
+	PlayerBatch batch(origin, hypotheses);
+	std::vector<double> target_x(hypotheses), target_y(hypotheses);
+
+	RealTime begin = GetRealTime();
+	Ball b = ball;
+	for (int i = 0; i < steps; ++i) {
+		for (int k = 0; k < hypotheses; ++k) {
+			players[k].Chase(b.mPos + b.mVel, 15.0);
+		}
+		b.Step();
+		if (i % 50 == 49) b = ball;
+	}
+	RealTime end = GetRealTime();
+	const long scalar_cost = end.Sub(begin);
+
+	begin = GetRealTime();
+	b = ball;
+	for (int i = 0; i < steps; ++i) {
+		for (int k = 0; k < hypotheses; ++k) {
+			target_x[k] = b.mPos.X() + b.mVel.X();
+			target_y[k] = b.mPos.Y() + b.mVel.Y();
+		}
+		batch.Chase(&target_x[0], &target_y[0], 15.0);
+		b.Step();
+		if (i % 50 == 49) b = ball;
+	}
+	end = GetRealTime();
+	const long batch_cost = end.Sub(begin);
+
+	double max_differ = 0.0;
+	for (int k = 0; k < hypotheses; ++k) {
+		max_differ = Max(max_differ, players[k].mPos.Dist(batch.GetPos(k)));
+	}
+
+	std::cout << "player chase: scalar " << hypotheses * steps * 1.0e6 / Max(scalar_cost, 1L) << " steps/s, batch "
+			<< hypotheses * steps * 1.0e6 / Max(batch_cost, 1L) << " steps/s, max pos differ " << max_differ << std::endl;
+
+	Random random(1);
+	std::vector<Ball> balls(hypotheses, ball);
+	begin = GetRealTime();
+	for (int i = 0; i < steps; ++i) {
+		for (int k = 0; k < hypotheses; ++k) {
+			balls[k].RandomizedStep(random);
+		}
+		if (i % 50 == 49) balls.assign(hypotheses, ball);
+	}
+	end = GetRealTime();
+	const long ball_scalar_cost = end.Sub(begin);
+
+	BallBatch ball_batch(ball.mPos, ball.mVel, hypotheses);
+	begin = GetRealTime();
+	for (int i = 0; i < steps; ++i) {
+		ball_batch.RandomizedStep(random);
+		if (i % 50 == 49) ball_batch.Assign(ball.mPos, ball.mVel, hypotheses);
+	}
+	end = GetRealTime();
+	const long ball_batch_cost = end.Sub(begin);
+
+	std::cout << "ball randomized step: scalar " << hypotheses * steps * 1.0e6 / Max(ball_scalar_cost, 1L) << " steps/s, batch "
+			<< hypotheses * steps * 1.0e6 / Max(ball_batch_cost, 1L) << " steps/s" << std::endl;
+}
+#endif
@@ -40,6 +40,8 @@
 #include "ActionEffector.h"
 #include <vector>
 
+//#define __SIMULATOR_BENCHMARK //比较逐个模拟与批量模拟的每秒步数，并检查两者结果是否一致
+
 struct AtomicAction;
 
 class Simulator {
@@ -51,6 +53,27 @@ public:
 	static Simulator & instance();
 
 public:
+	/**
+	 * xorshift64*，每个线程各用一个，代替共享状态、不可重入的drand
+	 */
+	struct Random {
+		unsigned long long mState;
+
+	public:
+		explicit Random(unsigned long long seed = 0): mState(seed? seed: 88172645463325252ULL) { }
+
+		unsigned long long Next() {
+			mState ^= mState >> 12;
+			mState ^= mState << 25;
+			mState ^= mState >> 27;
+			return mState * 2685821657736338717ULL;
+		}
+
+		double Uniform(double low, double high) {
+			return low + (high - low) * ((Next() >> 11) * (1.0 / 9007199254740992.0)); //高53位，[0, 1)
+		}
+	};
+
 	struct Ball {
 		Vector mPos;
 		Vector mVel;
@@ -62,6 +85,10 @@ public:
 		    return Polar2Vector( drand( 0.0, ServerParam::instance().ballRand() * mVel.Mod() ), drand( -180.0, 180.0 ) );
 		}
 
+		Vector noise(Random & random) const {
+		    return Polar2Vector( random.Uniform( 0.0, ServerParam::instance().ballRand() * mVel.Mod() ), random.Uniform( -180.0, 180.0 ) );
+		}
+
 		void Step() {
 			mPos += mVel;
 			mVel *= ServerParam::instance().ballDecay();
@@ -72,6 +99,12 @@ public:
 			mPos += mVel;
 			mVel *= ServerParam::instance().ballDecay();
 		}
+
+		void RandomizedStep(Random & random) {
+			mVel += noise(random);
+			mPos += mVel;
+			mVel *= ServerParam::instance().ballDecay();
+		}
 	};
 
 	struct Player {
@@ -83,6 +116,7 @@ public:
 		double mEffort;
 
 		int mPlayerType;
+		const PlayerTypeProfile * mpProfile;
 
 	public:
 		Player(const PlayerState & player):
@@ -91,7 +125,8 @@ public:
 			mBodyDir(player.GetBodyDir()),
 			mStamina(player.GetStamina()),
 			mEffort(player.GetEffort()),
-			mPlayerType(player.GetPlayerType())
+			mPlayerType(player.GetPlayerType()),
+			mpProfile(& PlayerParam::instance().Profile(mPlayerType))
 		{
 		}
 
@@ -101,7 +136,8 @@ public:
 			mBodyDir(body_dir),
 			mStamina(stamina),
 			mEffort(effort),
-			mPlayerType(player_type)
+			mPlayerType(player_type),
+			mpProfile(& PlayerParam::instance().Profile(mPlayerType))
 		{
 		}
 
@@ -122,14 +158,20 @@ public:
 
 		void Dash(double power, int dir_idx);
 
+		/** dir为相对身体的dash方向，dir_rate为该方向的加速度系数，不限于Dasher的8个方向 */
+		void Dash(double power, const AngleDeg & dir, double dir_rate);
+
+		/** 贪心地追向target：与身体方向的偏差超过turn_buffer就转身，否则全力向前dash */
+		void Chase(const Vector & target, const AngleDeg & turn_buffer);
+
 		void Turn(const AngleDeg & moment) {
-	        mBodyDir = GetNormalizeAngleDeg( mBodyDir + GetNormalizeMoment( moment ) / ( 1.0 + PlayerParam::instance().HeteroPlayer(mPlayerType).inertiaMoment() * mVel.Mod() ) );
+	        mBodyDir = GetNormalizeAngleDeg( mBodyDir + GetNormalizeMoment( moment ) / ( 1.0 + mpProfile->mInertiaMoment * mVel.Mod() ) );
 	        Step();
 		}
 
 		void Step() {
 			mPos += mVel;
-			mVel *= PlayerParam::instance().HeteroPlayer(mPlayerType).playerDecay();
+			mVel *= mpProfile->mPlayerDecay;
 
 			UpdateStamina();
 		}
@@ -138,7 +180,7 @@ public:
 		void Radomize() {
 			const double x = drand48() * ServerParam::instance().PITCH_LENGTH - ServerParam::instance().PITCH_LENGTH * 0.5;
 			const double y = drand48() * ServerParam::instance().PITCH_WIDTH - ServerParam::instance().PITCH_WIDTH * 0.5;
-			const double speed = drand48() * PlayerParam::instance().HeteroPlayer(mPlayerType).effectiveSpeedMax() * PlayerParam::instance().HeteroPlayer(mPlayerType).playerDecay();
+			const double speed = drand48() * mpProfile->mEffectiveSpeedMax * mpProfile->mPlayerDecay;
 			const AngleDeg speed_dir = GetNormalizeAngleDeg(360.0 * drand48());
 			const AngleDeg body_dir = GetNormalizeAngleDeg(360.0 * drand48());
 
@@ -162,25 +204,25 @@ public:
 	private:
 		void UpdateStamina() {
 		    if ( mStamina <= ServerParam::instance().effortDecThr() * ServerParam::instance().staminaMax() )  {
-		        if ( mEffort > PlayerParam::instance().HeteroPlayer(mPlayerType).effortMin() )  {
+		        if ( mEffort > mpProfile->mEffortMin )  {
 		        	mEffort -= ServerParam::instance().effortDec();
 		        }
 
-		        if ( mEffort < PlayerParam::instance().HeteroPlayer(mPlayerType).effortMin() ) {
-		        	mEffort = PlayerParam::instance().HeteroPlayer(mPlayerType).effortMin();
+		        if ( mEffort < mpProfile->mEffortMin ) {
+		        	mEffort = mpProfile->mEffortMin;
 		        }
 		    }
 
 		    if ( mStamina >= ServerParam::instance().effortIncThr() * ServerParam::instance().staminaMax() )  {
-		        if ( mEffort < PlayerParam::instance().HeteroPlayer(mPlayerType).effortMax() ) {
+		        if ( mEffort < mpProfile->mEffortMax ) {
 		        	mEffort += ServerParam::instance().effortInc();
-		            if ( mEffort > PlayerParam::instance().HeteroPlayer(mPlayerType).effortMax() ) {
-		            	mEffort = PlayerParam::instance().HeteroPlayer(mPlayerType).effortMax();
+		            if ( mEffort > mpProfile->mEffortMax ) {
+		            	mEffort = mpProfile->mEffortMax;
 		            }
 		        }
 		    }
 
-			double stamina_inc = Min( PlayerParam::instance().HeteroPlayer(mPlayerType).staminaIncMax(), ServerParam::instance().staminaMax() - mStamina );
+			double stamina_inc = Min( mpProfile->mStaminaIncMax, ServerParam::instance().staminaMax() - mStamina );
 			mStamina += stamina_inc;
 
 			if (mStamina > ServerParam::instance().staminaMax()) {
@@ -188,6 +230,93 @@ public:
 			}
 		}
 	};
+
+	/**
+	 * K个球的假设，按结构数组存放，每一步对所有假设做同样的运算，循环里没有分支和函数调用，便于编译器向量化
+	 */
+	struct BallBatch {
+		std::vector<double> mPosX;
+		std::vector<double> mPosY;
+		std::vector<double> mVelX;
+		std::vector<double> mVelY;
+
+		double mDecay;
+		double mRand;
+
+	public:
+		BallBatch(): mDecay(0.0), mRand(0.0) { }
+		BallBatch(const Vector & pos, const Vector & vel, int size) { Assign(pos, vel, size); }
+
+		/** 所有假设都设为同一个状态，容量够时不重新分配 */
+		void Assign(const Vector & pos, const Vector & vel, int size);
+
+		int Size() const { return mPosX.size(); }
+		Vector GetPos(int k) const { return Vector(mPosX[k], mPosY[k]); }
+
+		void Step();
+
+		/** 噪声的方向从预先算好的单位向量表里取，不调用三角函数 */
+		void RandomizedStep(Random & random);
+	};
+
+	/**
+	 * 同一个球员的K个假设，按结构数组存放；异构参数和服务器参数在Assign时取出，每一步不再查表
+	 */
+	struct PlayerBatch {
+		std::vector<double> mPosX;
+		std::vector<double> mPosY;
+		std::vector<double> mVelX;
+		std::vector<double> mVelY;
+		std::vector<double> mBodyDir;
+		std::vector<double> mStamina;
+		std::vector<double> mEffort;
+
+	public:
+		PlayerBatch() { } //Assign之后才能用
+		PlayerBatch(const Player & player, int size) { Assign(player, size); }
+
+		void Assign(const Player & player, int size);
+
+		int Size() const { return mPosX.size(); }
+		Vector GetPos(int k) const { return Vector(mPosX[k], mPosY[k]); }
+
+		void Step();
+
+		/** 所有假设都以power向身体方向dash */
+		void Dash(double power);
+
+		/**
+		 * 每个假设贪心地追向自己的目标点，与Player::Chase相同
+		 * 每个假设要算方向（ATan2/Cos/Sin）并按转身还是dash分支，不能向量化，省下的只是逐个模拟时的查表和函数调用
+		 */
+		void Chase(const double * target_x, const double * target_y, const AngleDeg & turn_buffer);
+
+	private:
+		void UpdateStamina();
+
+	private:
+		double mDecay;
+		double mInertiaMoment;
+		double mDashPowerRate;
+		double mForwardDirRate;
+		double mExtraStamina;
+		double mEffortMin;
+		double mEffortMax;
+		double mStaminaIncMax;
+
+		double mStaminaMax;
+		double mEffortDecStamina; // effort_dec_thr * stamina_max
+		double mEffortIncStamina; // effort_inc_thr * stamina_max
+		double mEffortDec;
+		double mEffortInc;
+		double mMinMoment;
+		double mMaxMoment;
+		double mMaxDashPower;
+	};
+
+#ifdef __SIMULATOR_BENCHMARK
+	static void BenchmarkBatch();
+#endif
 };
 
 #endif /* SIMULATOR_H_ */
@@ -0,0 +1,1413 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file StandInServer.cpp
+ * @brief 替身server（StandInServer）实现
+ *
+ * 每个周期的顺序与 rcssserver 一致：先执行上一周期收到的命令（踢球、铲球、扑球先作用到球上，
+ * 再让球员和球各走一步），然后裁判判罚，最后给每个球员发 sense_body、hear、see 和 think。
+ * 开球前和中场休息时间不走，按 sim_step 实时推进，客户端据此递增停顿周期 S。
+ */
+
+#include "StandInServer.h"
+#include "ActionEffector.h"
+#include "PlayerParam.h"
+#include "ServerParam.h"
+#include "Utilities.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char SIDE_CHAR[2] = { 'l', 'r' };
+
+struct Flag {
+	std::string mName;
+	Vector mPos;
+	bool mIsGoal;
+
+	Flag(const std::string & name, const Vector & pos): mName(name), mPos(pos), mIsGoal(name[0] == 'g') { }
+};
+
+/**
+ * see 里的球门和标志，名字按 rcssserver，位置与 Observer::InitializeFlags 一致
+ */
+const std::vector<Flag> & GetFlags()
+{
+	static std::vector<Flag> flags;
+
+	if (flags.empty()) {
+		const double l = ServerParam::PITCH_LENGTH * 0.5;
+		const double w = ServerParam::PITCH_WIDTH * 0.5;
+		const double m = ServerParam::PITCH_MARGIN;
+		const double pl = ServerParam::PENALTY_AREA_LENGTH;
+		const double pw = ServerParam::PENALTY_AREA_WIDTH * 0.5;
+		const double g = ServerParam::instance().goalWidth() * 0.5;
+
+		flags.push_back(Flag("g l", Vector(-l, 0.0)));
+		flags.push_back(Flag("g r", Vector(l, 0.0)));
+		flags.push_back(Flag("f c", Vector(0.0, 0.0)));
+		flags.push_back(Flag("f c t", Vector(0.0, -w)));
+		flags.push_back(Flag("f c b", Vector(0.0, w)));
+		flags.push_back(Flag("f l t", Vector(-l, -w)));
+		flags.push_back(Flag("f l b", Vector(-l, w)));
+		flags.push_back(Flag("f r t", Vector(l, -w)));
+		flags.push_back(Flag("f r b", Vector(l, w)));
+		flags.push_back(Flag("f p l t", Vector(-l + pl, -pw)));
+		flags.push_back(Flag("f p l c", Vector(-l + pl, 0.0)));
+		flags.push_back(Flag("f p l b", Vector(-l + pl, pw)));
+		flags.push_back(Flag("f p r t", Vector(l - pl, -pw)));
+		flags.push_back(Flag("f p r c", Vector(l - pl, 0.0)));
+		flags.push_back(Flag("f p r b", Vector(l - pl, pw)));
+		flags.push_back(Flag("f g l t", Vector(-l, -g)));
+		flags.push_back(Flag("f g l b", Vector(-l, g)));
+		flags.push_back(Flag("f g r t", Vector(l, -g)));
+		flags.push_back(Flag("f g r b", Vector(l, g)));
+
+		char name[16];
+		for (int x = -50; x <= 50; x += 10) {
+			if (x == 0) {
+				flags.push_back(Flag("f t 0", Vector(0.0, -w - m)));
+				flags.push_back(Flag("f b 0", Vector(0.0, w + m)));
+			}
+			else {
+				sprintf(name, "f t %c %d", x < 0? 'l': 'r', abs(x));
+				flags.push_back(Flag(name, Vector(x, -w - m)));
+				sprintf(name, "f b %c %d", x < 0? 'l': 'r', abs(x));
+				flags.push_back(Flag(name, Vector(x, w + m)));
+			}
+		}
+		for (int y = -30; y <= 30; y += 10) {
+			if (y == 0) {
+				flags.push_back(Flag("f l 0", Vector(-l - m, 0.0)));
+				flags.push_back(Flag("f r 0", Vector(l + m, 0.0)));
+			}
+			else {
+				sprintf(name, "f l %c %d", y < 0? 't': 'b', abs(y));
+				flags.push_back(Flag(name, Vector(-l - m, y)));
+				sprintf(name, "f r %c %d", y < 0? 't': 'b', abs(y));
+				flags.push_back(Flag(name, Vector(l + m, y)));
+			}
+		}
+	}
+
+	return flags;
+}
+
+/**
+ * 视线（脸的朝向）与某条边线的交点，不相交或交点在边线之外返回 false
+ * 边线的外法向 normal 为 0（右）、180（左）、-90（上）、90（下），与 LineObserver 的全局位置方向一致
+ */
+bool SeeLine(const Vector & pos, const AngleDeg & face, const AngleDeg & normal, double & dist, AngleDeg & dir)
+{
+	const double l = ServerParam::PITCH_LENGTH * 0.5;
+	const double w = ServerParam::PITCH_WIDTH * 0.5;
+	const bool vertical = fabs(Cos(normal)) > 0.5; // 左右边线
+	const double c = Cos(face);
+	const double s = Sin(face);
+	const double speed = vertical? c: s; // 视线沿法向的分量
+	if (fabs(speed) < FLOAT_EPS) {
+		return false;
+	}
+
+	const double t = vertical? (Sign(Cos(normal)) * l - pos.X()) / c: (Sign(Sin(normal)) * w - pos.Y()) / s;
+	if (t <= 0.0) {
+		return false;
+	}
+
+	const double along = vertical? pos.Y() + t * s: pos.X() + t * c;
+	if (fabs(along) > (vertical? w: l)) {
+		return false;
+	}
+
+	AngleDeg rel = GetNormalizeAngleDeg(normal - face); // 线没有方向，按 rcssserver 折到 (-90, 90]
+	if (rel > 90.0) {
+		rel -= 180.0;
+	}
+	else if (rel <= -90.0) {
+		rel += 180.0;
+	}
+
+	dist = t;
+	dir = rel >= 0.0? rel - 90.0: rel + 90.0; // WorldStateUpdater::ComputeSelfDir 的逆
+	return true;
+}
+
+/** rcssserver 的距离量化：先在对数上量化，再保留一位小数 */
+double QuantizeDist(const double & dist, const double & q)
+{
+	return Quantize(exp(Quantize(log(dist + 1.0e-10), q)), 0.1);
+}
+
+/** 定位球由哪一方来踢，不是定位球返回 -1 */
+int SetPieceSide(ServerPlayMode spm)
+{
+	switch (spm) {
+	case SPM_KickOff_Left: case SPM_KickIn_Left: case SPM_FreeKick_Left:
+	case SPM_CornerKick_Left: case SPM_GoalKick_Left:
+		return 0;
+	case SPM_KickOff_Right: case SPM_KickIn_Right: case SPM_FreeKick_Right:
+	case SPM_CornerKick_Right: case SPM_GoalKick_Right:
+		return 1;
+	default:
+		return -1;
+	}
+}
+
+bool InPenaltyArea(int side, const Vector & pos)
+{
+	const double x = side == 0? pos.X(): -pos.X();
+	return x <= -ServerParam::PITCH_LENGTH * 0.5 + ServerParam::PENALTY_AREA_LENGTH &&
+			fabs(pos.Y()) <= ServerParam::PENALTY_AREA_WIDTH * 0.5;
+}
+
+const char * ViewWidthString(ViewWidth view_width)
+{
+	switch (view_width) {
+	case VW_Narrow: return "narrow";
+	case VW_Wide: return "wide";
+	default: return "normal";
+	}
+}
+
+}
+
+StandInServer::Client::Client(int side, Unum unum, bool goalie):
+	mSide(side),
+	mUnum(unum),
+	mIsGoalie(goalie),
+	mIsAlive(true),
+	mPlayer(Vector((side == 0? -3.0: 3.0) * unum, -ServerParam::PITCH_WIDTH * 0.5 - 3.0), Vector(0.0, 0.0),
+			side == 0? 0.0: 180.0, 0, int(ServerParam::instance().staminaMax())), // 与 rcssserver 一样先站在场外
+	mNeckDir(0.0),
+	mViewWidth(VW_Normal),
+	mSightWait(0),
+	mFocusSide('?'),
+	mFocusUnum(0),
+	mTackleExpires(0),
+	mCatchBan(0),
+	mBodyCommand(BC_None),
+	mFoul(false),
+	mHasTurnNeck(false),
+	mTurnNeck(0.0),
+	mHasChangeView(false),
+	mNewViewWidth(VW_Normal),
+	mDone(false)
+{
+#ifndef WIN32
+	memset(& mAddress, 0, sizeof(mAddress));
+#endif
+	for (int i = 0; i < CC_Max; ++i) {
+		mCount[i] = 0;
+	}
+	mBodyParam[0] = mBodyParam[1] = 0.0;
+}
+
+StandInServer::StandInServer():
+#ifndef WIN32
+	mSockfd(-1),
+#endif
+	mTime(0),
+	mStoppedTime(0),
+	mPlayMode(SPM_BeforeKickOff),
+	mModeTime(0),
+	mHalfEnded(0),
+	mKickOffSide(0),
+	mWaitCycles(0),
+	mLastTouchSide(-1),
+	mKickedSide(-1),
+	mpCatcher(0),
+	mGoalieMoves(0),
+	mBall(Vector(0.0, 0.0), Vector(0.0, 0.0)),
+	mRandom(PlayerParam::instance().StandInSeed() != 0? PlayerParam::instance().StandInSeed(): time(0)),
+	mPlayCycles(0),
+	mThinkTimeouts(0),
+	mPlayUsec(0)
+{
+	mScore[0] = mScore[1] = 0;
+}
+
+StandInServer::~StandInServer()
+{
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		delete mClients[i];
+	}
+}
+
+StandInServer & StandInServer::instance()
+{
+	static StandInServer stand_in_server;
+	return stand_in_server;
+}
+
+#ifndef WIN32
+
+void StandInServer::Run()
+{
+	if (!OpenSocket()) {
+		return;
+	}
+
+	GeneratePlayerTypes();
+	OpenGameLog();
+
+	std::cout << "stand-in server on port " << ServerParam::instance().playerPort() << ", waiting for "
+			<< PlayerParam::instance().StandInPlayers() << " players" << std::endl;
+
+	RealTime cycle_start = GetRealTime();
+
+	while (mPlayMode != SPM_TimeOver) {
+		if (IsStopped()) {
+			// 时间不走，按 sim_step 实时推进，客户端靠实际时间判断停顿周期
+			RealTime deadline = cycle_start + ServerParam::instance().simStep();
+			for (;;) {
+				RealTime now = GetRealTime();
+				int left = deadline - now;
+				if (left <= 0) break;
+				Receive(left);
+			}
+			cycle_start = deadline;
+
+			ExecuteCommands();
+			++mStoppedTime;
+			Referee();
+		}
+		else {
+			RealTime start = GetRealTime();
+			WaitForCommands();
+			ExecuteCommands();
+			++mTime;
+			mStoppedTime = 0;
+			Referee();
+
+			RealTime end = GetRealTime();
+			mPlayUsec += end.Sub(start);
+			++mPlayCycles;
+			cycle_start = end;
+		}
+
+		WriteShow();
+		SendSensors();
+	}
+
+	RealTime deadline = GetRealTime();
+	deadline = deadline + int(BYE_WAIT);
+	while (AliveCount() > 0) {
+		RealTime now = GetRealTime();
+		int left = deadline - now;
+		if (left <= 0) break;
+		Receive(left);
+	}
+
+	CloseGameLog();
+	WriteStats();
+	CloseSocket();
+}
+
+bool StandInServer::OpenSocket()
+{
+	if ((mSockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+		PRINT_ERROR("Can't create socket");
+		return false;
+	}
+
+	sockaddr_in address;
+	memset(& address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(ServerParam::instance().playerPort());
+
+	if (bind(mSockfd, (sockaddr *) & address, sizeof(address)) < 0) {
+		PRINT_ERROR("Can't bind stand-in server to port " << ServerParam::instance().playerPort());
+		close(mSockfd);
+		mSockfd = -1;
+		return false;
+	}
+
+	return true;
+}
+
+void StandInServer::CloseSocket()
+{
+	if (mSockfd >= 0) {
+		close(mSockfd);
+		mSockfd = -1;
+	}
+}
+
+bool StandInServer::Receive(int timeout_ms)
+{
+	fd_set fds;
+	FD_ZERO(& fds);
+	FD_SET(mSockfd, & fds);
+
+	timeval timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_usec = (timeout_ms % 1000) * 1000;
+
+	if (select(mSockfd + 1, & fds, 0, 0, & timeout) <= 0) {
+		return false;
+	}
+
+	char msg[MAX_MESSAGE + 1];
+	socklen_t address_len = sizeof(mFrom);
+	int n = recvfrom(mSockfd, msg, MAX_MESSAGE, 0, (sockaddr *) & mFrom, & address_len);
+	if (n <= 0) {
+		return false;
+	}
+	msg[n] = '\0';
+
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Client & client = *mClients[i];
+		if (client.mAddress.sin_addr.s_addr == mFrom.sin_addr.s_addr && client.mAddress.sin_port == mFrom.sin_port) {
+			if (client.mIsAlive) {
+				ParseCommand(client, msg);
+			}
+			return true;
+		}
+	}
+
+	if (strncmp(msg, "(init", 5) == 0) {
+		ParseInit(msg);
+	}
+	return true;
+}
+
+void StandInServer::Send(const Client & client, const std::string & msg)
+{
+	sendto(mSockfd, msg.c_str(), msg.size() + 1, 0, (const sockaddr *) & client.mAddress, sizeof(client.mAddress));
+}
+
+void StandInServer::Reply(const std::string & msg)
+{
+	sendto(mSockfd, msg.c_str(), msg.size() + 1, 0, (const sockaddr *) & mFrom, sizeof(mFrom));
+}
+
+/**
+ * (init TEAM (version V) [(goalie)])，第一个队在左边，号码按连接顺序分配
+ */
+void StandInServer::ParseInit(const char *msg)
+{
+	char team_name[64];
+	if (sscanf(msg, "(init %63[^ ()]", team_name) != 1) { // 教练和trainer不支持
+		Reply("(error illegal_command_form)");
+		return;
+	}
+
+	int side = 0;
+	while (side < 2 && !mTeamName[side].empty() && mTeamName[side] != team_name) {
+		++side;
+	}
+
+	int players = 0;
+	for (unsigned i = 0; side < 2 && i < mClients.size(); ++i) {
+		players += mClients[i]->mSide == side? 1: 0;
+	}
+
+	if (side == 2 || players >= TEAMSIZE) {
+		Reply("(error no_more_team_or_player_or_goalie)");
+		return;
+	}
+
+	mTeamName[side] = team_name;
+
+	Client *client = new Client(side, players + 1, strstr(msg, "(goalie)") != 0);
+	client->mAddress = mFrom;
+	mClients.push_back(client);
+
+	std::ostringstream init;
+	init << "(init " << SIDE_CHAR[side] << " " << client->mUnum << " "
+			<< ServerPlayModeMap::instance().GetPlayModeString(mPlayMode) << ")";
+	Send(*client, init.str());
+	SendParams(*client);
+}
+
+void StandInServer::SetBodyCommand(Client & client, BodyCommandType type, double param0, double param1, CommandCount count)
+{
+	if (client.mBodyCommand != BC_None) { // 一个周期只执行第一个身体动作
+		return;
+	}
+
+	client.mBodyCommand = type;
+	client.mBodyParam[0] = param0;
+	client.mBodyParam[1] = param1;
+	++client.mCount[count];
+}
+
+/**
+ * 一个包里可以有多条命令，按括号配对逐条处理；say 的内容里可能有括号，引号里的不算
+ */
+void StandInServer::ParseCommand(Client & client, const char *msg)
+{
+	const char *p = strchr(msg, '(');
+
+	while (p != 0) {
+		const char *end = p;
+		int depth = 0;
+		bool quoted = false;
+		for (; *end; ++end) {
+			if (*end == '"') quoted = !quoted;
+			else if (quoted) continue;
+			else if (*end == '(') ++depth;
+			else if (*end == ')' && --depth == 0) break;
+		}
+
+		const std::string cmd(p + 1, end);
+		p = *end? strchr(end + 1, '('): 0;
+
+		char name[32];
+		if (sscanf(cmd.c_str(), "%31[a-z_]", name) != 1) {
+			continue;
+		}
+		const char *args = cmd.c_str() + strlen(name);
+		double a = 0.0;
+		double b = 0.0;
+		const int n = sscanf(args, "%lf %lf", & a, & b);
+
+		if (!strcmp(name, "dash")) {
+			SetBodyCommand(client, BC_Dash, a, n > 1? b: 0.0, CC_Dash);
+		}
+		else if (!strcmp(name, "turn")) {
+			SetBodyCommand(client, BC_Turn, a, 0.0, CC_Turn);
+		}
+		else if (!strcmp(name, "kick")) {
+			SetBodyCommand(client, BC_Kick, a, b, CC_Kick);
+		}
+		else if (!strcmp(name, "tackle")) {
+			if (client.mBodyCommand == BC_None) {
+				client.mFoul = strstr(args, "on") != 0 || strstr(args, "true") != 0;
+			}
+			SetBodyCommand(client, BC_Tackle, a, 0.0, CC_Tackle);
+		}
+		else if (!strcmp(name, "catch")) {
+			SetBodyCommand(client, BC_Catch, a, 0.0, CC_Catch);
+		}
+		else if (!strcmp(name, "move")) {
+			SetBodyCommand(client, BC_Move, a, b, CC_Move);
+		}
+		else if (!strcmp(name, "turn_neck")) {
+			if (!client.mHasTurnNeck) {
+				client.mHasTurnNeck = true;
+				client.mTurnNeck = a;
+				++client.mCount[CC_TurnNeck];
+			}
+		}
+		else if (!strcmp(name, "change_view")) {
+			char width[16];
+			if (!client.mHasChangeView && sscanf(args, " %15[a-z]", width) == 1) {
+				client.mHasChangeView = true;
+				client.mNewViewWidth = !strcmp(width, "narrow")? VW_Narrow: !strcmp(width, "wide")? VW_Wide: VW_Normal;
+				++client.mCount[CC_ChangeView];
+			}
+		}
+		else if (!strcmp(name, "say")) {
+			std::string say(args);
+			std::string::size_type first = say.find_first_not_of(" \"");
+			std::string::size_type last = say.find_last_not_of(" \"");
+			say = first == std::string::npos? std::string(): say.substr(first, last - first + 1);
+			if (client.mSay.empty() && !say.empty()) {
+				client.mSay = say.substr(0, ServerParam::instance().sayMsgSize());
+				++client.mCount[CC_Say];
+			}
+		}
+		else if (!strcmp(name, "pointto")) {
+			++client.mCount[CC_PointTo]; // 不模拟手臂
+		}
+		else if (!strcmp(name, "attentionto")) {
+			char team[8];
+			int unum = 0;
+			if (sscanf(args, " %7[a-z] %d", team, & unum) == 2 && unum >= 1 && unum <= TEAMSIZE) {
+				client.mFocusSide = SIDE_CHAR[!strcmp(team, "our")? client.mSide: 1 - client.mSide];
+				client.mFocusUnum = unum;
+			}
+			else {
+				client.mFocusSide = '?';
+				client.mFocusUnum = 0;
+			}
+			++client.mCount[CC_AttentionTo];
+		}
+		else if (!strcmp(name, "done")) {
+			client.mDone = true;
+		}
+		else if (!strcmp(name, "bye")) {
+			client.mIsAlive = false;
+		}
+		else if (!strcmp(name, "synch_see")) {
+			Send(client, "(ok synch_see)");
+		}
+		else if (!strcmp(name, "clang")) {
+			int min_ver = 7;
+			int max_ver = 8;
+			sscanf(args, " (ver %d %d)", & min_ver, & max_ver);
+			std::ostringstream ok;
+			ok << "(ok clang (ver " << min_ver << " " << max_ver << "))";
+			Send(client, ok.str());
+		}
+		else if (!strcmp(name, "ear")) {
+			Send(client, strstr(args, "off")? "(ok ear off)": "(ok ear on)");
+		}
+		else if (!strcmp(name, "sense_body")) {
+			Send(client, SenseBody(client));
+		}
+		else if (!strcmp(name, "score")) {
+			std::ostringstream score;
+			score << "(score " << mTime << " " << mScore[client.mSide] << " " << mScore[1 - client.mSide] << ")";
+			Send(client, score.str());
+		}
+		else if (strcmp(name, "compression") && strcmp(name, "eye")) {
+			Send(client, "(error unknown_command)");
+		}
+	}
+}
+
+/**
+ * 异构球员按 rcssserver 的公式生成：各项在 [delta_min, delta_max] 里均匀取，相关的项按 delta_factor 联动。
+ * 生成的 (player_type ...) 同时交给本进程的 PlayerParam，保证这里的模型和客户端收到的参数一致
+ */
+void StandInServer::GeneratePlayerTypes()
+{
+	const ServerParam & sp = ServerParam::instance();
+	PlayerParam & pp = PlayerParam::instance();
+
+	std::ostringstream server_param;
+	server_param << "(server_param ";
+	ServerParam::instance().DumpServerMsg(server_param);
+	server_param << ")";
+	mParamMsgs.push_back(server_param.str());
+
+	static const char *player_param_names[] = {
+		"player_types", "subs_max", "pt_max", "allow_mult_default_type",
+		"player_speed_max_delta_min", "player_speed_max_delta_max", "stamina_inc_max_delta_factor",
+		"player_decay_delta_min", "player_decay_delta_max", "inertia_moment_delta_factor",
+		"dash_power_rate_delta_min", "dash_power_rate_delta_max", "player_size_delta_factor",
+		"kickable_margin_delta_min", "kickable_margin_delta_max", "kick_rand_delta_factor",
+		"extra_stamina_delta_min", "extra_stamina_delta_max", "effort_max_delta_factor", "effort_min_delta_factor",
+		"new_dash_power_rate_delta_min", "new_dash_power_rate_delta_max", "new_stamina_inc_max_delta_factor",
+		"kick_power_rate_delta_min", "kick_power_rate_delta_max", "foul_detect_probability_delta_factor",
+		"catchable_area_l_stretch_min", "catchable_area_l_stretch_max"
+	};
+
+	std::ostringstream player_param;
+	player_param << "(player_param ";
+	for (unsigned i = 0; i < sizeof(player_param_names) / sizeof(player_param_names[0]); ++i) {
+		pp.PrintServerMsg(player_param_names[i], player_param);
+	}
+	player_param << ")";
+	mParamMsgs.push_back(player_param.str());
+
+	for (int type = 0; type < pp.playerTypes(); ++type) {
+		double speed_delta = 0.0;
+		double decay_delta = 0.0;
+		double dash_delta = 0.0;
+		double margin_delta = 0.0;
+		double stamina_delta = 0.0;
+		double kick_power_delta = 0.0;
+		double stretch = 1.0;
+
+		if (type > 0) { // 0号是默认球员
+			speed_delta = mRandom.Uniform(pp.playerSpeedMaxDeltaMin(), pp.playerSpeedMaxDeltaMax());
+			decay_delta = mRandom.Uniform(pp.playerDecayDeltaMin(), pp.playerDecayDeltaMax());
+			dash_delta = mRandom.Uniform(pp.newDashPowerRateDeltaMin(), pp.newDashPowerRateDeltaMax());
+			margin_delta = mRandom.Uniform(pp.kickableMarginDeltaMin(), pp.kickableMarginDeltaMax());
+			stamina_delta = mRandom.Uniform(pp.extraStaminaDeltaMin(), pp.extraStaminaDeltaMax());
+			kick_power_delta = mRandom.Uniform(pp.kickPowerRateDeltaMin(), pp.kickPowerRateDeltaMax());
+			stretch = mRandom.Uniform(pp.catchableAreaLStretchMin(), pp.catchableAreaLStretchMax());
+		}
+
+		std::ostringstream line;
+		line << "(id " << type << ")"
+				<< "(player_speed_max " << sp.playerSpeedMax() + speed_delta << ")"
+				<< "(stamina_inc_max " << sp.staminaInc() + dash_delta * pp.newStaminaIncMaxDeltaFactor() << ")"
+				<< "(player_decay " << sp.playerDecay() + decay_delta << ")"
+				<< "(inertia_moment " << sp.inertiaMoment() + decay_delta * pp.inertiaMomentDeltaFactor() << ")"
+				<< "(dash_power_rate " << sp.dashPowerRate() + dash_delta << ")"
+				<< "(player_size " << sp.playerSize() << ")"
+				<< "(kickable_margin " << sp.kickableMargin() + margin_delta << ")"
+				<< "(kick_rand " << sp.kickRand() + margin_delta * pp.kickRandDeltaFactor() << ")"
+				<< "(extra_stamina " << sp.extraStamina() + stamina_delta << ")"
+				<< "(effort_max " << sp.effortInit() + stamina_delta * pp.effortMaxDeltaFactor() << ")"
+				<< "(effort_min " << sp.effortMin() + stamina_delta * pp.effortMinDeltaFactor() << ")"
+				<< "(kick_power_rate " << sp.kickPowerRate() + kick_power_delta << ")"
+				<< "(foul_detect_probability " << sp.foulDetectProbability() + kick_power_delta * pp.foulDetectProbabilityDeltaFactor() << ")"
+				<< "(catchable_area_l_stretch " << stretch << ")";
+
+		pp.AddPlayerType(type, line.str().c_str());
+		mParamMsgs.push_back("(player_type " + line.str() + ")");
+	}
+}
+
+void StandInServer::SendParams(const Client & client)
+{
+	for (unsigned i = 0; i < mParamMsgs.size(); ++i) {
+		Send(client, mParamMsgs[i]);
+	}
+}
+
+void StandInServer::WaitForCommands()
+{
+	if (!ServerParam::instance().synchMode()) {
+		RealTime deadline = GetRealTime();
+		deadline = deadline + ServerParam::instance().simStep();
+		for (;;) {
+			RealTime now = GetRealTime();
+			int left = deadline - now;
+			if (left <= 0) break;
+			Receive(left);
+		}
+		return;
+	}
+
+	RealTime deadline = GetRealTime();
+	deadline = deadline + PlayerParam::instance().StandInThinkTimeout();
+	while (!AllDone()) {
+		RealTime now = GetRealTime();
+		int left = deadline - now;
+		if (left <= 0) {
+			++mThinkTimeouts;
+			break;
+		}
+		Receive(left);
+	}
+}
+
+void StandInServer::ExecuteCommands()
+{
+	const ServerParam & sp = ServerParam::instance();
+	const bool stopped = IsStopped();
+
+	mKickedSide = -1;
+
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Client & client = *mClients[i];
+
+		if (client.mTackleExpires > 0 && client.mBodyCommand != BC_None) { // 铲球之后的几个周期不能动
+			client.mBodyCommand = BC_None;
+		}
+
+		switch (client.mBodyCommand) {
+		case BC_Kick: Kick(client); break;
+		case BC_Tackle: Tackle(client); break;
+		case BC_Catch: Catch(client); break;
+		case BC_Move: Move(client); break;
+		default: break;
+		}
+	}
+
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Client & client = *mClients[i];
+		Simulator::Player & player = client.mPlayer;
+
+		if (stopped) { // 时间不走，只有转身和 move 有效果
+			if (client.mBodyCommand == BC_Turn) {
+				player.mBodyDir = GetNormalizeAngleDeg(player.mBodyDir +
+						GetTurnAngle(client.mBodyParam[0], player.mPlayerType, player.mVel.Mod()));
+			}
+		}
+		else if (client.mBodyCommand == BC_Dash) {
+			AngleDeg dir = GetNormalizeDashAngle(client.mBodyParam[1]);
+			if (sp.dashAngleStep() > FLOAT_EPS) {
+				dir = sp.dashAngleStep() * Rint(dir / sp.dashAngleStep());
+			}
+			player.Dash(client.mBodyParam[0], dir, GetDashDirRate(dir));
+		}
+		else if (client.mBodyCommand == BC_Turn) {
+			player.Turn(client.mBodyParam[0]);
+		}
+		else {
+			player.Step();
+		}
+
+		if (client.mHasTurnNeck) {
+			client.mNeckDir = GetNormalizeNeckAngle(client.mNeckDir + GetNormalizeNeckMoment(client.mTurnNeck));
+		}
+		if (client.mHasChangeView) {
+			client.mViewWidth = client.mNewViewWidth;
+		}
+		if (!client.mSay.empty()) {
+			mSays.push_back(std::make_pair(& client, client.mSay));
+		}
+
+		if (!stopped) {
+			client.mTackleExpires = Max(client.mTackleExpires - 1, 0);
+			client.mCatchBan = Max(client.mCatchBan - 1, 0);
+		}
+
+		client.mBodyCommand = BC_None;
+		client.mHasTurnNeck = false;
+		client.mHasChangeView = false;
+		client.mSay.clear();
+	}
+
+	if (!stopped) {
+		StepBall();
+	}
+
+	if (mpCatcher != 0) { // 守门员抱着球，球跟着守门员
+		mBall.mPos = mpCatcher->mPlayer.mPos +
+				Polar2Vector(mpCatcher->mPlayer.mpProfile->mKickDistOffset, mpCatcher->mPlayer.mBodyDir);
+		mBall.mVel = Vector(0.0, 0.0);
+	}
+}
+
+void StandInServer::Kick(Client & client)
+{
+	if (!CanKick(client.mSide)) {
+		return;
+	}
+
+	const Simulator::Player & player = client.mPlayer;
+	const Vector ball_2_player = (mBall.mPos - player.mPos).Rotate(-player.mBodyDir);
+	if (ball_2_player.Mod() > player.mpProfile->mKickableArea) {
+		return;
+	}
+
+	const double power = GetNormalizeKickPower(client.mBodyParam[0]);
+	const AngleDeg dir = GetNormalizeMoment(client.mBodyParam[1]);
+	const double accel = Min(GetKickRate(ball_2_player, player.mPlayerType) * power, ServerParam::instance().ballAccelMax());
+	const double max_rand = GetMaxKickRand(ball_2_player, mBall.mVel, player.mPlayerType, power);
+
+	mBall.mVel += Polar2Vector(accel, player.mBodyDir + dir) +
+			Vector(mRandom.Uniform(-max_rand, max_rand), mRandom.Uniform(-max_rand, max_rand));
+
+	mLastTouchSide = client.mSide;
+	mKickedSide = client.mSide;
+	mpCatcher = 0;
+}
+
+void StandInServer::Tackle(Client & client)
+{
+	const ServerParam & sp = ServerParam::instance();
+
+	if (mPlayMode != SPM_PlayOn) {
+		return;
+	}
+
+	const Simulator::Player & player = client.mPlayer;
+	client.mTackleExpires = sp.tackleCycles();
+
+	const double prob = GetTackleProb(mBall.mPos, player.mPos, player.mBodyDir, client.mFoul);
+	if (mRandom.Uniform(0.0, 1.0) >= prob) {
+		return;
+	}
+
+	const AngleDeg dir = GetNormalizeMoment(client.mBodyParam[0]);
+	double power = (sp.maxBackTacklePower() + (sp.maxTacklePower() - sp.maxBackTacklePower()) * (1.0 - fabs(dir) / 180.0)) *
+			sp.tacklePowerRate();
+	power *= 1.0 - 0.5 * fabs(GetNormalizeAngleDeg((mBall.mPos - player.mPos).Dir() - player.mBodyDir)) / 180.0;
+	const double max_rand = GetMaxTackleRand(prob, mBall.mVel, player.mPlayerType);
+
+	mBall.mVel += Polar2Vector(power, player.mBodyDir + dir) +
+			Vector(mRandom.Uniform(-max_rand, max_rand), mRandom.Uniform(-max_rand, max_rand));
+
+	mLastTouchSide = client.mSide;
+	mKickedSide = client.mSide;
+}
+
+void StandInServer::Catch(Client & client)
+{
+	const ServerParam & sp = ServerParam::instance();
+
+	if (!client.mIsGoalie || mPlayMode != SPM_PlayOn || client.mCatchBan > 0 || !InPenaltyArea(client.mSide, mBall.mPos)) {
+		return;
+	}
+
+	const Simulator::Player & player = client.mPlayer;
+	client.mCatchBan = sp.catchBanCycle();
+
+	const double stretch = PlayerParam::instance().HeteroPlayer(player.mPlayerType).catchableAreaLStretch();
+	const Vector ball_2_player = (mBall.mPos - player.mPos).Rotate(-(player.mBodyDir + GetNormalizeMoment(client.mBodyParam[0])));
+	if (ball_2_player.X() < 0.0 || ball_2_player.X() > sp.catchAreaLength() * stretch ||
+			fabs(ball_2_player.Y()) > sp.catchAreaWidth() * 0.5 || mRandom.Uniform(0.0, 1.0) >= sp.catchProb()) {
+		return;
+	}
+
+	mpCatcher = & client;
+	mGoalieMoves = 0;
+	mLastTouchSide = client.mSide;
+	ChangePlayMode(client.mSide == 0? SPM_GoalieCatchBall_Left: SPM_GoalieCatchBall_Right);
+	ChangePlayMode(client.mSide == 0? SPM_FreeKick_Left: SPM_FreeKick_Right);
+}
+
+void StandInServer::Move(Client & client)
+{
+	if (!IsMoveAllowed(client)) {
+		return;
+	}
+
+	if (mpCatcher == & client && ++mGoalieMoves > ServerParam::instance().goalieMaxMoves()) {
+		return;
+	}
+
+	Vector pos(client.mBodyParam[0], client.mBodyParam[1]);
+	if (client.mSide == 1) { // 右边的队用自己的坐标系
+		pos = -pos;
+	}
+
+	if (mpCatcher == & client && !InPenaltyArea(client.mSide, pos)) {
+		return;
+	}
+
+	client.mPlayer.mPos = pos;
+	client.mPlayer.mVel = Vector(0.0, 0.0);
+}
+
+void StandInServer::StepBall()
+{
+	const double speed = mBall.mVel.Mod();
+	if (speed > ServerParam::instance().ballSpeedMax()) {
+		mBall.mVel *= ServerParam::instance().ballSpeedMax() / speed;
+	}
+
+	mBall.RandomizedStep(mRandom);
+}
+
+void StandInServer::Referee()
+{
+	const ServerParam & sp = ServerParam::instance();
+
+	switch (mPlayMode) {
+	case SPM_BeforeKickOff:
+		if (AliveCount() >= PlayerParam::instance().StandInPlayers() &&
+				++mWaitCycles >= PlayerParam::instance().StandInKickOffWait()) {
+			PrepareKickOff(mKickOffSide);
+		}
+		return;
+	case SPM_HalfTime:
+		if (++mWaitCycles >= PlayerParam::instance().StandInKickOffWait()) {
+			PrepareKickOff(mKickOffSide);
+		}
+		return;
+	case SPM_AfterGoal_Left:
+	case SPM_AfterGoal_Right:
+		if (mTime - mModeTime >= AFTER_GOAL_WAIT) {
+			PrepareKickOff(mKickOffSide);
+		}
+		break;
+	default:
+		break;
+	}
+
+	const int set_piece_side = SetPieceSide(mPlayMode);
+	if (set_piece_side >= 0) {
+		if (mPlayMode == SPM_GoalKick_Left || mPlayMode == SPM_GoalKick_Right) {
+			if (!InPenaltyArea(set_piece_side, mBall.mPos)) { // 球到禁区外才算发出
+				ChangePlayMode(SPM_PlayOn);
+			}
+		}
+		else if (mKickedSide == set_piece_side) {
+			ChangePlayMode(SPM_PlayOn);
+		}
+
+		if (mPlayMode != SPM_PlayOn) {
+			if (mTime - mModeTime >= sp.dropTime()) {
+				ChangePlayMode(SPM_Drop_Ball);
+				ChangePlayMode(SPM_PlayOn);
+			}
+			else {
+				ClearPlayers(1 - set_piece_side, mBall.mPos, ServerParam::KICK_OFF_CLEAR_DISTANCE);
+			}
+		}
+	}
+
+	if (mPlayMode == SPM_PlayOn) {
+		CheckBall();
+	}
+
+	if (sp.halfTime() > 0 && mTime > 0 && mTime % sp.halfTime() == 0 && mTime > mHalfEnded) { //本周期模式变了也要结束半场，但只处理一次
+		mHalfEnded = mTime;
+		if (mTime >= sp.halfTime() * sp.nrNormalHalfs()) {
+			ChangePlayMode(SPM_TimeOver);
+		}
+		else {
+			mKickOffSide = 1 - mKickOffSide;
+			ChangePlayMode(SPM_HalfTime);
+		}
+	}
+}
+
+/**
+ * 球出界或进门。side 为球越过的那条底线所属的一方
+ */
+void StandInServer::CheckBall()
+{
+	const double half_length = ServerParam::PITCH_LENGTH * 0.5 + ServerParam::instance().ballSize();
+	const double half_width = ServerParam::PITCH_WIDTH * 0.5 + ServerParam::instance().ballSize();
+	const Vector & pos = mBall.mPos;
+
+	if (fabs(pos.X()) > half_length) {
+		const int side = pos.X() < 0.0? 0: 1;
+		const double sign = side == 0? -1.0: 1.0;
+		const double y_sign = pos.Y() < 0.0? -1.0: 1.0;
+
+		if (fabs(pos.Y()) < ServerParam::instance().goalWidth() * 0.5) {
+			Goal(1 - side);
+		}
+		else if (mLastTouchSide == side) {
+			SetPiece(side == 0? SPM_CornerKick_Right: SPM_CornerKick_Left,
+					Vector(sign * (ServerParam::PITCH_LENGTH * 0.5 - ServerParam::CORNER_KICK_MARGIN),
+							y_sign * (ServerParam::PITCH_WIDTH * 0.5 - ServerParam::CORNER_KICK_MARGIN)));
+		}
+		else {
+			SetPiece(side == 0? SPM_GoalKick_Left: SPM_GoalKick_Right,
+					Vector(sign * (ServerParam::PITCH_LENGTH * 0.5 - ServerParam::GOAL_AREA_LENGTH),
+							y_sign * ServerParam::GOAL_AREA_WIDTH * 0.5));
+		}
+	}
+	else if (fabs(pos.Y()) > half_width) {
+		SetPiece(mLastTouchSide == 0? SPM_KickIn_Right: SPM_KickIn_Left,
+				Vector(MinMax(-ServerParam::PITCH_LENGTH * 0.5, pos.X(), ServerParam::PITCH_LENGTH * 0.5),
+						(pos.Y() < 0.0? -0.5: 0.5) * ServerParam::PITCH_WIDTH));
+	}
+}
+
+void StandInServer::Goal(int side)
+{
+	++mScore[side];
+	mKickOffSide = 1 - side;
+	mBall = Simulator::Ball(Vector(0.0, 0.0), Vector(0.0, 0.0));
+	ChangePlayMode(side == 0? SPM_AfterGoal_Left: SPM_AfterGoal_Right);
+}
+
+void StandInServer::ChangePlayMode(ServerPlayMode spm)
+{
+	mPlayMode = spm;
+	mModeTime = mTime;
+	mWaitCycles = 0;
+
+	if (spm != SPM_GoalieCatchBall_Left && spm != SPM_GoalieCatchBall_Right &&
+			spm != SPM_FreeKick_Left && spm != SPM_FreeKick_Right) {
+		mpCatcher = 0;
+	}
+
+	std::ostringstream msg;
+	msg << ServerPlayModeMap::instance().GetPlayModeString(spm);
+	if (spm == SPM_AfterGoal_Left || spm == SPM_AfterGoal_Right) {
+		msg << "_" << mScore[spm == SPM_AfterGoal_Left? 0: 1];
+	}
+	mRefereeMsgs.push_back(msg.str());
+
+	if (mGameLog.is_open()) {
+		mGameLog << "(playmode " << mTime << " " << msg.str() << ")" << std::endl;
+		if (spm == SPM_AfterGoal_Left || spm == SPM_AfterGoal_Right || spm == SPM_KickOff_Left || spm == SPM_TimeOver) {
+			mGameLog << "(team " << mTime << " " << mTeamName[0] << " " << mTeamName[1] << " "
+					<< mScore[0] << " " << mScore[1] << ")" << std::endl;
+		}
+	}
+}
+
+void StandInServer::SetPiece(ServerPlayMode spm, const Vector & ball_pos)
+{
+	mBall = Simulator::Ball(ball_pos, Vector(0.0, 0.0));
+	ChangePlayMode(spm);
+	ClearPlayers(1 - SetPieceSide(spm), ball_pos, ServerParam::KICK_OFF_CLEAR_DISTANCE);
+}
+
+/**
+ * 把 side 一方离 center 不到 radius 的球员推到圆周上
+ */
+void StandInServer::ClearPlayers(int side, const Vector & center, double radius)
+{
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Simulator::Player & player = mClients[i]->mPlayer;
+		if (mClients[i]->mSide != side || player.mPos.Dist(center) >= radius) {
+			continue;
+		}
+
+		Vector dir = player.mPos - center;
+		if (dir.Mod() < FLOAT_EPS) {
+			dir = Vector(side == 0? -1.0: 1.0, 0.0);
+		}
+		player.mPos = center + dir * (radius / dir.Mod());
+	}
+}
+
+/**
+ * 开球：球放到中点，所有人退回本方半场，防守方退到中圈外
+ */
+void StandInServer::PrepareKickOff(int side)
+{
+	mBall = Simulator::Ball(Vector(0.0, 0.0), Vector(0.0, 0.0));
+
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Simulator::Player & player = mClients[i]->mPlayer;
+		if (mClients[i]->mSide == 0 && player.mPos.X() > 0.0) {
+			player.mPos.SetX(-0.1);
+		}
+		else if (mClients[i]->mSide == 1 && player.mPos.X() < 0.0) {
+			player.mPos.SetX(0.1);
+		}
+	}
+	ClearPlayers(1 - side, mBall.mPos, ServerParam::CENTER_CIRCLE_R);
+
+	ChangePlayMode(side == 0? SPM_KickOff_Left: SPM_KickOff_Right);
+}
+
+bool StandInServer::IsStopped() const
+{
+	return mPlayMode == SPM_BeforeKickOff || mPlayMode == SPM_HalfTime || mPlayMode == SPM_TimeOver;
+}
+
+bool StandInServer::CanKick(int side) const
+{
+	if (mPlayMode == SPM_PlayOn || mPlayMode == SPM_Drop_Ball) {
+		return true;
+	}
+
+	return SetPieceSide(mPlayMode) == side;
+}
+
+bool StandInServer::IsMoveAllowed(const Client & client) const
+{
+	if (IsStopped() || mPlayMode == SPM_AfterGoal_Left || mPlayMode == SPM_AfterGoal_Right) {
+		return true;
+	}
+
+	return mpCatcher == & client;
+}
+
+bool StandInServer::AllDone() const
+{
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		if (mClients[i]->mIsAlive && !mClients[i]->mDone) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int StandInServer::AliveCount() const
+{
+	int count = 0;
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		count += mClients[i]->mIsAlive? 1: 0;
+	}
+	return count;
+}
+
+void StandInServer::SendSensors()
+{
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		Client & client = *mClients[i];
+		if (!client.mIsAlive) {
+			continue;
+		}
+
+		Send(client, SenseBody(client));
+
+		for (unsigned j = 0; j < mRefereeMsgs.size(); ++j) {
+			std::ostringstream hear;
+			hear << "(hear " << mTime << " referee " << mRefereeMsgs[j] << ")";
+			Send(client, hear.str());
+		}
+
+		for (unsigned j = 0; j < mSays.size(); ++j) {
+			const Client & speaker = *mSays[j].first;
+			if (& speaker != & client && speaker.mPlayer.mPos.Dist(client.mPlayer.mPos) <= ServerParam::instance().audioCutDist()) {
+				Send(client, Hear(client, speaker, mSays[j].second));
+			}
+		}
+
+		if (--client.mSightWait <= 0) {
+			Send(client, See(client));
+			client.mSightWait = sight::SightDelay(client.mViewWidth);
+		}
+
+		if (ServerParam::instance().synchMode()) {
+			client.mDone = false;
+			Send(client, "(think)");
+		}
+	}
+
+	mRefereeMsgs.clear();
+	mSays.clear();
+}
+
+std::string StandInServer::SenseBody(const Client & client) const
+{
+	const Simulator::Player & player = client.mPlayer;
+	const int *count = client.mCount;
+
+	std::ostringstream os;
+	os << "(sense_body " << mTime
+			<< " (view_mode high " << ViewWidthString(client.mViewWidth) << ")"
+			<< " (stamina " << player.mStamina << " " << player.mEffort << " " << ServerParam::instance().staminaCapacity() << ")"
+			<< " (speed " << Quantize(player.mVel.Mod(), 0.01) << " " << Rint(GetNormalizeAngleDeg(player.mVel.Dir() - client.FaceDir())) << ")"
+			<< " (head_angle " << Rint(client.mNeckDir) << ")"
+			<< " (kick " << count[CC_Kick] << ") (dash " << count[CC_Dash] << ") (turn " << count[CC_Turn] << ")"
+			<< " (say " << count[CC_Say] << ") (turn_neck " << count[CC_TurnNeck] << ") (catch " << count[CC_Catch] << ")"
+			<< " (move " << count[CC_Move] << ") (change_view " << count[CC_ChangeView] << ")"
+			<< " (arm (movable 0) (expires 0) (target 0 0) (count " << count[CC_PointTo] << "))"
+			<< " (focus (target ";
+	if (client.mFocusSide == '?') {
+		os << "none";
+	}
+	else {
+		os << client.mFocusSide << " " << client.mFocusUnum;
+	}
+	os << ") (count " << count[CC_AttentionTo] << "))"
+			<< " (tackle (expires " << client.mTackleExpires << ") (count " << count[CC_Tackle] << "))"
+			<< " (collision none) (foul (charged 0) (card none)))";
+
+	return os.str();
+}
+
+/**
+ * 视觉按 rcssserver 的规则量化：距离在对数上量化，方向取整；近处带距离和方向的变化量、
+ * 身体和脖子方向，远处逐步丢掉号码和队名；视野外 visible_distance 以内只给大写的类型
+ */
+std::string StandInServer::See(const Client & client)
+{
+	const ServerParam & sp = ServerParam::instance();
+	const Vector & pos = client.mPlayer.mPos;
+	const AngleDeg face = client.FaceDir();
+	const double half_view = sight::ViewAngle(client.mViewWidth) * 0.5;
+
+	std::ostringstream os;
+	os << "(see " << mTime;
+
+	const std::vector<Flag> & flags = GetFlags();
+	for (unsigned i = 0; i < flags.size(); ++i) {
+		const Vector rel = flags[i].mPos - pos;
+		const double dist = rel.Mod();
+		const AngleDeg dir = GetNormalizeAngleDeg(rel.Dir() - face);
+
+		if (fabs(dir) < half_view) {
+			os << " ((" << flags[i].mName << ") " << QuantizeDist(dist, sp.landmarkQuantizeStep()) << " " << Rint(dir) << ")";
+		}
+		else if (dist <= sp.visibleDistance()) {
+			os << " ((" << (flags[i].mIsGoal? "G": "F") << ") " << QuantizeDist(dist, sp.landmarkQuantizeStep()) << " " << Rint(dir) << ")";
+		}
+	}
+
+	static const char LINE_NAME[4] = { 'r', 'b', 'l', 't' }; // 外法向 0, 90, 180, 270
+	for (int i = 0; i < 4; ++i) { // 在场内只看得到一条，在场外可能两条，客户端据此判断是否在场外
+		double dist;
+		AngleDeg dir;
+		if (SeeLine(pos, face, 90.0 * i, dist, dir)) {
+			os << " ((l " << LINE_NAME[i] << ") " << QuantizeDist(dist, sp.landmarkQuantizeStep()) << " " << Rint(dir) << ")";
+		}
+	}
+
+	for (unsigned i = 0; i <= mClients.size(); ++i) { // 最后一个是球
+		const Client *other = i < mClients.size()? mClients[i]: 0;
+		const Vector obj_pos = other? other->mPlayer.mPos: mBall.mPos;
+		const Vector obj_vel = other? other->mPlayer.mVel: mBall.mVel;
+
+		if (other == & client || (other && !other->mIsAlive)) {
+			continue;
+		}
+
+		const Vector rel = obj_pos - pos;
+		const double dist = rel.Mod();
+		const AngleDeg dir = GetNormalizeAngleDeg(rel.Dir() - face);
+		const double qdist = QuantizeDist(dist, sp.quantizeStep());
+
+		if (fabs(dir) >= half_view) {
+			if (dist <= sp.visibleDistance()) {
+				os << " ((" << (other? "P": "B") << ") " << qdist << " " << Rint(dir) << ")";
+			}
+			continue;
+		}
+
+		bool detail = dist <= sp.unumFarLength();
+		os << " ((";
+		if (other == 0) {
+			os << "b";
+		}
+		else {
+			bool unum = detail || (dist < sp.unumTooFarLength() &&
+					mRandom.Uniform(0.0, 1.0) < (sp.unumTooFarLength() - dist) / (sp.unumTooFarLength() - sp.unumFarLength()));
+			bool team = unum || dist < sp.teamTooFarLength();
+
+			os << "p";
+			if (team) {
+				os << " \"" << mTeamName[other->mSide] << "\"";
+				if (unum) {
+					os << " " << other->mUnum << (other->mIsGoalie? " goalie": "");
+				}
+			}
+			detail = detail && unum;
+		}
+		os << ") " << qdist << " " << Rint(dir);
+
+		if (detail && dist > FLOAT_EPS) {
+			const Vector rel_vel = obj_vel - client.mPlayer.mVel;
+			const Vector e = rel / dist;
+			const double dist_chg = Quantize((rel_vel.X() * e.X() + rel_vel.Y() * e.Y()) * qdist / dist, 0.02);
+			const double dir_chg = Quantize(Rad2Deg((rel_vel.Y() * e.X() - rel_vel.X() * e.Y()) / dist), 0.1);
+			os << " " << dist_chg << " " << dir_chg;
+
+			if (other) {
+				os << " " << Rint(GetNormalizeAngleDeg(other->mPlayer.mBodyDir - face))
+						<< " " << Rint(GetNormalizeAngleDeg(other->FaceDir() - face));
+			}
+		}
+		os << ")";
+	}
+
+	os << ")";
+	return os.str();
+}
+
+std::string StandInServer::Hear(const Client & client, const Client & speaker, const std::string & say) const
+{
+	std::ostringstream os;
+	os << "(hear " << mTime << " " << Rint(GetNormalizeAngleDeg((speaker.mPlayer.mPos - client.mPlayer.mPos).Dir() - client.FaceDir()));
+	if (speaker.mSide == client.mSide) {
+		os << " our " << speaker.mUnum;
+	}
+	else {
+		os << " opp";
+	}
+	os << " \"" << say << "\")";
+	return os.str();
+}
+
+/**
+ * 在 log_dir 下写 rcg，结束时按 rcssserver 的规则改名为 时间-左队_比分-vs-右队_比分.rcg，
+ * farm.sh 从文件名里读比分；stand_in_game_log 关掉时只记比赛模式和比分
+ */
+void StandInServer::OpenGameLog()
+{
+	char stamp[32];
+	time_t now = time(0);
+	strftime(stamp, sizeof(stamp), "%Y%m%d%H%M%S", localtime(& now));
+	mGameLogStamp = stamp;
+
+	std::string file_name = PlayerParam::instance().logDir() + "/incomplete.rcg";
+	mGameLog.open(file_name.c_str());
+	if (!mGameLog.good()) {
+		PRINT_ERROR("open file error  " << file_name);
+		return;
+	}
+
+	mGameLog << "ULG5" << std::endl;
+	for (unsigned i = 0; i < mParamMsgs.size(); ++i) {
+		mGameLog << mParamMsgs[i] << std::endl;
+	}
+	mGameLog << "(playmode 0 " << ServerPlayModeMap::instance().GetPlayModeString(mPlayMode) << ")" << std::endl;
+}
+
+void StandInServer::WriteShow()
+{
+	if (!mGameLog.is_open() || !PlayerParam::instance().StandInGameLog()) {
+		return;
+	}
+
+	mGameLog << "(show " << mTime << " ((b) " << mBall.mPos.X() << " " << mBall.mPos.Y() << " "
+			<< mBall.mVel.X() << " " << mBall.mVel.Y() << ")";
+
+	for (unsigned i = 0; i < mClients.size(); ++i) {
+		const Client & client = *mClients[i];
+		const Simulator::Player & player = client.mPlayer;
+		const int *count = client.mCount;
+
+		mGameLog << " ((" << SIDE_CHAR[client.mSide] << " " << client.mUnum << ") " << player.mPlayerType
+				<< " 0x" << std::hex << (client.mIsGoalie? 0x3: 0x1) << std::dec
+				<< " " << player.mPos.X() << " " << player.mPos.Y() << " " << player.mVel.X() << " " << player.mVel.Y()
+				<< " " << player.mBodyDir << " " << client.mNeckDir
+				<< " (v h " << sight::ViewAngle(client.mViewWidth) << ")"
+				<< " (s " << player.mStamina << " " << player.mEffort << " 1 " << ServerParam::instance().staminaCapacity() << ")"
+				<< " (c " << count[CC_Kick] << " " << count[CC_Dash] << " " << count[CC_Turn] << " " << count[CC_Catch]
+				<< " " << count[CC_Move] << " " << count[CC_TurnNeck] << " " << count[CC_ChangeView] << " " << count[CC_Say]
+				<< " " << count[CC_Tackle] << " " << count[CC_PointTo] << " " << count[CC_AttentionTo] << "))";
+	}
+
+	mGameLog << ")" << std::endl;
+}
+
+void StandInServer::CloseGameLog()
+{
+	if (!mGameLog.is_open()) {
+		return;
+	}
+	mGameLog.close();
+
+	std::ostringstream file_name;
+	file_name << PlayerParam::instance().logDir() << "/" << mGameLogStamp << "-"
+			<< (mTeamName[0].empty()? "null": mTeamName[0]) << "_" << mScore[0] << "-vs-"
+			<< (mTeamName[1].empty()? "null": mTeamName[1]) << "_" << mScore[1] << ".rcg";
+
+	std::string incomplete = PlayerParam::instance().logDir() + "/incomplete.rcg";
+	if (rename(incomplete.c_str(), file_name.str().c_str()) != 0) {
+		PRINT_ERROR("rename " << incomplete << " to " << file_name.str() << " failed");
+	}
+}
+
+void StandInServer::WriteStats() const
+{
+	const double seconds = mPlayUsec / 1000000.0;
+	const double cycles_per_second = seconds > 0.0? mPlayCycles / seconds: 0.0;
+	const double speedup = cycles_per_second * ServerParam::instance().simStep() / 1000.0;
+
+	std::cout << "stand-in server: " << mTeamName[0] << " " << mScore[0] << " - " << mScore[1] << " " << mTeamName[1]
+			<< ", " << mPlayCycles << " cycles in " << seconds << " s (" << speedup << "x real time)" << std::endl;
+
+	if (!PlayerParam::instance().TimeTest()) {
+		return;
+	}
+
+	std::ofstream out_file("Test/StandIn.txt");
+	if (out_file.good() == false) {
+		PRINT_ERROR("open file error  Test/StandIn.txt");
+		return;
+	}
+
+	out_file << "score: " << mTeamName[0] << " " << mScore[0] << " - " << mScore[1] << " " << mTeamName[1] << std::endl;
+	out_file << "play cycles: " << mPlayCycles << std::endl;
+	out_file << "play time: " << seconds << " s" << std::endl;
+	out_file << "cycles per second: " << cycles_per_second << std::endl;
+	out_file << "speedup over real time: " << speedup << std::endl;
+	out_file << "think timeouts: " << mThinkTimeouts << std::endl;
+	out_file.close();
+}
+
+#else
+
+void StandInServer::Run()
+{
+	PRINT_ERROR("stand-in server is not supported on windows");
+}
+
+#endif
@@ -0,0 +1,229 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file StandInServer.h
+ * @brief 替身server（StandInServer）接口定义
+ *
+ * stand_in_server 打开时本进程不当球员，而是在 ServerParam::playerPort() 上开一个 UDP 端口，
+ * 用 Simulator 里的球、球员模型和 ActionEffector 里的踢球、铲球公式推进比赛，按 rcssserver
+ * 的球员协议收发消息：init、server_param/player_param/player_type、sense_body、带量化的 see、
+ * hear、同步模式的 think/done 和裁判的比赛模式。同步模式下所有球员 (done) 之后立即进入
+ * 下一周期，不必等 sim_step，用来在一台机器上大量自我对练。
+ *
+ * 只覆盖球员协议的一个子集：没有教练和在线教练，视觉里没有场地线，裁判不判越位和犯规，
+ * 球员之间、球员和球之间没有碰撞。比赛结果只用来做相对比较，不能代替 rcssserver 的正式测试。
+ */
+
+#ifndef __StandInServer_H__
+#define __StandInServer_H__
+
+#include "Simulator.h"
+#include "Types.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <netinet/in.h>
+#endif
+
+class StandInServer
+{
+	StandInServer();
+
+public:
+	~StandInServer();
+
+	static StandInServer & instance();
+
+	/**
+	 * 等球员连上后把一场比赛跑完，time_over 之后返回
+	 */
+	void Run();
+
+private:
+	/** 一个周期内收到的身体动作，每周期只执行第一个 */
+	enum BodyCommandType {
+		BC_None,
+		BC_Dash,
+		BC_Turn,
+		BC_Kick,
+		BC_Tackle,
+		BC_Catch,
+		BC_Move
+	};
+
+	/** sense_body 里的各项命令计数 */
+	enum {
+		AFTER_GOAL_WAIT = 50, // 进球后到开球的周期数，与 rcssserver 相同
+		BYE_WAIT = 1000 // time_over 之后等球员 (bye) 的时间，毫秒
+	};
+
+	enum CommandCount {
+		CC_Kick,
+		CC_Dash,
+		CC_Turn,
+		CC_Say,
+		CC_TurnNeck,
+		CC_Catch,
+		CC_Move,
+		CC_ChangeView,
+		CC_PointTo,
+		CC_AttentionTo,
+		CC_Tackle,
+
+		CC_Max
+	};
+
+	struct Client {
+#ifndef WIN32
+		sockaddr_in mAddress;
+#endif
+		int mSide; // 0 左，1 右
+		Unum mUnum;
+		bool mIsGoalie;
+		bool mIsAlive; // 发了 (bye) 之后不再发消息
+
+		Simulator::Player mPlayer;
+		AngleDeg mNeckDir; // 相对身体
+		ViewWidth mViewWidth;
+		int mSightWait; // 距离下次 see 还有几个周期
+		char mFocusSide;
+		Unum mFocusUnum;
+		int mCount[CC_Max];
+		int mTackleExpires;
+		int mCatchBan;
+
+		BodyCommandType mBodyCommand;
+		double mBodyParam[2];
+		bool mFoul;
+		bool mHasTurnNeck;
+		double mTurnNeck;
+		bool mHasChangeView;
+		ViewWidth mNewViewWidth;
+		std::string mSay;
+		bool mDone;
+
+		Client(int side, Unum unum, bool goalie);
+
+		/** 面朝方向（身体加脖子） */
+		AngleDeg FaceDir() const { return GetNormalizeAngleDeg(mPlayer.mBodyDir + mNeckDir); }
+	};
+
+private:
+	bool OpenSocket();
+	void CloseSocket();
+
+	/** 收一个包并处理，timeout_ms 内没有消息返回 false */
+	bool Receive(int timeout_ms);
+	void Send(const Client & client, const std::string & msg);
+	void Reply(const std::string & msg); // 回给当前消息的来源，用于还没有 init 的地址
+	void ParseInit(const char *msg);
+	void ParseCommand(Client & client, const char *msg);
+
+	/** 按 rcssserver 的异构生成公式随机出 player_types 种球员，本进程的 PlayerParam 也用同样的参数 */
+	void GeneratePlayerTypes();
+	void SendParams(const Client & client);
+
+	/** 同步模式下等所有球员 (done)，非同步模式下等满一个 sim_step */
+	void WaitForCommands();
+	void ExecuteCommands();
+	void SetBodyCommand(Client & client, BodyCommandType type, double param0, double param1, CommandCount count);
+	void Kick(Client & client);
+	void Tackle(Client & client);
+	void Catch(Client & client);
+	void Move(Client & client);
+	void StepBall();
+
+	void Referee();
+	void CheckBall();
+	void Goal(int side);
+	void ChangePlayMode(ServerPlayMode spm);
+	void SetPiece(ServerPlayMode spm, const Vector & ball_pos);
+	void ClearPlayers(int side, const Vector & center, double radius);
+	void PrepareKickOff(int side);
+	bool IsStopped() const;
+	bool CanKick(int side) const;
+	bool IsMoveAllowed(const Client & client) const;
+	bool AllDone() const;
+
+	void SendSensors();
+	std::string SenseBody(const Client & client) const;
+	std::string See(const Client & client);
+	std::string Hear(const Client & client, const Client & speaker, const std::string & say) const;
+
+	void OpenGameLog();
+	void WriteShow();
+	void CloseGameLog();
+	void WriteStats() const;
+
+	int AliveCount() const;
+
+private:
+#ifndef WIN32
+	int mSockfd;
+	sockaddr_in mFrom; // 当前消息的来源
+#endif
+
+	std::vector<Client*> mClients;
+	std::string mTeamName[2];
+	int mScore[2];
+
+	int mTime; // 比赛周期
+	int mStoppedTime; // 停顿周期，时间不走时递增
+	ServerPlayMode mPlayMode;
+	int mModeTime; // 进入当前比赛模式的周期
+	int mHalfEnded; // 最近一次已经处理过的半场结束周期
+	int mKickOffSide; // 下一次开球的一方
+	int mWaitCycles; // 停顿模式下已等的周期数
+	int mLastTouchSide; // 最后触球的一方，-1 表示还没人碰过
+	int mKickedSide; // 本周期踢到球的一方，用来结束定位球
+	Client * mpCatcher; // 抱着球的守门员
+	int mGoalieMoves;
+
+	Simulator::Ball mBall;
+	Simulator::Random mRandom;
+
+	std::vector<std::string> mParamMsgs; // init 之后依次下发的 server_param、player_param、player_type
+	std::vector<std::string> mRefereeMsgs; // 本周期要广播的裁判消息
+	std::vector<std::pair<const Client *, std::string> > mSays; // 本周期要转发的 say
+
+	std::ofstream mGameLog;
+	std::string mGameLogStamp;
+
+	int mPlayCycles; // 非停顿周期数，用来统计速度
+	int mThinkTimeouts; // 同步模式下等 (done) 超时的周期数
+	long mPlayUsec; // 非停顿周期的总耗时，微秒
+};
+
+#endif
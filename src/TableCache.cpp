@@ -0,0 +1,249 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file TableCache.cpp
+ * @brief 派生表的磁盘缓存（TableCache）实现
+ *
+ * 文件格式：HEADER_SIZE 字节的文件头（魔数、键、表体大小），后面紧跟表体。
+ * 映射在进程退出前一直保留，表指针可以放心长期持有。
+ */
+
+#include "TableCache.h"
+#include "PlayerParam.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+const char CACHE_MAGIC[8] = { 'W', 'E', 'T', 'A', 'B', 'L', 'E', '1' };
+}
+
+const unsigned long long TableCache::HASH_SEED = 14695981039346656037ULL;
+
+TableCache::TableCache()
+{
+}
+
+TableCache::~TableCache()
+{
+#ifndef WIN32
+	for (std::vector<Mapping>::iterator it = mMappings.begin(); it != mMappings.end(); ++it) {
+		munmap(it->mAddress, it->mLength);
+	}
+#endif
+}
+
+TableCache & TableCache::instance()
+{
+	static TableCache table_cache;
+	return table_cache;
+}
+
+unsigned long long TableCache::Hash(const void * data, size_t size, unsigned long long seed)
+{
+	const unsigned char * p = static_cast<const unsigned char *>(data);
+	unsigned long long hash = seed;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+std::string TableCache::GetFileName(const char * name, unsigned long long key) const
+{
+	char buf[64];
+	sprintf(buf, "/%s-%016llx.tbl", name, key);
+	return PlayerParam::instance().TableCacheDir() + buf;
+}
+
+const void * TableCache::Load(const char * name, unsigned long long key, size_t size, TableGenerator & generator, void * buffer)
+{
+	if (!PlayerParam::instance().UseTableCache()) {
+		generator.Generate(buffer);
+		return buffer;
+	}
+
+	const void * table = Map(name, key, size);
+	if (table) {
+		return table;
+	}
+
+	const std::string file_name = GetFileName(name, key);
+	if (TryLock(file_name)) {
+		generator.Generate(buffer);
+		Store(name, key, buffer, size);
+		UnLock(file_name);
+	}
+	else {
+		for (int waited = 0; waited < LOCK_WAIT; waited += LOCK_POLL) { //别的进程正在生成
+			WaitFor(LOCK_POLL);
+			table = Map(name, key, size);
+			if (table) {
+				return table;
+			}
+		}
+
+		generator.Generate(buffer); //等不到就自己算，可能是锁文件残留
+		Store(name, key, buffer, size);
+		UnLock(file_name); //清掉残留的锁，否则以后每个进程都要等满LOCK_WAIT
+	}
+
+	table = Map(name, key, size);
+	return table? table: buffer;
+}
+
+#ifndef WIN32
+
+const void * TableCache::Map(const char * name, unsigned long long key, size_t size)
+{
+	const std::string file_name = GetFileName(name, key);
+
+	int fd = open(file_name.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return 0;
+	}
+
+	struct stat st;
+	if (fstat(fd, & st) != 0 || st.st_size != (off_t)(HEADER_SIZE + size)) {
+		close(fd);
+		return 0;
+	}
+
+	void * address = mmap(0, HEADER_SIZE + size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED) {
+		return 0;
+	}
+
+	const char * header = static_cast<const char *>(address);
+	unsigned long long file_key = 0;
+	unsigned long long file_size = 0;
+	memcpy(& file_key, header + sizeof(CACHE_MAGIC), sizeof(file_key));
+	memcpy(& file_size, header + sizeof(CACHE_MAGIC) + sizeof(file_key), sizeof(file_size));
+
+	if (memcmp(header, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || file_key != key || file_size != size) {
+		munmap(address, HEADER_SIZE + size);
+		return 0;
+	}
+
+	Mapping mapping;
+	mapping.mAddress = address;
+	mapping.mLength = HEADER_SIZE + size;
+
+	mMutex.Lock();
+	mMappings.push_back(mapping);
+	mMutex.UnLock();
+
+	return header + HEADER_SIZE;
+}
+
+bool TableCache::Store(const char * name, unsigned long long key, const void * data, size_t size)
+{
+	mkdir(PlayerParam::instance().TableCacheDir().c_str(), 0755); //已经存在也没关系
+
+	const std::string file_name = GetFileName(name, key);
+	char suffix[32];
+	sprintf(suffix, ".%d.tmp", (int)getpid());
+	const std::string tmp_name = file_name + suffix;
+
+	FILE * fp = fopen(tmp_name.c_str(), "wb");
+	if (fp == 0) {
+		PRINT_ERROR("can not write table cache " << tmp_name);
+		return false;
+	}
+
+	char header[HEADER_SIZE];
+	unsigned long long file_size = size;
+	memset(header, 0, sizeof(header));
+	memcpy(header, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	memcpy(header + sizeof(CACHE_MAGIC), & key, sizeof(key));
+	memcpy(header + sizeof(CACHE_MAGIC) + sizeof(key), & file_size, sizeof(file_size));
+
+	bool ok = fwrite(header, 1, HEADER_SIZE, fp) == HEADER_SIZE && fwrite(data, 1, size, fp) == size;
+	ok = (fclose(fp) == 0) && ok;
+
+	if (!ok || rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+		PRINT_ERROR("can not write table cache " << file_name);
+		remove(tmp_name.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool TableCache::TryLock(const std::string & file_name)
+{
+	mkdir(PlayerParam::instance().TableCacheDir().c_str(), 0755);
+
+	int fd = open((file_name + ".lock").c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (fd < 0) {
+		return errno != EEXIST; //缓存目录不可写时就当作自己负责，之后直接用buffer
+	}
+	close(fd);
+	return true;
+}
+
+void TableCache::UnLock(const std::string & file_name)
+{
+	remove((file_name + ".lock").c_str());
+}
+
+#else
+
+const void * TableCache::Map(const char *, unsigned long long, size_t)
+{
+	return 0;
+}
+
+bool TableCache::Store(const char *, unsigned long long, const void *, size_t)
+{
+	return false;
+}
+
+bool TableCache::TryLock(const std::string &)
+{
+	return true;
+}
+
+void TableCache::UnLock(const std::string &)
+{
+}
+
+#endif
@@ -0,0 +1,115 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file TableCache.h
+ * @brief 派生表的磁盘缓存（TableCache）接口定义
+ *
+ * Kicker 表等由 server_param/player_type 推导出来的大表，按“表名 + 输入参数的哈希”存成
+ * 缓存目录下的一个文件。以后启动时直接 mmap 只读映射，同一台机器上的多个进程共享同一份
+ * 物理页；参数变了哈希就变，自然不会用到不一致的表。
+ * 缓存未命中时只有拿到锁文件的进程负责生成，其余进程等它写完再映射，等待超时才自己算。
+ */
+
+#ifndef __TableCache_H__
+#define __TableCache_H__
+
+#include "Thread.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * 缓存未命中时用来生成表的接口
+ */
+class TableGenerator
+{
+public:
+	virtual ~TableGenerator() {}
+
+	/** 把表写进 data，大小为 Load 时给出的 size */
+	virtual void Generate(void * data) = 0;
+};
+
+class TableCache
+{
+	TableCache();
+
+public:
+	~TableCache();
+
+	static TableCache & instance();
+
+	/**
+	 * 64位 FNV-1a，seed 用来把多段输入串成一个键
+	 */
+	static unsigned long long Hash(const void * data, size_t size, unsigned long long seed = HASH_SEED);
+	static unsigned long long Hash(const double & value, unsigned long long seed) { return Hash(& value, sizeof(value), seed); }
+
+	/**
+	 * 取得名为name、键为key、大小为size的表：
+	 * 命中则返回只读映射；未命中则用generator生成到buffer里并写入缓存，再尽量换成映射返回。
+	 * 缓存关掉或不可用时就是直接生成到buffer里。
+	 */
+	const void * Load(const char * name, unsigned long long key, size_t size, TableGenerator & generator, void * buffer);
+
+	/** 命中则返回映射好的表体，否则返回0 */
+	const void * Map(const char * name, unsigned long long key, size_t size);
+
+	/** 先写临时文件再改名，其他进程不会读到写了一半的文件 */
+	bool Store(const char * name, unsigned long long key, const void * data, size_t size);
+
+private:
+	std::string GetFileName(const char * name, unsigned long long key) const;
+
+	/** 用 O_EXCL 创建锁文件，成功说明由自己负责生成 */
+	bool TryLock(const std::string & file_name);
+	void UnLock(const std::string & file_name);
+
+	static const unsigned long long HASH_SEED;
+
+	enum {
+		HEADER_SIZE = 64, // 文件头占的字节数，表体从这里开始，保证对齐
+		LOCK_WAIT = 5000, // 等别的进程生成的最长时间，毫秒
+		LOCK_POLL = 10 // 等待时检查的间隔，毫秒
+	};
+
+	struct Mapping {
+		void * mAddress;
+		size_t mLength;
+	};
+
+	std::vector<Mapping> mMappings;
+	ThreadMutex mMutex;
+};
+
+#endif
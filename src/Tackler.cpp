@@ -42,10 +42,9 @@
  *
  * 设计要点：
  * - 使用单例并缓存计算结果（按 AgentID 去重），避免每周期重复计算；
- * - 通过 mDirMap 将“球速方向”映射到“铲球角度区间”，便于快速查询；
+ * - 铲球角度的单位向量与力量只与服务器参数有关，只算一次，每周期只需旋转到身体方向，不再调用三角函数；
+ * - 通过 mDirSegmentBegin/mDirSegment 将“球速方向”映射到“铲球角度区间”，查询时只看三个方向分组；
  * - 在查询时对相邻区间做线性插值，提高精度。
- *
- * @note 本文件仅补充注释，不改动任何原有逻辑。
  */
 
 #include "Tackler.h"
@@ -54,7 +53,11 @@
 /**
  * @brief 构造函数（私有）
  */
-Tackler::Tackler()
+Tackler::Tackler():
+	mMaxTackleSpeed(-1.0),
+	mCanTackleStopBall(false),
+	mTackleStopBallAngle(0.0),
+	mIsTackleTableReady(false)
 {
 }
 
@@ -92,32 +95,52 @@ void Tackler::UpdateTackleData(const Agent & agent)
 
     mAgentID = agent.GetAgentID();
 
+    if (!mIsTackleTableReady) {
+    	const double max_tackle_power = ServerParam::instance().maxTacklePower();
+    	const double min_back_tackle_power = ServerParam::instance().maxBackTacklePower();
+
+    	for (int i = 0; i < TACKLE_SAMPLES; ++i) {
+    		AngleDeg tackle_angle = -180.0 + FLOAT_EPS + i;
+    		mTackleUnit[i] = Polar2Vector(1.0, tackle_angle);
+    		mTacklePower[i] = (min_back_tackle_power + ((max_tackle_power - min_back_tackle_power) * (1.0 - fabs(Deg2Rad(tackle_angle)) / M_PI))) * ServerParam::instance().tacklePowerRate();
+    	}
+
+    	mIsTackleTableReady = true;
+    }
+
     const BallState & ball_state     = agent.GetWorldState().GetBall();
     const PlayerState & player_state = agent.GetSelf();
     Vector ball_2_player = (ball_state.GetPos() - player_state.GetPos()).Rotate(-player_state.GetBodyDir());
 
-    Vector ball_vel;
     mMaxTackleSpeed = -1.0;
-    mDirMap.clear();
+    mCanTackleStopBall = false;
 
-    const double max_tackle_power = ServerParam::instance().maxTacklePower();
-    const double min_back_tackle_power = ServerParam::instance().maxBackTacklePower();
+    const double factor = 1.0 - 0.5 * (fabs(Deg2Rad(ball_2_player.Dir())) / M_PI);
+    const double body_cos = Cos(player_state.GetBodyDir());
+    const double body_sin = Sin(player_state.GetBodyDir());
+    const double ball_speed_max = ServerParam::instance().ballSpeedMax();
 
-    double factor = 1.0 - 0.5 * (fabs(Deg2Rad(ball_2_player.Dir())) / M_PI);
+    Array<int, TACKLE_SAMPLES> dir_key;
+    Array<int, DIR_BINS + 1, true> dir_count;
 
-    for (AngleDeg tackle_angle = -180.0 + FLOAT_EPS; tackle_angle <= 180.0 + FLOAT_EPS; tackle_angle += 1.0) {
-    	Vector ball_vel(ball_state.GetVel());
-        double eff_power = (min_back_tackle_power + ((max_tackle_power - min_back_tackle_power) * (1.0 - fabs(Deg2Rad(tackle_angle)) / M_PI))) * ServerParam::instance().tacklePowerRate();
-        eff_power *= factor;
-        ball_vel += Polar2Vector(eff_power, tackle_angle + player_state.GetBodyDir());
-        ball_vel = ball_vel.SetLength(Min(ball_vel.Mod(), ServerParam::instance().ballSpeedMax()));
+    for (int i = 0; i < TACKLE_SAMPLES; ++i) {
+    	const AngleDeg tackle_angle = -180.0 + FLOAT_EPS + i;
+    	const double eff_power = mTacklePower[i] * factor;
+    	const Vector & unit = mTackleUnit[i];
+
+    	Vector ball_vel(ball_state.GetVel().X() + eff_power * (unit.X() * body_cos - unit.Y() * body_sin),
+    			ball_state.GetVel().Y() + eff_power * (unit.X() * body_sin + unit.Y() * body_cos));
+    	const double speed = ball_vel.Mod();
+    	if (speed > ball_speed_max) {
+    		ball_vel *= ball_speed_max / speed;
+    	}
 
         int angle_idx = ang2idx(tackle_angle);
-        int dir_idx = dir2idx(ball_vel.Dir());
 
         mTackleAngle[angle_idx] = tackle_angle;
         mBallVelAfterTackle[angle_idx] = ball_vel;
-        mDirMap[dir_idx].push_back(std::make_pair(angle_idx, ang2idx(tackle_angle + 1.0)));
+        dir_key[i] = dir2idx(ball_vel.Dir());
+        ++dir_count[dir_key[i] + 1];
 
         if (ball_vel.Mod() > mMaxTackleSpeed){
             mMaxTackleSpeed = ball_vel.Mod();
@@ -128,18 +151,80 @@ void Tackler::UpdateTackleData(const Agent & agent)
         	mTackleStopBallAngle = tackle_angle;
         }
     }
-//
-//
-//    for (AngleDeg tackle_angle = -180.0 + 0.3; tackle_angle <= 180.0 + FLOAT_EPS; tackle_angle += 1.0) {
-//    	Vector ball_vel = GetBallVelAfterTackle(agent, tackle_angle);
-//    	AngleDeg tackle_angle2 = 0.0;
-//    	GetTackleAngleToDir(agent, ball_vel.Dir(), & tackle_angle2);
-//
-//    	std::cout << tackle_angle << " " << tackle_angle2 << std::endl;
-//    }
-//
-//    exit(0);
+
+    //按出球方向分组，组内保持铲球角度从小到大的顺序
+    mDirSegmentBegin[0] = 0;
+    for (int k = 1; k <= DIR_BINS; ++k) {
+    	mDirSegmentBegin[k] = mDirSegmentBegin[k - 1] + dir_count[k];
+    	dir_count[k] = mDirSegmentBegin[k - 1];
+    }
+    for (int i = 0; i < TACKLE_SAMPLES; ++i) {
+    	mDirSegment[dir_count[dir_key[i] + 1]++] = ang2idx(-180.0 + FLOAT_EPS + i);
+    }
+
+#ifdef __TACKLE_TEST
+    CheckTackleData(agent);
+#endif
+}
+
+#ifdef __TACKLE_TEST
+/**
+ * 与逐个角度直接计算的结果比较，检查预计算的表
+ */
+void Tackler::CheckTackleData(const Agent & agent)
+{
+    const BallState & ball_state     = agent.GetWorldState().GetBall();
+    const PlayerState & player_state = agent.GetSelf();
+    Vector ball_2_player = (ball_state.GetPos() - player_state.GetPos()).Rotate(-player_state.GetBodyDir());
+
+    const double max_tackle_power = ServerParam::instance().maxTacklePower();
+    const double min_back_tackle_power = ServerParam::instance().maxBackTacklePower();
+    const double factor = 1.0 - 0.5 * (fabs(Deg2Rad(ball_2_player.Dir())) / M_PI);
+
+    for (AngleDeg tackle_angle = -180.0 + FLOAT_EPS; tackle_angle <= 180.0 + FLOAT_EPS; tackle_angle += 1.0) {
+    	Vector ball_vel(ball_state.GetVel());
+        double eff_power = (min_back_tackle_power + ((max_tackle_power - min_back_tackle_power) * (1.0 - fabs(Deg2Rad(tackle_angle)) / M_PI))) * ServerParam::instance().tacklePowerRate();
+        eff_power *= factor;
+        ball_vel += Polar2Vector(eff_power, tackle_angle + player_state.GetBodyDir());
+        ball_vel = ball_vel.SetLength(Min(ball_vel.Mod(), ServerParam::instance().ballSpeedMax()));
+
+        if (ball_vel.Dist(mBallVelAfterTackle[ang2idx(tackle_angle)]) > 1.0e-6 && tackle_angle < 180.0) {
+        	PRINT_ERROR("tackle table mismatch at " << tackle_angle << ": " << ball_vel << " " << mBallVelAfterTackle[ang2idx(tackle_angle)]);
+        }
+    }
+
+    for (AngleDeg dir = -180.0; dir < 180.0; dir += 0.25) {
+    	//直接扫描所有铲球角度区间，只保留与原来按方向分组查询相同的三个分组
+    	const int keys[3] = { dir2idx(dir), dir2idx(dir - 1.0), dir2idx(dir + 1.0) };
+    	bool scan_ret = false;
+    	double scan_speed = -1.0;
+
+    	for (int j = 0; j < 3; ++j) {
+    		for (int i = 0; i < TACKLE_SAMPLES; ++i) {
+    			const int idx1 = ang2idx(-180.0 + FLOAT_EPS + i);
+    			const int idx2 = ang2idx(-180.0 + FLOAT_EPS + i + 1.0);
+    			if (dir2idx(mBallVelAfterTackle[idx1].Dir()) != keys[j]) continue;
+
+    			AngleDeg dir1 = mBallVelAfterTackle[idx1].Dir();
+    			AngleDeg dir2 = mBallVelAfterTackle[idx2].Dir();
+    			if (IsAngleDegInBetween(dir1, dir, dir2)) {
+    				scan_ret = true;
+    				dir2 = GetNormalizeAngleDeg(dir2, dir1);
+    				AngleDeg d = GetNormalizeAngleDeg(dir, dir1);
+    				double rate = (dir2 - d) / (dir2 - dir1);
+    				scan_speed = Max(scan_speed, (mBallVelAfterTackle[idx1] * rate + mBallVelAfterTackle[idx2] * (1.0 - rate)).Mod());
+    			}
+    		}
+    	}
+
+    	Vector ball_vel;
+    	bool ret = GetTackleInfoToDir(agent, dir, 0, &ball_vel);
+    	if (ret != scan_ret || (ret && fabs(ball_vel.Mod() - scan_speed) > 1.0e-6)) {
+    		PRINT_ERROR("tackle dir lookup mismatch at " << dir << ": " << ret << " " << scan_ret << " " << ball_vel.Mod() << " " << scan_speed);
+    	}
+    }
 }
+#endif
 
 /**
  * @brief 获取指定铲球角度对应的球速
@@ -189,9 +274,9 @@ bool Tackler::GetTackleInfoToDir(const Agent & agent, AngleDeg dir, AngleDeg *p_
 	bool ret = false;
 
 	for (int j = 0; j < 3; ++j) {
-		for (uint i = 0; i < mDirMap[dir_idx[j]].size(); ++i) {
-			const int angle_idx1 = mDirMap[dir_idx[j]][i].first;
-			const int angle_idx2 = mDirMap[dir_idx[j]][i].second;
+		for (int i = mDirSegmentBegin[dir_idx[j]]; i < mDirSegmentBegin[dir_idx[j] + 1]; ++i) {
+			const int angle_idx1 = mDirSegment[i];
+			const int angle_idx2 = ang2idx(angle_idx1 + 1.0);
 
 			AngleDeg dir1 = mBallVelAfterTackle[angle_idx1].Dir();
 			AngleDeg dir2 = mBallVelAfterTackle[angle_idx2].Dir();
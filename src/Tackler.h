@@ -35,6 +35,8 @@
 
 #include "Agent.h"
 
+//#define __TACKLE_TEST //检查铲球表与逐个角度直接计算的结果是否一致
+
 /**
  * Tackler
  */
@@ -101,6 +103,15 @@ public:
     static bool MayDangerousIfTackle(const PlayerState & tackler, const WorldState & world_state);
 
 private:
+    enum {
+    	TACKLE_SAMPLES = 361, //-180.0 -> 180.0，每度一个
+    	DIR_BINS = 361 //dir2idx 的取值范围 0 -> 360
+    };
+
+#ifdef __TACKLE_TEST
+    void CheckTackleData(const Agent & agent);
+#endif
+
     /** 用来节省时间的记录量 */
 	AgentID mAgentID;
 
@@ -111,7 +122,18 @@ private:
     bool mCanTackleStopBall;
     AngleDeg mTackleStopBallAngle;
 
-    std::map<int, std::vector<std::pair<int, int> > > mDirMap; //记录铲到某一方向所需铲球角度的上界和下届，后面会根据这个上下界结算出所需铲球角度（局部线性估计）
+    /** 只与服务器参数有关的量，铲球角度相对身体的单位向量和铲球力量，第一次更新时算好 */
+    Array<Vector, TACKLE_SAMPLES> mTackleUnit;
+    Array<double, TACKLE_SAMPLES> mTacklePower;
+    bool mIsTackleTableReady;
+
+    /**
+     * 记录铲到某一方向所需铲球角度的上界和下届，后面会根据这个上下界结算出所需铲球角度（局部线性估计）
+     * 按出球方向 dir2idx 分组连续存放：第 i 组是 mDirSegment[mDirSegmentBegin[i] .. mDirSegmentBegin[i+1])，
+     * 每项是区间下界的铲球角度下标，上界是下一度
+     */
+    Array<int, DIR_BINS + 1> mDirSegmentBegin;
+    Array<int, TACKLE_SAMPLES> mDirSegment;
 };
 
 
@@ -0,0 +1,211 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file TeamProcess.cpp
+ * @brief 整队单进程启动（TeamProcess）实现
+ *
+ * fork 必须在任何线程启动之前完成，所以 Run 在 main 里、Client 构造之前调用；
+ * Client 的构造和线程都在子进程里。
+ */
+
+#include "TeamProcess.h"
+#include "PlayerParam.h"
+#include "ServerParam.h"
+#include "Evaluation.h"
+#include "Kicker.h"
+#include "Thread.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifndef WIN32
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+TeamProcess::TeamProcess()
+{
+}
+
+TeamProcess::~TeamProcess()
+{
+}
+
+TeamProcess & TeamProcess::instance()
+{
+	static TeamProcess team_process;
+	return team_process;
+}
+
+void TeamProcess::LoadSharedState()
+{
+	// 阵型文件在 Formation::instance 静态构造时已经读好
+	Evaluation::instance(); // 评价网络的权重
+	Kicker::instance(); // Kicker表本身要等球员类型就绪，由各子进程从 TableCache 映射同一个文件
+}
+
+#ifndef WIN32
+
+bool TeamProcess::Run()
+{
+	LoadSharedState();
+
+	const int players = MinMax(0, PlayerParam::instance().TeamProcessPlayers(), int(TEAMSIZE));
+	const bool coach = PlayerParam::instance().TeamProcessCoach();
+
+	std::vector<pid_t> children;
+	for (int i = 0; i < players + (coach? 1: 0); ++i) {
+		const bool is_coach = i == players;
+		const bool is_goalie = i == 0 && !is_coach;
+
+		if (is_coach) {
+			WaitFor(COACH_CONNECT_WAIT);
+		}
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			PRINT_ERROR("fork error");
+			break;
+		}
+
+		if (pid == 0) {
+			PlayerParam::instance().setIsGoalie(is_goalie);
+			PlayerParam::instance().setIsCoach(is_coach);
+			return false;
+		}
+
+		children.push_back(pid);
+		WaitFor(is_goalie? GOALIE_CONNECT_WAIT: PLAYER_CONNECT_WAIT);
+	}
+
+	signal(SIGINT, SIG_IGN); // 子进程收到后各自退出，父进程留下来汇总
+	signal(SIGQUIT, SIG_IGN);
+
+	std::ofstream out_file;
+	if (PlayerParam::instance().TimeTest()) {
+		out_file.open("Test/TeamProcess.txt");
+		if (out_file.good() == false) {
+			PRINT_ERROR("open file error  Test/TeamProcess.txt");
+		}
+	}
+
+	long max_rss_sum = 0;
+	long voluntary_sum = 0;
+	long involuntary_sum = 0;
+	long minor_fault_sum = 0;
+	long major_fault_sum = 0;
+
+	for (size_t i = 0; i < children.size(); ++i) {
+		int status = 0;
+		struct rusage usage;
+		memset(& usage, 0, sizeof(usage));
+
+		pid_t pid = wait4(children[i], & status, 0, & usage);
+		if (pid < 0) {
+			continue;
+		}
+
+		max_rss_sum += usage.ru_maxrss;
+		voluntary_sum += usage.ru_nvcsw;
+		involuntary_sum += usage.ru_nivcsw;
+		minor_fault_sum += usage.ru_minflt;
+		major_fault_sum += usage.ru_majflt;
+
+		if (out_file.good()) {
+			out_file << "child " << i << " (pid " << pid << "): max rss " << usage.ru_maxrss << "KB, "
+					<< "voluntary switches " << usage.ru_nvcsw << ", involuntary switches " << usage.ru_nivcsw << ", "
+					<< "minor faults " << usage.ru_minflt << ", major faults " << usage.ru_majflt << std::endl;
+		}
+	}
+
+	if (out_file.good()) {
+		out_file << "total: max rss " << max_rss_sum << "KB (shared pages counted once per child), "
+				<< "voluntary switches " << voluntary_sum << ", involuntary switches " << involuntary_sum << ", "
+				<< "minor faults " << minor_fault_sum << ", major faults " << major_fault_sum << std::endl;
+		out_file.close();
+	}
+
+	return true;
+}
+
+void TeamProcess::WriteProcessStats(int unum)
+{
+	char file_name[256];
+	sprintf(file_name, "Test/Process-%d.txt", unum);
+
+	std::ofstream out_file(file_name);
+	if (out_file.good() == false) {
+		PRINT_ERROR("open file error  " << file_name);
+		return;
+	}
+
+	struct rusage usage;
+	memset(& usage, 0, sizeof(usage));
+	getrusage(RUSAGE_SELF, & usage);
+
+	out_file << "max rss: " << usage.ru_maxrss << "KB" << std::endl;
+	out_file << "voluntary switches: " << usage.ru_nvcsw << std::endl;
+	out_file << "involuntary switches: " << usage.ru_nivcsw << std::endl;
+	out_file << "minor faults: " << usage.ru_minflt << std::endl;
+	out_file << "major faults: " << usage.ru_majflt << std::endl;
+
+	std::ifstream smaps("/proc/self/smaps_rollup"); // PSS 才能把共享页平摊到各进程
+	std::string line;
+	while (std::getline(smaps, line)) {
+		if (line.compare(0, 4, "Rss:") == 0 || line.compare(0, 4, "Pss:") == 0 ||
+				line.compare(0, 7, "Shared_") == 0 || line.compare(0, 8, "Private_") == 0) {
+			out_file << line << std::endl;
+		}
+	}
+
+	out_file.close();
+}
+
+#else
+
+bool TeamProcess::Run()
+{
+	PRINT_ERROR("team_process is not supported on this platform");
+	return false;
+}
+
+void TeamProcess::WriteProcessStats(int)
+{
+}
+
+#endif
@@ -0,0 +1,80 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D)                                        *
+ * BASE SOURCE CODE RELEASE 2016                                                    *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team,                   *
+ *                         Multi-Agent Systems Lab.,                                *
+ *                         School of Computer Science and Technology,               *
+ *                         University of Science and Technology of China            *
+ * All rights reserved.                                                             *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without               *
+ * modification, are permitted provided that the following conditions are met:      *
+ *     * Redistributions of source code must retain the above copyright             *
+ *       notice, this list of conditions and the following disclaimer.              *
+ *     * Redistributions in binary form must reproduce the above copyright          *
+ *       notice, this list of conditions and the following disclaimer in the        *
+ *       documentation and/or other materials provided with the distribution.       *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the      *
+ *       names of its contributors may be used to endorse or promote products       *
+ *       derived from this software without specific prior written permission.      *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND  *
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED    *
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE           *
+ * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer Simulation Team BE LIABLE    *
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL       *
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR       *
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    *
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF *
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+/**
+ * @file TeamProcess.h
+ * @brief 整队单进程启动（TeamProcess）接口定义
+ *
+ * team_process 打开时，由一个进程先加载所有只读的状态（参数、阵型、评价网络、Kicker表等），
+ * 再 fork 出守门员、其余球员和教练。各球员的 Observer/WorldModel/Agent、UDP socket 和线程
+ * 都在自己的子进程里，只读状态通过写时复制和 mmap 共享物理页，不必把各个 instance() 单例
+ * 改成每个球员一份的上下文。父进程等所有子进程结束后汇总各自的资源占用。
+ *
+ * time_test 打开时每个球员进程退出前都会写 Test/Process-<unum>.txt（RSS、PSS、共享页、
+ * 缺页和上下文切换次数），用 start.sh 的多进程方式和 team_process 方式各跑一次即可对比。
+ */
+
+#ifndef __TeamProcess_H__
+#define __TeamProcess_H__
+
+class TeamProcess
+{
+	TeamProcess();
+
+public:
+	~TeamProcess();
+
+	static TeamProcess & instance();
+
+	/**
+	 * 加载共享状态并 fork 出整队。父进程等所有子进程结束后返回 true；
+	 * 子进程设好自己的角色后返回 false，接着按普通球员或教练运行
+	 */
+	bool Run();
+
+	/**
+	 * 把本进程的内存和调度统计写到 Test/Process-<unum>.txt
+	 */
+	static void WriteProcessStats(int unum);
+
+private:
+	/** fork 之前加载只读状态，子进程里直接用 */
+	void LoadSharedState();
+
+	enum {
+		GOALIE_CONNECT_WAIT = 1000, // 守门员先连上，拿到1号，毫秒
+		PLAYER_CONNECT_WAIT = 100, // 与 start.sh 的 SLEEP_TIME 一致
+		COACH_CONNECT_WAIT = 1000
+	};
+};
+
+#endif
@@ -48,6 +48,7 @@
  */
 
 #include "Thread.h"
+#include "SchedulingProfile.h"
 #include <error.h>
 
 
@@ -242,7 +243,9 @@ void ThreadMutex::UnLock()
  */
 void *Thread::Spawner(void *thread)
 {
+	SchedulingProfile::instance().Apply(static_cast<Thread*>(thread)->mRole);
 	static_cast<Thread*>(thread)->StartRoutine();
+	SchedulingProfile::instance().Remove();
 	return (void*) 0;
 }
 
@@ -148,13 +148,28 @@ private:
 #endif
 
 
+/**
+ * 线程的角色，决定它的CPU和调度优先级，见 SchedulingProfile
+ */
+enum ThreadRole
+{
+	TR_Worker,
+	TR_Decision,
+	TR_Parser,
+	TR_CommandSender,
+	TR_Logger
+};
+
 class Thread
 {
 	Thread(const Thread &);
 	const Thread &operator=(const Thread &);
 
 public:
-	Thread()
+	Thread(ThreadRole role = TR_Worker): mRole(role)
+	{
+	}
+	virtual ~Thread()
 	{
 	}
 
@@ -166,6 +181,7 @@ private:
 	virtual void StartRoutine() = 0;
 
 private:
+	ThreadRole mRole;
 #ifdef WIN32
 	HANDLE mThread;
 #else
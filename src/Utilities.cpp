@@ -81,6 +81,8 @@ timeval RealTime::mStartTime = GetRealTime();
  */
 const long RealTime::ONE_MILLION = 1000000;
 
+int Updatable::mRevision = 0;
+
 /**
  * @brief 获取当前系统时间
  * 
@@ -627,22 +627,38 @@ public:
 
 class Updatable {
 public:
-	Updatable(): mUpdateTime(Time(-3, 0)) {}
+	Updatable(): mUpdateTime(Time(-3, 0)), mUpdateRevision(0) {}
 
 	virtual ~Updatable(){}
 
 	void UpdateAtTime(const Time & time) {
-		if (mUpdateTime != time){
+		if (mUpdateTime != time || mUpdateRevision != mRevision){
 			mUpdateTime = time;
+			mUpdateRevision = mRevision;
 			UpdateRoutine();
 		}
 	}
 
+	/**
+	 * 同一周期内世界状态被重新更新时（推测决策后收到视觉），使所有按周期缓存的数据失效
+	 * Invalidate every per-cycle cache when the world state is updated again within the same cycle.
+	 */
+	static void Invalidate() { ++mRevision; }
+	static int Revision() { return mRevision; }
+
+	/**
+	 * 只让这一个对象下次 UpdateAtTime 时重新更新
+	 */
+	void Expire() { mUpdateTime = Time(-3, 0); }
+
 private:
 	virtual void UpdateRoutine() = 0;
 
 private:
 	Time mUpdateTime;
+	int mUpdateRevision;
+
+	static int mRevision;
 };
 
 class ServerPlayModeMap {
@@ -37,9 +37,8 @@
  * 该实现维护两套世界状态与历史状态：
  * - 在 `Update()` 中先将当前 WorldState 推入 HistoryState（用于历史回溯）；
  * - 再根据 Observer 更新“己方视角”的世界；
- * - 最后通过 `GetReverseFrom` 生成“对手视角/反算”世界，供对手建模或反算策略使用。
+ * - “对手视角/反算”世界在本周期第一次被请求时才通过 `GetReverseFrom` 生成，供对手建模或反算策略使用。
  *
- * @note 本文件仅补充注释，不改动任何原有逻辑。
  */
 
 #include "WorldModel.h"
@@ -53,6 +52,12 @@ WorldModel::WorldModel() {
 
 	mpHistoryState[1] = new HistoryState;
 	mpWorldState[1] = new WorldState(mpHistoryState[1]); //供反算时用的，对手的世界状态
+
+	mUpdateCount = 0;
+	mReverseStamp = 0;
+	mReverseRequested = false;
+	mReverseRequestCount = 0;
+	mReverseBuildCount = 0;
 }
 
 WorldModel::~WorldModel() {
@@ -67,19 +72,63 @@ void WorldModel::Update(Observer *observer)
 {
 	//存储一下当前的世界
 	mpHistoryState[0]->UpdateHistory(*mpWorldState[0]);
-	mpHistoryState[1]->UpdateHistory(*mpWorldState[1]);
 
 	mpWorldState[0]->UpdateFromObserver(observer); //自己方决策使用的世界状态
-	mpWorldState[1]->GetReverseFrom(mpWorldState[0]); //可供反算对手时使用的世界状态
+	MarkReverseStale(); //可供反算对手时使用的世界状态，用到时再生成
+}
+
+void WorldModel::ReUpdate(Observer *observer)
+{
+	*mpWorldState[0] = *mpHistoryState[0]->GetHistory(1); //Update()之前的世界
+
+	mpWorldState[0]->UpdateFromObserver(observer);
+	MarkReverseStale();
+
+	Updatable::Invalidate(); //按周期缓存的数据要重新计算
+}
+
+void WorldModel::MarkReverseStale()
+{
+	++mUpdateCount;
+
+	if (mReverseRequested) {
+		mReverseRequested = false;
+		BuildReverse();
+	}
+}
+
+/**
+ * 反算世界的历史只记录生成过的周期，目前只有己方世界用到历史
+ */
+void WorldModel::BuildReverse()
+{
+	if (mReverseStamp == mUpdateCount) return;
+
+	if (mpWorldState[1]->CurrentTime() != mpWorldState[0]->CurrentTime()) {
+		mpHistoryState[1]->UpdateHistory(*mpWorldState[1]);
+	}
+	mpWorldState[1]->GetReverseFrom(mpWorldState[0]);
+
+	mReverseStamp = mUpdateCount;
+	++mReverseBuildCount;
 }
 
 const WorldState & WorldModel::GetWorldState(bool reverse) const
 {
-	return *(reverse? mpWorldState[1]: mpWorldState[0]);
+	if (reverse) {
+		return const_cast<WorldModel *>(this)->World(true);
+	}
+	return *mpWorldState[0];
 }
 
 WorldState & WorldModel::World(bool reverse)
 {
-	return *(reverse? mpWorldState[1]: mpWorldState[0]);
+	if (reverse) {
+		++mReverseRequestCount;
+		mReverseRequested = true;
+		BuildReverse();
+		return *mpWorldState[1];
+	}
+	return *mpWorldState[0];
 }
 
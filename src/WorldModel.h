@@ -35,14 +35,13 @@
  * @brief 世界模型管理器（WorldModel）接口定义
  *
  * WorldModel 负责组织与维护世界模型的核心对象，典型设计为：
- * - 持有两份 WorldState：一份用于“己方视角”的决策，一份用于“对手视角/反算”的决策；
+ * - 持有两份 WorldState：一份用于“己方视角”的决策，一份用于“对手视角/反算”的决策，
+ *   后者在被请求时才生成；
  * - 为每份 WorldState 配套维护 HistoryState，用于在周期更新时记录历史快照，支持回溯
  *   查询与基于历史的推断。
  *
  * 外部通常通过 `WorldModel::Update()` 推进周期更新，并通过 `GetWorldState()`/`World()`
  * 获取对应视角的世界状态引用。
- *
- * @note 本文件仅补充注释，不改动任何原有逻辑。
  */
 
 #ifndef WORLDMODEL_H_
@@ -63,12 +62,38 @@ public:
 
 	void Update(Observer *observer);
 
+	/**
+	 * 同一周期内收到新信息后重新更新，不再记录历史
+	 * Update again within the same cycle from the state before Update(), without recording history.
+	 */
+	void ReUpdate(Observer *observer);
+
 	const WorldState & GetWorldState(bool reverse) const;
 	WorldState       & World(bool reverse);
 
+	/**
+	 * 反算用的世界状态访问统计：更新次数、被请求的次数、实际生成的次数
+	 */
+	long GetUpdateCount() const { return mUpdateCount; }
+	long GetReverseRequestCount() const { return mReverseRequestCount; }
+	long GetReverseBuildCount() const { return mReverseBuildCount; }
+
 private:
+	/**
+	 * 反算用的世界状态只在本周期第一次被请求时才从己方世界生成。
+	 * 上周期被请求过时（可能还有反算的 Agent 持有它），Update() 时直接生成，保证持有者看到的是最新的。
+	 */
+	void BuildReverse();
+	void MarkReverseStale();
+
 	WorldState *mpWorldState[2];
 	HistoryState *mpHistoryState[2];
+
+	long mUpdateCount;          //Update() 与 ReUpdate() 的次数
+	long mReverseStamp;         //反算世界对应的 mUpdateCount
+	bool mReverseRequested;     //自上次更新以来反算世界是否被请求过
+	long mReverseRequestCount;
+	long mReverseBuildCount;
 };
 
 #endif /* WORLDMODEL_H_ */
@@ -64,6 +64,7 @@
 #include "Logger.h"
 #include "Tackler.h"
 #include <fstream>
+#include <algorithm>
 
 /**
  * @brief WorldStateUpdater 类的静态常量定义
@@ -73,6 +74,8 @@
 const double WorldStateUpdater::KICKABLE_BUFFER = 0.04;  ///< 踢球缓冲区域（米）
 const double WorldStateUpdater::CATCHABLE_BUFFER = 0.04;  ///< 接球缓冲区域（米）
 
+long WorldState::mStampCounter = 0;
+
 /**
  * @brief WorldState 构造函数
  * 
@@ -102,7 +105,8 @@ WorldState::WorldState(HistoryState* history_state):
 	mOpponentGoalieUnum( 0),              // 对方守门员号码
 	mTeammateScore( 0),                   // 我方比分
 	mOpponentScore( 0),                   // 对方比分
-	mIsCycleStopped( false)               // 周期是否停止
+	mIsCycleStopped( false),              // 周期是否停止
+	mStamp( 0)                            // 修改标记
 {
 	// === 球员号码分配和初始化 ===
 	// 为各个球员分配号码并初始化状态
@@ -166,7 +170,7 @@ Time WorldState::GetTimeBeforeCurrent(int cycle) const
 	Assert(cycle <= HistoryState::HISTORY_SIZE && cycle >= 1);
 
 	// 获取指定周期前的世界状态时间
-	return mpHistory->GetHistory(cycle)->mCurrentTime;
+	return mpHistory->GetHistoryTime(cycle);
 }
 
 /**
@@ -191,6 +195,7 @@ void WorldState::UpdateFromObserver(Observer *observer)
 	// 创建WorldStateUpdater对象并执行更新
 	// 这种设计将复杂的更新逻辑封装在专门的类中
 	WorldStateUpdater(observer, this).Run();
+	Touch();
 }
 
 /**
@@ -233,6 +238,8 @@ void WorldState::GetReverseFrom(WorldState *world_state)
 		Opponent(i).GetReverseFrom(world_state->Teammate(i));
 		Teammate(i).GetReverseFrom(world_state->Opponent(i));
 	}
+
+	Touch();
 }
 
 BallState & WorldStateUpdater::Ball()
@@ -929,6 +936,59 @@ namespace
 	}
 }
 
+/**
+ * 比较最近标志定位与多标志融合定位的误差和耗时，用 fullstate 给出的位置作为真值，
+ * 需要 server 打开 fullstate（如 DynamicDebug 回放带 fullstate 的记录），结果在 Test/Localization-<unum>.txt
+ */
+class LocalizationTest {
+	LocalizationTest(): mUnum(0), mSamples(0), mNearestError(0.0), mFusedError(0.0), mNearestUsec(0), mFusedUsec(0), mFusedBetter(0) {}
+
+public:
+	static LocalizationTest & instance() { static LocalizationTest test; return test; }
+
+	void AddSample(Unum self_unum, const Vector & truth, const Vector & nearest, const Vector & fused, long nearest_usec, long fused_usec) {
+		mUnum = self_unum;
+
+		double nearest_error = nearest.Dist(truth);
+		double fused_error = fused.Dist(truth);
+
+		++mSamples;
+		mNearestError += nearest_error;
+		mFusedError += fused_error;
+		mNearestUsec += nearest_usec;
+		mFusedUsec += fused_usec;
+		if (fused_error < nearest_error) ++mFusedBetter;
+	}
+
+	~LocalizationTest() {
+		if (mSamples == 0) return;
+
+		char file_name[256];
+		sprintf(file_name, "Test/Localization-%d.txt", mUnum);
+
+		std::ofstream out_file(file_name);
+		if (out_file.good() == false) {
+			PRINT_ERROR("open file error  " << file_name);
+			return;
+		}
+
+		out_file << "Samples: " << mSamples << std::endl;
+		out_file << "Nearest marker mean error: " << mNearestError / mSamples << " mean time: " << double(mNearestUsec) / mSamples << "us" << std::endl;
+		out_file << "Fused mean error: " << mFusedError / mSamples << " mean time: " << double(mFusedUsec) / mSamples << "us" << std::endl;
+		out_file << "Fused better: " << mFusedBetter << " (" << 100.0 * mFusedBetter / mSamples << "%)" << std::endl;
+		out_file.close();
+	}
+
+private:
+	Unum mUnum;
+	long mSamples;
+	double mNearestError;
+	double mFusedError;
+	long mNearestUsec;
+	long mFusedUsec;
+	long mFusedBetter;
+};
+
 
 
 void WorldStateUpdater::UpdateSelfInfo()
@@ -981,6 +1041,7 @@ void WorldStateUpdater::UpdateSelfInfo()
 	if (mpWorldState->GetPlayModeTime() == mpWorldState->CurrentTime() || mpWorldState->IsBallDropped())
 	{
 		SelfState().UpdatePosEps(10000);
+		SelfState().UpdatePosCovariance(1.0e8, 0.0, 1.0e8);
 	}
 
 	//===============================更新自己的视觉======================
@@ -1016,28 +1077,26 @@ void WorldStateUpdater::UpdateSelfInfo()
 		//更新自己的位置
 		Vector pos;
 		double eps = 0;
-		if (ComputeSelfPos(pos , eps))
-		{
-			if (eps > SelfState().GetPosEps())
-			{
-				//根据统计值,x,y单个分量差值大于1基本不存在 因此取1
-				if (pos.Dist2(SelfState().GetPos()) < 1)
-				{
-					pos = SelfState().GetPos();
-					eps = SelfState().GetPosEps();
-				}
+		Array<double, 3> cov;
 
-			}
-			else if (eps == SelfState().GetPosEps())
+		if (PlayerParam::instance().TimeTest() && mSightDelay == 0 && mpObserver->mReceiveFullstateMsg)
+		{
+			RealTime start = GetRealTime();
+			bool nearest_ok = ComputeSelfPosByNearestMarker(pos, eps, cov);
+			RealTime mid = GetRealTime();
+			Vector fused;
+			bool fused_ok = ComputeSelfPos(fused, eps, cov);
+			RealTime end = GetRealTime();
+
+			if (nearest_ok && fused_ok && mpObserver->Teammate_Fullstate(mSelfUnum).GetPosDelay() == 0)
 			{
-				if (pos.Dist2(SelfState().GetPos()) < 1)
-				{
-					pos = (pos + SelfState().GetPos()) / 2;
-				}
+				LocalizationTest::instance().AddSample(mSelfUnum, mpObserver->Teammate_Fullstate(mSelfUnum).GetPos(), pos, fused, mid.Sub(start), end.Sub(mid));
 			}
+		}
 
-			SelfState().UpdatePos(pos, mSightDelay, mPlayerConf);
-			SelfState().UpdatePosEps(eps);
+		if (ComputeSelfPos(pos , eps, cov))
+		{
+			FuseSelfPos(pos, eps, cov);
 		}
 	}
 
@@ -1109,7 +1168,7 @@ void WorldStateUpdater::UpdateKnownPlayers()
 			continue;
 		}
 
-		if (mpObserver->Teammate(i).GetDir().time() == mpObserver->LatestSightTime())
+		if (mpObserver->IsInLatestSight(mpObserver->Teammate(i)))
 		{
 			UpdateSpecificPlayer(mpObserver->Teammate(i) , i , true);
 		}
@@ -1118,7 +1177,7 @@ void WorldStateUpdater::UpdateKnownPlayers()
 	//更新看到的对手
 	for (int i = 1;i <= TEAMSIZE;i++)
 	{
-		if (mpObserver->Opponent(i).GetDir().time() == mpObserver->LatestSightTime())
+		if (mpObserver->IsInLatestSight(mpObserver->Opponent(i)))
 		{
 			UpdateSpecificPlayer(mpObserver->Opponent(i) , i , false);
 		}
@@ -1517,7 +1576,7 @@ void WorldStateUpdater::UpdateBallInfo()
 	//更新位置
 	//计算公式见USTC_Material 第七章
 	//公式：ballPos = playerPos + polar2vector(ballDist , neckGlobalAngle + ballAngle)
-	if (mpObserver->Ball().GetDist().time() == mpObserver->LatestSightTime())
+	if (mpObserver->IsInLatestSight(mpObserver->Ball()))
 	{
 		double dist = PlayerParam::instance().ConvertSightDist(mpObserver->Ball().Dist());
 
@@ -1647,7 +1706,7 @@ void WorldStateUpdater::UpdateBallInfo()
 	}
 
 	//利用位置相减修正.
-	if (mpObserver->Ball().GetDist().time() == mpObserver->LatestSightTime()) //看到球的位置情况
+	if (mpObserver->IsInLatestSight(mpObserver->Ball())) //看到球的位置情况
 	{
 	/*		if (//mpObserver->Ball().Dist() < ServerParam::instance().visibleDistance() * 2 &&
 				(mpWorldState->GetHistory(1 + mSightDelay)->GetBall().GetPosDelay() == 0 ||
@@ -1856,7 +1915,7 @@ bool WorldStateUpdater::ComputeSelfDir(double& angle)
 	double min = 10000; //初始值
 	for (int i = 0;i <  SL_MAX;i++)
 	{
-		if (mpObserver->SideLine((SideLineType)i).GetDir().time() == mpObserver->LatestSightTime())
+		if (mpObserver->IsInLatestSight(mpObserver->SideLine((SideLineType)i)))
 		{
 			//必须使用最近的一条线
 			if (mpObserver->SideLine((SideLineType)i).Dist() < min)
@@ -1903,7 +1962,52 @@ bool WorldStateUpdater::ComputeSelfDir(double& angle)
 	return true;
 }
 
-bool WorldStateUpdater::ComputeSelfPos(Vector &vec ,double& eps)
+namespace
+{
+	/**
+	 * 一个标志给出的位置的信息矩阵（协方差的逆）：沿视线方向的误差为 radial，垂直方向的为 tangential
+	 */
+	void AddMarkerInformation(const AngleDeg & dir, double radial, double tangential, const Vector & pos, double info[3], double info_pos[2])
+	{
+		const double c = Cos(dir);
+		const double s = Sin(dir);
+		const double wr = 1.0 / Max(radial * radial, FLOAT_EPS);
+		const double wt = 1.0 / Max(tangential * tangential, FLOAT_EPS);
+
+		const double xx = wr * c * c + wt * s * s;
+		const double xy = (wr - wt) * c * s;
+		const double yy = wr * s * s + wt * c * c;
+
+		info[0] += xx;
+		info[1] += xy;
+		info[2] += yy;
+		info_pos[0] += xx * pos.X() + xy * pos.Y();
+		info_pos[1] += xy * pos.X() + yy * pos.Y();
+	}
+
+	void SetMarkerCovariance(const AngleDeg & dir, double radial, double tangential, Array<double, 3> & cov)
+	{
+		const double c = Cos(dir);
+		const double s = Sin(dir);
+		const double r2 = radial * radial;
+		const double t2 = tangential * tangential;
+
+		cov[0] = r2 * c * c + t2 * s * s;
+		cov[1] = (r2 - t2) * c * s;
+		cov[2] = r2 * s * s + t2 * c * c;
+	}
+
+	struct SeenMarker {
+		double mDist;
+		int mType;
+
+		bool operator<(const SeenMarker & o) const { return mDist < o.mDist; }
+	};
+
+	const double SIGHT_ANGLE_EPS = 1.0; //视觉角度误差，度
+}
+
+bool WorldStateUpdater::ComputeSelfPosByNearestMarker(Vector &vec ,double& eps, Array<double, 3> & cov)
 {
 	//寻找最近的标志
 	int sample = FLAG_NONE; //最近标志的标示
@@ -1911,7 +2015,7 @@ bool WorldStateUpdater::ComputeSelfPos(Vector &vec ,double& eps)
 
 	for (int i = 0;i < FLAG_MAX;i++)
 	{
-		if (mpObserver->Marker((MarkerType)i).GetDir().time() == mpObserver->LatestSightTime())
+		if (mpObserver->IsInLatestSight(mpObserver->Marker((MarkerType)i)))
 		{
 			if (mpObserver->Marker((MarkerType)i).Dist() < min)
 			{
@@ -1929,23 +2033,220 @@ bool WorldStateUpdater::ComputeSelfPos(Vector &vec ,double& eps)
 
 	//修正及计算eps
 	min = PlayerParam::instance().ConvertMarkDist(min);
-	eps = PlayerParam::instance().GetEpsInMark(min);
+	const double radial = PlayerParam::instance().GetEpsInMark(min);
+	const double tangential = calcEps(min, min, SIGHT_ANGLE_EPS);
+
+	eps = calcEps(min , min+radial , SIGHT_ANGLE_EPS);
 
-	eps = calcEps(min , min+eps , 1);
+	const AngleDeg dir = GetNeckGlobalDirFromSightDelay(mSightDelay) + mpObserver->Marker((MarkerType)sample).Dir();
 
 	if (GetSelf().GetBodyDirDelay() != mSightDelay)
 	{
 		//不去计算身体角度误差，没有更新认为其极不准
 		eps = 10000;
+		cov[0] = cov[2] = 1.0e8;
+		cov[1] = 0.0;
+	}
+	else
+	{
+		SetMarkerCovariance(dir, radial, tangential, cov);
 	}
 
 	//计算公式见USTC_Material 第七章
 	//playerPos = flagPos – polar2vector(flagDist, neckGlobalAngle + flagDir)
-	vec = mpObserver->Marker((MarkerType)sample).GlobalPosition() - Polar2Vector(min , GetNeckGlobalDirFromSightDelay(mSightDelay) + mpObserver->Marker((MarkerType)sample).Dir());
+	vec = mpObserver->Marker((MarkerType)sample).GlobalPosition() - Polar2Vector(min , dir);
+
+	return true;
+}
+
+/**
+ * 融合本次看到的所有标志（最多 localization_max_markers 个最近的）和边线的加权最小二乘定位。
+ * 每个标志给出一个位置，沿视线方向的误差由距离量化误差表决定，垂直方向的由角度误差决定；
+ * 只看到一条边线时，边线给出垂直于它方向上的一个约束。
+ * 以最近标志的结果为参照剔除明显错误的观测，结果的协方差为信息矩阵的逆，eps取协方差的迹的平方根（单个标志时与原来一致）。
+ */
+bool WorldStateUpdater::ComputeSelfPos(Vector &vec ,double& eps, Array<double, 3> & cov)
+{
+	if (!ComputeSelfPosByNearestMarker(vec, eps, cov))
+	{
+		return false;
+	}
+
+	const int max_markers = PlayerParam::instance().LocalizationMaxMarkers();
+	if (max_markers <= 1 || eps >= 10000)
+	{
+		return true;
+	}
+
+	SeenMarker seen[FLAG_MAX];
+	int seen_num = 0;
+	for (int i = 0;i < FLAG_MAX;i++)
+	{
+		if (mpObserver->IsInLatestSight(mpObserver->Marker((MarkerType)i)))
+		{
+			seen[seen_num].mDist = mpObserver->Marker((MarkerType)i).Dist();
+			seen[seen_num].mType = i;
+			++seen_num;
+		}
+	}
+
+	if (seen_num <= 1)
+	{
+		return true;
+	}
+
+	const int used_num = Min(seen_num, max_markers);
+	std::partial_sort(seen, seen + used_num, seen + seen_num);
+
+	const Vector reference = vec;
+	const double reference_eps = eps;
+	const AngleDeg neck_dir = GetNeckGlobalDirFromSightDelay(mSightDelay);
+
+	double info[3] = { 0.0, 0.0, 0.0 };
+	double info_pos[2] = { 0.0, 0.0 };
+
+	for (int k = 0; k < used_num; ++k)
+	{
+		const MarkerObserver & marker = mpObserver->Marker((MarkerType)seen[k].mType);
+		const double dist = PlayerParam::instance().ConvertMarkDist(seen[k].mDist);
+		const double radial = PlayerParam::instance().GetEpsInMark(dist);
+		const double tangential = calcEps(dist, dist, SIGHT_ANGLE_EPS);
+		const AngleDeg dir = neck_dir + marker.Dir();
+		const Vector pos = marker.GlobalPosition() - Polar2Vector(dist, dir);
+
+		if (pos.Dist(reference) > 3.0 * (calcEps(dist, dist + radial, SIGHT_ANGLE_EPS) + reference_eps))
+		{
+			continue; //与最近标志的结果明显不符
+		}
+
+		AddMarkerInformation(dir, radial, tangential, pos, info, info_pos);
+	}
+
+	//只看到一条边线时（看到两条时在场外）
+	int line_num = 0;
+	int line_type = SL_NONE;
+	for (int i = 0;i < SL_MAX;i++)
+	{
+		if (mpObserver->IsInLatestSight(mpObserver->SideLine((SideLineType)i)))
+		{
+			line_type = i;
+			++line_num;
+		}
+	}
+
+	if (line_num == 1)
+	{
+		const LineObserver & line = mpObserver->SideLine((SideLineType)line_type);
+		const double dist = PlayerParam::instance().ConvertMarkDist(line.Dist());
+		const double sin_dir = fabs(Sin(line.Dir()));
+		const double perp = dist * sin_dir; //到边线的垂直距离
+		const double sigma = PlayerParam::instance().GetEpsInMark(dist) * sin_dir + dist * fabs(Cos(line.Dir())) * Deg2Rad(SIGHT_ANGLE_EPS);
+		const Vector normal = line.GlobalPosition() / line.GlobalPosition().Mod();
+		const double offset = line.GlobalPosition().Mod() - perp; //normal * pos = offset
+
+		if (fabs(normal.X() * reference.X() + normal.Y() * reference.Y() - offset) <= 3.0 * (sigma + reference_eps))
+		{
+			const double w = 1.0 / Max(sigma * sigma, FLOAT_EPS);
+			info[0] += w * normal.X() * normal.X();
+			info[1] += w * normal.X() * normal.Y();
+			info[2] += w * normal.Y() * normal.Y();
+			info_pos[0] += w * normal.X() * offset;
+			info_pos[1] += w * normal.Y() * offset;
+		}
+	}
+
+	const double det = info[0] * info[2] - info[1] * info[1];
+	if (det < FLOAT_EPS)
+	{
+		return true; //退化为最近标志的结果
+	}
+
+	cov[0] = info[2] / det;
+	cov[1] = -info[1] / det;
+	cov[2] = info[0] / det;
+
+	vec = Vector(cov[0] * info_pos[0] + cov[1] * info_pos[1], cov[1] * info_pos[0] + cov[2] * info_pos[1]);
+	eps = Sqrt(cov[0] + cov[2]);
 
 	return true;
 }
 
+/**
+ * 视觉定位结果与当前位置融合。两者的协方差都有效且新结果与当前位置相符（马氏距离小于3）时按卡尔曼滤波融合，
+ * 不符时直接用新结果；只用最近标志定位时沿用原来按eps取舍的方法。
+ */
+void WorldStateUpdater::FuseSelfPos(const Vector & pos, double eps, const Array<double, 3> & cov)
+{
+	const Array<double, 3> & prior = GetSelf().GetPosCovariance();
+
+	if (PlayerParam::instance().LocalizationMaxMarkers() > 1 && eps < 10000 && SelfState().GetPosEps() < 10000 && prior[0] + prior[2] < 1.0e4)
+	{
+		const double sxx = prior[0] + cov[0];
+		const double sxy = prior[1] + cov[1];
+		const double syy = prior[2] + cov[2];
+		const double det = sxx * syy - sxy * sxy;
+
+		if (det > FLOAT_EPS)
+		{
+			const double ixx = syy / det;
+			const double ixy = -sxy / det;
+			const double iyy = sxx / det;
+			const Vector diff = pos - GetSelf().GetPos();
+
+			if (diff.X() * diff.X() * ixx + 2.0 * diff.X() * diff.Y() * ixy + diff.Y() * diff.Y() * iyy < 9.0)
+			{
+				//K = P * S^-1
+				const double kxx = prior[0] * ixx + prior[1] * ixy;
+				const double kxy = prior[0] * ixy + prior[1] * iyy;
+				const double kyx = prior[1] * ixx + prior[2] * ixy;
+				const double kyy = prior[1] * ixy + prior[2] * iyy;
+
+				//P = (I - K) * P
+				const double pxx = (1.0 - kxx) * prior[0] - kxy * prior[1];
+				const double pxy = (1.0 - kxx) * prior[1] - kxy * prior[2];
+				const double pyy = -kyx * prior[1] + (1.0 - kyy) * prior[2];
+
+				SelfState().UpdatePos(GetSelf().GetPos() + Vector(kxx * diff.X() + kxy * diff.Y(), kyx * diff.X() + kyy * diff.Y()), mSightDelay, mPlayerConf);
+				SelfState().UpdatePosEps(Sqrt(Max(pxx + pyy, 0.0)));
+				SelfState().UpdatePosCovariance(pxx, pxy, pyy);
+				return;
+			}
+		}
+
+		SelfState().UpdatePos(pos, mSightDelay, mPlayerConf);
+		SelfState().UpdatePosEps(eps);
+		SelfState().UpdatePosCovariance(cov[0], cov[1], cov[2]);
+		return;
+	}
+
+	Vector new_pos = pos;
+	double new_eps = eps;
+	Array<double, 3> new_cov = cov;
+
+	if (eps > SelfState().GetPosEps())
+	{
+		//根据统计值,x,y单个分量差值大于1基本不存在 因此取1
+		if (pos.Dist2(SelfState().GetPos()) < 1)
+		{
+			new_pos = SelfState().GetPos();
+			new_eps = SelfState().GetPosEps();
+			new_cov = GetSelf().GetPosCovariance();
+		}
+
+	}
+	else if (eps == SelfState().GetPosEps())
+	{
+		if (pos.Dist2(SelfState().GetPos()) < 1)
+		{
+			new_pos = (pos + SelfState().GetPos()) / 2;
+		}
+	}
+
+	SelfState().UpdatePos(new_pos, mSightDelay, mPlayerConf);
+	SelfState().UpdatePosEps(new_eps);
+	SelfState().UpdatePosCovariance(new_cov[0], new_cov[1], new_cov[2]);
+}
+
 bool WorldStateUpdater::ComputePlayerMaySeeOrNot(const PlayerState& state)
 {
 	double view_angle = 0;
@@ -2021,6 +2322,114 @@ bool WorldStateUpdater::ComputePlayerMaySeeOrNot(const PlayerState& state)
 
 #ifdef __UNKNOWN_TEST
 #include <fstream>
+
+/**
+ * 比较贪心匹配与最优匹配的误识别率：记下每个未知球员两种方法各自匹配到的候选球员，
+ * 之后几个周期内带号码看到的、能跑到该位置的最近球员作为真实身份。
+ * 在实际比赛或用 DynamicDebug 回放记录的视觉信息时都可以统计。
+ */
+class UnknownAssignmentTest {
+	UnknownAssignmentTest(): mUnum(0), mSighting(0), mVerified(0), mGreedyWrong(0), mOptimalWrong(0), mDifferent(0) {}
+
+public:
+	static UnknownAssignmentTest & instance() { static UnknownAssignmentTest test; return test; }
+
+	void AddAssignment(const WorldState & world, Unum self_unum, int player_num, const int optimal[], const int greedy[], const Vector pos[]) {
+		mUnum = self_unum;
+		for (int i = 0; i < player_num; ++i) {
+			if (optimal[i] == 0 && greedy[i] == 0) continue;
+
+			Record record;
+			record.mTime = world.CurrentTime();
+			record.mPos = pos[i];
+			record.mOptimal = optimal[i];
+			record.mGreedy = greedy[i];
+			mRecord.push_back(record);
+
+			++mSighting;
+			if (optimal[i] != greedy[i]) ++mDifferent;
+		}
+	}
+
+	void Verify(const WorldState & world) {
+		std::vector<Record> pending;
+
+		for (std::vector<Record>::iterator it = mRecord.begin(); it != mRecord.end(); ++it) {
+			int cycle = world.CurrentTime() - it->mTime;
+			if (cycle <= 0) {
+				pending.push_back(*it);
+				continue;
+			}
+
+			int truth = 0;
+			double min_dist = HUGE_VALUE;
+			for (int k = 1; k <= TEAMSIZE * 2; ++k) {
+				const PlayerState & player = (k <= TEAMSIZE)? world.GetTeammate(k): world.GetOpponent(k - TEAMSIZE);
+				if (!player.IsAlive() || player.GetPosDelay() != 0) continue;
+
+				double dist = player.GetPos().Dist(it->mPos);
+				if (dist < PlayerParam::instance().HeteroPlayer(player.GetPlayerType()).effectiveSpeedMax() * cycle + 1.0 && dist < min_dist) {
+					min_dist = dist;
+					truth = k;
+				}
+			}
+
+			if (truth != 0) {
+				++mVerified;
+				if (it->mGreedy != truth) ++mGreedyWrong;
+				if (it->mOptimal != truth) ++mOptimalWrong;
+			}
+			else if (cycle < VERIFY_CYCLE) {
+				pending.push_back(*it);
+			}
+		}
+
+		mRecord.swap(pending);
+	}
+
+	~UnknownAssignmentTest() {
+		if (mSighting == 0) return;
+
+		char file_name[256];
+		sprintf(file_name, "Test/UnknownAssignment-%d.txt", mUnum);
+
+		std::ofstream out_file(file_name);
+		if (out_file.good() == false) {
+			PRINT_ERROR("open file error  " << file_name);
+			return;
+		}
+
+		out_file << "Sightings: " << mSighting << std::endl;
+		out_file << "Different: " << mDifferent << std::endl;
+		out_file << "Verified: " << mVerified << std::endl;
+		if (mVerified > 0) {
+			out_file << "Greedy mis-identification: " << mGreedyWrong << " (" << 100.0 * mGreedyWrong / mVerified << "%)" << std::endl;
+			out_file << "Optimal mis-identification: " << mOptimalWrong << " (" << 100.0 * mOptimalWrong / mVerified << "%)" << std::endl;
+		}
+		out_file.close();
+	}
+
+private:
+	enum {
+		VERIFY_CYCLE = 3
+	};
+
+	struct Record {
+		Time mTime;
+		Vector mPos;
+		int mOptimal;
+		int mGreedy;
+	};
+
+	std::vector<Record> mRecord;
+
+	Unum mUnum;
+	long mSighting;
+	long mVerified;
+	long mGreedyWrong;
+	long mOptimalWrong;
+	long mDifferent;
+};
 #endif
 
 void WorldStateUpdater::UpdateUnknownPlayers()
@@ -2045,6 +2454,8 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 	int UnknownCount[TEAMSIZE * 2];               //标记未知球员可能的属于球员的个数
 
 	bool UnknownUpdate[TEAMSIZE*2];
+	double UnknownCost[TEAMSIZE * 2][TEAMSIZE * 2 + 1]; //匹配代价，未知球员与候选球员的距离除以允许的最大距离
+	Vector UnknownPosition[TEAMSIZE * 2];         //未知球员的位置，只算一次
 
 	// 初始化所有数组
 	for (int i = 0; i < TEAMSIZE * 2; ++i){
@@ -2052,6 +2463,7 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 		UnknownUpdate[i] = false;
 		for (int j = 0; j < TEAMSIZE * 2 + 1; ++j){
 			Unknown[i][j] = false;
+			UnknownCost[i][j] = 0.0;
 		}
 	}
 
@@ -2067,6 +2479,7 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 		// 根据距离和方向计算极坐标，然后转换为笛卡尔坐标
 		Vector pos = Polar2Vector(PlayerParam::instance().ConvertSightDist(mpObserver->UnknownPlayer(i).Dist()) , GetNeckGlobalDirFromSightDelay(mSightDelay) + mpObserver->UnknownPlayer(i).Dir());
 		pos = GetSelf().GetPos() + pos;
+		UnknownPosition[i] = pos;
 
 		// 检查位置是否在场地内（特殊模式下）
 		// 如果在特殊模式下且位置不在场地内，则跳过该未知球员
@@ -2091,6 +2504,7 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 				UnknownCount[i] = 1;
 				int index = mpObserver->UnknownPlayerBugInfo(i).mSide == self_side ?  mpObserver->UnknownPlayerBugInfo(i).mLeastNum : mpObserver->UnknownPlayerBugInfo(i).mLeastNum  + TEAMSIZE;
 				Unknown[i][index] = true;
+				UnknownCost[i][index] = 0.0;
 				continue; // 跳过后续处理
 			}
 
@@ -2118,6 +2532,7 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 					UnknownCount[i]++;
 					int index = mpObserver->UnknownPlayerBugInfo(i).mSide == self_side ? j : j + TEAMSIZE;
 					Unknown[i][index] = true;
+					UnknownCost[i][index] = (pos - player.GetPos()).Mod() / dist;
 				}
 			}
 		}
@@ -2151,6 +2566,7 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 					UnknownCount[i]++;
 					int index = mpObserver->UnknownPlayerBugInfo(i).mSide == self_side ? j : j + TEAMSIZE;
 					Unknown[i][index] = true;
+					UnknownCost[i][index] = (pos - player.GetPos()).Mod() / dist;
 				}
 			}
 
@@ -2177,228 +2593,54 @@ void WorldStateUpdater::UpdateUnknownPlayers()
 					UnknownCount[i]++;
 					int index = mpObserver->UnknownPlayerBugInfo(i).mSide == self_side ? j + TEAMSIZE : j;
 					Unknown[i][index] = true;
+					UnknownCost[i][index] = (pos - player.GetPos()).Mod() / dist;
 				}
 			}
 		}
 	}
 
-	//2. 对所有未知球员，当匹配列表只有1个元素时，进行唯一匹配
-	// 把该元素对应的老球员与未知球员匹配，从未知球员集合移除，并通过老球员匹配列表查询到
-	// 其它可能与其匹配的未知球员，将老球员从它们的匹配列表中移除。
-	for (int i = 0;i < player_num;i++)
-	{
-		bool is_update = false; // 判断有没有更新
-		for (int j = 0;j < player_num;j++)
-		{
-			// 检查是否有唯一匹配
-			if (UnknownCount[j] == 1)
-			{
-				// 查找唯一匹配的球员
-				int k = 0;
-				for (k = 1;k <= 2*TEAMSIZE;k++)
-				{
-					// 判断是否在已知球员列表中
-					if (Unknown[j][k])
-					{
-						// 根据球员编号判断是队友还是对手
-						if (k <= TEAMSIZE)
-						{
-							// 更新队友信息
-#ifdef __UNKNOWN_TEST
-test_num++;
-file << mpObserver->LatestSightTime() << "unknown guess teammate: " << k << std::endl;
-#endif
-							UpdateSpecificUnknownPlayer(mpObserver->UnknownPlayer(j) , k , true);
-						}
-						else
-						{
-							// 更新对手信息
-#ifdef __UNKNOWN_TEST
-test_num++;
-file << mpObserver->LatestSightTime() << "unknown guess opponent: " << k - TEAMSIZE << std::endl;
-#endif
-							UpdateSpecificUnknownPlayer(mpObserver->UnknownPlayer(j) , k - TEAMSIZE , false);
-						}
-						// 标记已更新
-						UnknownUpdate[j] = true;
-						break;
-					}
-				}
-
-				// 检查是否找到匹配的球员
-				// 没有找到则继续下一个未知球员
-				if (k > 2*TEAMSIZE )
-				{
-					UnknownCount[j] = 0;
-					std::cout << " error : 数组与值不相符!" << std::endl;
-					continue;
-				}
-
-				// 从原有的数组中去除该配对
-				// 遍历所有未知球员，移除与已匹配球员的关联
-				for (int m = 0;m < player_num;m++)
-				{
-					if (Unknown[m][k])
-					{
-						Unknown[m][k] = false;
-						UnknownCount[m]--;
-					}
-				}
-				// 标记已更新
-			is_update = true;
-
-			}
-		}
-
-		// 本周期没有更新，使用距离最小的原则
-		// 在个数最少中选最近的，保证至少更新一个
-		if (!is_update)
-		{
-			// 寻找匹配数量最少的未知球员
-			int min = 200 * TEAMSIZE;
-			int index = -1;
-			bool is_all_zero = true; // 标记是否所有未知球员都没有匹配
-			for (int j = 0;j < player_num;j++)
-			{
-				// 寻找匹配数量最少的未知球员
-				if (UnknownCount[j] > 0 && UnknownCount[j] < min)
-				{
-					min = UnknownCount[j];
-					index = j;
-				}
-
-				// 检查是否有未知球员有匹配
-				if (is_all_zero && UnknownCount[j] > 0)
-				{
-					is_all_zero = false;
-				}
-			}
-
-			// 全为零表示更新完毕
-			if (is_all_zero)
-			{
-				break; // 所有未知球员都已匹配，退出循环
-			}
-
-			// 寻找最近的更新
-			// 在匹配数量最少的未知球员中，选择距离最近的球员进行匹配
-			if (index != -1)
-			{
-				// 计算未知球员的位置
-				Vector pos = Polar2Vector(PlayerParam::instance().ConvertSightDist(mpObserver->UnknownPlayer(index).Dist()) , GetNeckGlobalDirFromSightDelay(mSightDelay) + mpObserver->UnknownPlayer(index).Dir()) + GetSelf().GetPos();
-				double min_dist = 200000; // 初始化最小距离
-				int min_index = -1;
-				
-				// 遍历所有可能的匹配球员，寻找距离最近的
-				for (int k = 1;k <= 2*TEAMSIZE;k++)
-				{
-					if (Unknown[index][k])
-					{
-						Vector compare_pos;
-						// 根据球员编号获取对应球员的位置
-						if (k <= TEAMSIZE)
-						{
-							compare_pos = GetTeammate(k).GetPos();
-						}
-						else
-						{
-							compare_pos = GetOpponent(k - TEAMSIZE).GetPos();
-						}
+	//2. 求出未知球员与候选球员的匹配，每个候选球员最多匹配一个未知球员
+	int Assignment[TEAMSIZE * 2]; //每个未知球员匹配到的候选球员，1~TEAMSIZE为己方球员，其它为对方球员，0为没有匹配
 
-						// 比较距离，更新最小距离和对应球员
-						if ( (pos - compare_pos).Mod() < min_dist)
-						{
-							min_dist = (pos - compare_pos).Mod();
-							min_index = k;
-						}
-					}
-				}
+	if (PlayerParam::instance().OptimalUnknownAssignment())
+	{
+		SolveUnknownAssignment(Unknown, UnknownCost, player_num, Assignment);
+	}
+	else
+	{
+		GreedyUnknownAssignment(Unknown, UnknownCount, UnknownPosition, player_num, Assignment);
+	}
 
-				if (min_index <= TEAMSIZE && min_index > 0)
-				{
 #ifdef __UNKNOWN_TEST
-test_num++;					//更新队友
-file << mpObserver->LatestSightTime() << "unknown guess teammate: " << min_index << std::endl;
-#endif
-					UpdateSpecificUnknownPlayer(mpObserver->UnknownPlayer(index) , min_index , true);
-					UnknownUpdate[index] = true;
-				}
-				else if (min_index > TEAMSIZE && min_index <= TEAMSIZE * 2)
-				{
-#ifdef __UNKNOWN_TEST
-test_num++;					//更新对手
-file << mpObserver->LatestSightTime() << "unknown guess opponent: " << min_index - TEAMSIZE << std::endl;
-#endif
-					UpdateSpecificUnknownPlayer(mpObserver->UnknownPlayer(index) , min_index - TEAMSIZE , false);
-					UnknownUpdate[index] = true;
-				}
-				else if (min_index == -1) //此时应该没有队员了
-				{
-					UnknownCount[index] = 0;
-					continue;
-				}
+	UnknownAssignmentTest::instance().Verify(*mpWorldState);
 
-				//生成的count置为零
-				UnknownCount[index] = 0;
-
-				//从原有的数组中去除该配对
-				for (int m = 0;m < player_num;m++)
-				{
-					if (Unknown[m][min_index])
-					{
-						Unknown[m][min_index] = false;
-						UnknownCount[m]--;
-					}
-/*
-					//利用server的bug，发回的号码是从大到小的顺序的
-					if (m < index)
-					{
-						int bound = TEAMSIZE;
-						if (min_index > TEAMSIZE)
-						{
-							bound = TEAMSIZE * 2;
-						}
-
-						for (int n = min_index + 1;n <= bound;n++)
-						{
-							if (Unknown[m][n])
-							{
-								Unknown[m][n] = false;
-								UnknownCount[m]--;
-							}
-						}
-					}
-					else if (m > index)
-					{
-						int bound = 1;
-						if ( min_index > TEAMSIZE)
-						{
-							bound = TEAMSIZE + 1;
-						}
-
-						for (int n = bound;n < min_index;n++)
-						{
-							if (Unknown[m][n])
-							{
-								Unknown[m][n] = false;
-								UnknownCount[m]--;
-							}
-						}
-					}*/
-				}
+	int OtherAssignment[TEAMSIZE * 2];
+	if (PlayerParam::instance().OptimalUnknownAssignment())
+	{
+		GreedyUnknownAssignment(Unknown, UnknownCount, UnknownPosition, player_num, OtherAssignment);
+		UnknownAssignmentTest::instance().AddAssignment(*mpWorldState, mSelfUnum, player_num, Assignment, OtherAssignment, UnknownPosition);
+	}
+	else
+	{
+		SolveUnknownAssignment(Unknown, UnknownCost, player_num, OtherAssignment);
+		UnknownAssignmentTest::instance().AddAssignment(*mpWorldState, mSelfUnum, player_num, OtherAssignment, Assignment, UnknownPosition);
+	}
+#endif
 
-				is_update = true;
-			}
+	for (int i = 0;i < player_num;i++)
+	{
+		if (Assignment[i] > 0)
+		{
+			UpdateSpecificUnknownPlayer(mpObserver->UnknownPlayer(i), Assignment[i] <= TEAMSIZE ? Assignment[i] : Assignment[i] - TEAMSIZE, Assignment[i] <= TEAMSIZE);
+			UnknownUpdate[i] = true;
 		}
-
 	}
 
 	for (int i = 0;i < player_num;i++)
 	{
 		if (!UnknownUpdate[i])
 		{
-			Vector pos = Polar2Vector(PlayerParam::instance().ConvertSightDist(mpObserver->UnknownPlayer(i).Dist()) , GetNeckGlobalDirFromSightDelay(mSightDelay) + mpObserver->UnknownPlayer(i).Dir());
-			pos = GetSelf().GetPos() + pos;
+			const Vector & pos = UnknownPosition[i];
 
 			if (!is_special_mode)
 			{
@@ -2479,6 +2721,202 @@ file << mpObserver->LatestSightTime() << "unknown guess opponent: " << min_index
 
 }
 
+/**
+ * 最优匹配：以未知球员为行、候选球员为列，用匈牙利算法求总代价最小的匹配。
+ * 每个未知球员另有一个只属于自己的“不匹配”列，代价大于所有匹配代价之和，所以先保证匹配的个数最多，再使总距离最小。
+ * 不是候选的位置代价为无穷大，规模最大为 22 x 44。
+ */
+void WorldStateUpdater::SolveUnknownAssignment(const bool unknown[][TEAMSIZE * 2 + 1], const double cost[][TEAMSIZE * 2 + 1], int player_num, int assignment[])
+{
+	static const double UNMATCHED_COST = 1000.0;
+	static const double FORBIDDEN_COST = 1.0e6;
+
+	const int n = player_num;
+	const int m = TEAMSIZE * 2 + player_num;
+
+	//下标从1开始，0为哨兵
+	double a[TEAMSIZE * 2 + 1][TEAMSIZE * 4 + 1];
+	double u[TEAMSIZE * 2 + 1];
+	double v[TEAMSIZE * 4 + 1];
+	double min_v[TEAMSIZE * 4 + 1];
+	int p[TEAMSIZE * 4 + 1];
+	int way[TEAMSIZE * 4 + 1];
+	bool used[TEAMSIZE * 4 + 1];
+
+	for (int i = 1; i <= n; ++i) {
+		for (int j = 1; j <= m; ++j) {
+			if (j <= TEAMSIZE * 2) {
+				a[i][j] = unknown[i - 1][j]? cost[i - 1][j]: FORBIDDEN_COST;
+			}
+			else {
+				a[i][j] = (j - TEAMSIZE * 2 == i)? UNMATCHED_COST: FORBIDDEN_COST;
+			}
+		}
+	}
+
+	for (int i = 0; i <= n; ++i) u[i] = 0.0;
+	for (int j = 0; j <= m; ++j) {
+		v[j] = 0.0;
+		p[j] = 0;
+		way[j] = 0;
+	}
+
+	for (int i = 1; i <= n; ++i) {
+		p[0] = i;
+		int j0 = 0;
+		for (int j = 0; j <= m; ++j) {
+			min_v[j] = HUGE_VALUE;
+			used[j] = false;
+		}
+
+		do {
+			used[j0] = true;
+			int i0 = p[j0];
+			int j1 = 0;
+			double delta = HUGE_VALUE;
+
+			for (int j = 1; j <= m; ++j) {
+				if (!used[j]) {
+					double cur = a[i0][j] - u[i0] - v[j];
+					if (cur < min_v[j]) {
+						min_v[j] = cur;
+						way[j] = j0;
+					}
+					if (min_v[j] < delta) {
+						delta = min_v[j];
+						j1 = j;
+					}
+				}
+			}
+
+			for (int j = 0; j <= m; ++j) {
+				if (used[j]) {
+					u[p[j]] += delta;
+					v[j] -= delta;
+				}
+				else {
+					min_v[j] -= delta;
+				}
+			}
+
+			j0 = j1;
+		} while (p[j0] != 0);
+
+		do {
+			int j1 = way[j0];
+			p[j0] = p[j1];
+			j0 = j1;
+		} while (j0 != 0);
+	}
+
+	for (int i = 0; i < n; ++i) {
+		assignment[i] = 0;
+	}
+
+	for (int j = 1; j <= TEAMSIZE * 2; ++j) {
+		if (p[j] != 0 && unknown[p[j] - 1][j]) {
+			assignment[p[j] - 1] = j;
+		}
+	}
+}
+
+/**
+ * 原来的贪心匹配：先匹配只有一个候选的未知球员，没有时在候选最少的未知球员中选最近的候选，直到都匹配完。
+ * 保留下来用于对比（optimal_unknown_assignment = off）。
+ */
+void WorldStateUpdater::GreedyUnknownAssignment(const bool unknown[][TEAMSIZE * 2 + 1], const int unknown_count[], const Vector unknown_pos[], int player_num, int assignment[])
+{
+	bool candidate[TEAMSIZE * 2][TEAMSIZE * 2 + 1];
+	int count[TEAMSIZE * 2];
+
+	for (int i = 0; i < player_num; ++i) {
+		assignment[i] = 0;
+		count[i] = unknown_count[i];
+		for (int k = 0; k <= TEAMSIZE * 2; ++k) {
+			candidate[i][k] = unknown[i][k];
+		}
+	}
+
+	for (int i = 0; i < player_num; ++i)
+	{
+		bool is_update = false;
+		for (int j = 0; j < player_num; ++j)
+		{
+			if (count[j] != 1) continue;
+
+			int k = 1;
+			for (; k <= TEAMSIZE * 2; ++k)
+			{
+				if (candidate[j][k]) break;
+			}
+
+			if (k > TEAMSIZE * 2)
+			{
+				count[j] = 0;
+				continue;
+			}
+
+			assignment[j] = k;
+
+			for (int m = 0; m < player_num; ++m)
+			{
+				if (candidate[m][k])
+				{
+					candidate[m][k] = false;
+					count[m]--;
+				}
+			}
+
+			is_update = true;
+		}
+
+		if (is_update) continue;
+
+		// 在候选个数最少的未知球员中选最近的候选
+		int min = 200 * TEAMSIZE;
+		int index = -1;
+		for (int j = 0; j < player_num; ++j)
+		{
+			if (count[j] > 0 && count[j] < min)
+			{
+				min = count[j];
+				index = j;
+			}
+		}
+
+		if (index == -1) break; // 都匹配完了
+
+		double min_dist = 200000;
+		int min_index = -1;
+		for (int k = 1; k <= TEAMSIZE * 2; ++k)
+		{
+			if (candidate[index][k])
+			{
+				const Vector & compare_pos = (k <= TEAMSIZE)? GetTeammate(k).GetPos(): GetOpponent(k - TEAMSIZE).GetPos();
+				if ((unknown_pos[index] - compare_pos).Mod() < min_dist)
+				{
+					min_dist = (unknown_pos[index] - compare_pos).Mod();
+					min_index = k;
+				}
+			}
+		}
+
+		count[index] = 0;
+		if (min_index == -1) continue;
+
+		assignment[index] = min_index;
+
+		for (int m = 0; m < player_num; ++m)
+		{
+			if (candidate[m][min_index])
+			{
+				candidate[m][min_index] = false;
+				count[m]--;
+			}
+		}
+	}
+}
+
 bool  WorldStateUpdater::UpdateMostSimilarPlayer(const Vector & pos ,int index)
 {
 	bool is_known_side = mpObserver->UnknownPlayer(index).IsKnownSide();
@@ -2821,6 +3259,7 @@ void WorldStateUpdater::EstimateSelf(bool is_estimate_to_now ,int cycle)
 		{
 			//碰撞由于内部处理太复杂,直接认为不准.
 			SelfState().UpdatePosEps(10000);
+			SelfState().UpdatePosCovariance(1.0e8, 0.0, 1.0e8);
 		}
 
 		if (!is_estimate_to_now)
@@ -2830,6 +3269,7 @@ void WorldStateUpdater::EstimateSelf(bool is_estimate_to_now ,int cycle)
 				//server内部最大的randp为Vel.Mod()*playerRand()
 				double eps = (SelfState().GetPos() - mpObserver->GetPlayerPosByDash()).Mod() * ServerParam::instance().playerRand();
 				SelfState().UpdatePosEps(SelfState().GetPosEps() + eps);
+				SelfState().InflatePosCovariance(eps * eps);
 			}
 			SelfState().UpdatePos(mpObserver->GetPlayerPosByDash(), SelfState().GetPosDelay(), SelfState().GetPosConf());
 			SelfState().UpdateVel(mpObserver->GetPlayerVelByDash(), SelfState().GetVelDelay(), SelfState().GetVelConf());
@@ -2844,6 +3284,7 @@ void WorldStateUpdater::EstimateSelf(bool is_estimate_to_now ,int cycle)
 			{
 				double eps = vel.Mod() * ServerParam::instance().playerRand();
 				SelfState().UpdatePosEps(SelfState().GetPosEps() + eps);
+				SelfState().InflatePosCovariance(eps * eps);
 			}
 
 			Vector pos = SelfState().GetPos() + vel;
@@ -2858,10 +3299,13 @@ void WorldStateUpdater::EstimateSelf(bool is_estimate_to_now ,int cycle)
 		{
 			//碰撞由于内部处理太复杂,直接认为不准.
 			SelfState().UpdatePosEps(10000);
+			SelfState().UpdatePosCovariance(1.0e8, 0.0, 1.0e8);
 		}
 		else
 		{
-			SelfState().UpdatePosEps(SelfState().GetPosEps() + SelfState().GetVel().Mod() * ServerParam::instance().playerRand());
+			double eps = SelfState().GetVel().Mod() * ServerParam::instance().playerRand();
+			SelfState().UpdatePosEps(SelfState().GetPosEps() + eps);
+			SelfState().InflatePosCovariance(eps * eps);
 		}
 	   	ComputeNextCycle(SelfState(), PlayerParam::instance().HeteroPlayer(GetSelf().GetPlayerType()).playerDecay());
 	}
@@ -3556,18 +4000,202 @@ double WorldStateUpdater::ComputeTackleProb(const Unum & unum, bool foul)
 	return GetTackleProb(ball_2_player, foul);
 }
 
+HistoryState::HistoryState():
+	mpLatest(new WorldState),
+	mNum(0)
+{
+	for (int i = 0; i <= HISTORY_SIZE; ++i) {
+		mViewNum[i] = -1;
+	}
+}
+
+HistoryState::~HistoryState()
+{
+	delete mpLatest;
+	for (int i = 0; i <= HISTORY_SIZE; ++i) {
+		delete mView[i];
+	}
+}
+
+/**
+ * @brief 将当前世界加入队列
+ *
+ * 上一周期的完整世界退为第2个记录，只保存它与当前世界相比变化了的对象字段。
+ * 它本身直接成为第2个记录的视图，已生成的视图依次后移，所以每周期只复制一次世界（与原来的环形数组相同），
+ * 之后按同样的 sight delay 取历史时不用再生成。
+ */
 void HistoryState::UpdateHistory(const WorldState &world)
 {
-	mNum = mNum % HISTORY_SIZE;
-	mRecord[mNum++] = world;
+	if (mNum > 0) {
+		CycleRecord & record = mRecord[mNum % HISTORY_SIZE];
+
+		record.mCurrentTime		= mpLatest->mCurrentTime;
+		record.mKickOffMode		= mpLatest->mKickOffMode;
+		record.mPlayMode		= mpLatest->mPlayMode;
+		record.mLastPlayMode	= mpLatest->mLastPlayMode;
+		record.mPlayModeTime	= mpLatest->mPlayModeTime;
+		record.mIsBallDropped	= mpLatest->mIsBallDropped;
+		record.mIsCycleStopped	= mpLatest->mIsCycleStopped;
+
+		record.mObject.clear(); // 保留容量，不用每周期分配
+		for (int index = 0; index <= 2 * TEAMSIZE; ++index) {
+			ObjectRecord older = GetObjectRecord(*mpLatest, index);
+			older.mField = GetChangedField(older, GetObjectRecord(world, index));
+
+			if (older.mField != 0) {
+				record.mObject.push_back(older);
+			}
+		}
+	}
+
+	WorldState *oldest = mView[HISTORY_SIZE];
+	for (int num = HISTORY_SIZE; num > 2; --num) {
+		mView[num] = mView[num - 1];
+		mViewNum[num] = (mViewNum[num - 1] == mNum)? mNum + 1: -1;
+	}
+	mView[2] = mpLatest;
+	mViewNum[2] = (mNum > 0)? mNum + 1: -1;
+
+	mpLatest = (oldest != 0)? oldest: new WorldState;
+	*mpLatest = world;
+	++mNum;
 }
 
+/**
+ * @brief 获得之前的世界，第1个直接返回，更早的从最近一个已生成的世界开始依次应用增量
+ */
 WorldState *HistoryState::GetHistory(int num)
 {
-	Assert(num > 0);
+	Assert(num > 0 && num <= HISTORY_SIZE);
+
+	if (num > mNum) {
+		return &mBlank;
+	}
+
+	if (num == 1) {
+		return mpLatest;
+	}
+
+	if (mViewNum[num] == mNum) {
+		return mView[num];
+	}
+
+	if (mView[num] == 0) {
+		mView[num] = new WorldState;
+	}
+
+	int base = num - 1;
+	while (base > 1 && mViewNum[base] != mNum) {
+		--base;
+	}
+
+	WorldState & view = *mView[num];
+	view = (base == 1)? *mpLatest: *mView[base];
+
+	for (int k = base + 1; k <= num; ++k) {
+		const CycleRecord & record = mRecord[GetRecordIndex(k)];
+
+		for (std::vector<ObjectRecord>::const_iterator it = record.mObject.begin(); it != record.mObject.end(); ++it) {
+			ApplyObjectRecord(*it, view);
+		}
+	}
+
+	const CycleRecord & record = mRecord[GetRecordIndex(num)];
+	view.mCurrentTime		= record.mCurrentTime;
+	view.mKickOffMode		= record.mKickOffMode;
+	view.mPlayMode			= record.mPlayMode;
+	view.mLastPlayMode		= record.mLastPlayMode;
+	view.mPlayModeTime		= record.mPlayModeTime;
+	view.mIsBallDropped		= record.mIsBallDropped;
+	view.mIsCycleStopped	= record.mIsCycleStopped;
+
+	mViewNum[num] = mNum;
+	return mView[num];
+}
+
+Time HistoryState::GetHistoryTime(int num) const
+{
+	Assert(num > 0 && num <= HISTORY_SIZE);
+
+	if (num > mNum) {
+		return mBlank.mCurrentTime;
+	}
+
+	return (num == 1)? mpLatest->mCurrentTime: mRecord[GetRecordIndex(num)].mCurrentTime;
+}
+
+HistoryState::ObjectRecord HistoryState::GetObjectRecord(const WorldState & world, int index)
+{
+	ObjectRecord record;
+	record.mIndex = index;
+
+	const MobileState & object = (index == 0)? static_cast<const MobileState &>(world.mBall):
+			(index <= TEAMSIZE)? static_cast<const MobileState &>(world.mTeammate[index]): static_cast<const MobileState &>(world.mOpponent[index - TEAMSIZE]);
+
+	record.mPos.mValue		= object.GetPos();
+	record.mPos.mCycleDelay	= object.GetPosDelay();
+	record.mPos.mConf		= object.GetPosConf();
+	record.mVel.mValue		= object.GetVel();
+	record.mVel.mCycleDelay	= object.GetVelDelay();
+	record.mVel.mConf		= object.GetVelConf();
+	record.mPosEps			= object.GetPosEps();
+	record.mVelEps			= object.GetVelEps();
+
+	if (index > 0) {
+		const PlayerState & player = static_cast<const PlayerState &>(object);
+
+		record.mIsAlive				= player.IsAlive();
+		record.mBodyDir.mValue		= player.GetBodyDir();
+		record.mBodyDir.mCycleDelay	= player.GetBodyDirDelay();
+		record.mBodyDir.mConf		= player.GetBodyDirConf();
+		record.mNeckDir.mValue		= player.GetNeckDir();
+		record.mNeckDir.mCycleDelay	= player.GetNeckDirDelay();
+		record.mNeckDir.mConf		= player.GetNeckDirConf();
+	}
+
+	return record;
+}
+
+int HistoryState::GetChangedField(const ObjectRecord & older, const ObjectRecord & newer)
+{
+	int field = 0;
+
+	if (older.mIsAlive != newer.mIsAlive) field |= OF_Alive;
+	if (!(older.mPos.mValue == newer.mPos.mValue) || older.mPos.mCycleDelay != newer.mPos.mCycleDelay || older.mPos.mConf != newer.mPos.mConf) field |= OF_Pos;
+	if (!(older.mVel.mValue == newer.mVel.mValue) || older.mVel.mCycleDelay != newer.mVel.mCycleDelay || older.mVel.mConf != newer.mVel.mConf) field |= OF_Vel;
+	if (older.mBodyDir.mValue != newer.mBodyDir.mValue || older.mBodyDir.mCycleDelay != newer.mBodyDir.mCycleDelay || older.mBodyDir.mConf != newer.mBodyDir.mConf) field |= OF_BodyDir;
+	if (older.mNeckDir.mValue != newer.mNeckDir.mValue || older.mNeckDir.mCycleDelay != newer.mNeckDir.mCycleDelay || older.mNeckDir.mConf != newer.mNeckDir.mConf) field |= OF_NeckDir;
+	if (older.mPosEps != newer.mPosEps || older.mVelEps != newer.mVelEps) field |= OF_Eps;
+
+	return field;
+}
+
+/**
+ * @brief 把记录中的字段写回世界，先写存活状态，因为 SetIsAlive(false) 会清零置信度
+ */
+void HistoryState::ApplyObjectRecord(const ObjectRecord & record, WorldState & world)
+{
+	if (record.mIndex == 0) {
+		BallState & ball = world.mBall;
+
+		if (record.mField & OF_Pos) ball.UpdatePos(record.mPos.mValue, record.mPos.mCycleDelay, record.mPos.mConf);
+		if (record.mField & OF_Vel) ball.UpdateVel(record.mVel.mValue, record.mVel.mCycleDelay, record.mVel.mConf);
+		if (record.mField & OF_Eps) {
+			ball.UpdatePosEps(record.mPosEps);
+			ball.UpdateVelEps(record.mVelEps);
+		}
+		return;
+	}
 
-	num = num % HISTORY_SIZE;
-	num = (mNum + HISTORY_SIZE - num) % HISTORY_SIZE;
+	PlayerState & player = (record.mIndex <= TEAMSIZE)? world.mTeammate[record.mIndex]: world.mOpponent[record.mIndex - TEAMSIZE];
 
-	return &mRecord[num];
+	if (record.mField & OF_Alive) player.SetIsAlive(record.mIsAlive);
+	if (record.mField & (OF_Alive | OF_Pos)) player.UpdatePos(record.mPos.mValue, record.mPos.mCycleDelay, record.mPos.mConf);
+	if (record.mField & (OF_Alive | OF_Vel)) player.UpdateVel(record.mVel.mValue, record.mVel.mCycleDelay, record.mVel.mConf);
+	if (record.mField & (OF_Alive | OF_BodyDir)) player.UpdateBodyDir(record.mBodyDir.mValue, record.mBodyDir.mCycleDelay, record.mBodyDir.mConf);
+	if (record.mField & (OF_Alive | OF_NeckDir)) player.UpdateNeckDir(record.mNeckDir.mValue, record.mNeckDir.mCycleDelay, record.mNeckDir.mConf);
+	if (record.mField & OF_Eps) {
+		player.UpdatePosEps(record.mPosEps);
+		player.UpdateVelEps(record.mVelEps);
+	}
 }
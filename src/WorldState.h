@@ -113,6 +113,7 @@ class BeliefState;
 class WorldState {
     // 友元类声明，允许 WorldStateUpdater 直接访问私有成员
     friend class WorldStateUpdater;
+    friend class HistoryState;
     
     // 禁止拷贝构造，确保世界状态的唯一性
     WorldState(const WorldState &);
@@ -222,6 +223,15 @@ public:
      * @param time 要设置的时间
      */
     void  SetCurrentTime(const Time & time) { mCurrentTime = time; }
+
+    /**
+     * @brief 世界状态的修改标记
+     *
+     * 每次从 Observer 更新、反算生成或被 WorldStateSetter 改动/恢复时换一个新值（全局递增，不会重复），
+     * 复用的反算 Agent 据此判断它缓存的派生信息是否还能用。
+     */
+    long GetStamp() const { return mStamp; }
+    void Touch() { mStamp = ++mStampCounter; }
     
     /**
      * @brief 获取开球模式
@@ -363,6 +373,9 @@ private:
 	int mOpponentScore;
 
 	bool mIsCycleStopped;
+
+	long mStamp;
+	static long mStampCounter;
 };
 
 /**
@@ -460,6 +473,10 @@ private:
 
 	bool UpdateMostSimilarPlayer(const Vector & pos ,int index);
 
+	/** 未知球员与候选球员的匹配，assignment[i]为第i个未知球员匹配到的候选球员（1~TEAMSIZE为己方，其它为对方），0为没有匹配 */
+	static void SolveUnknownAssignment(const bool unknown[][TEAMSIZE * 2 + 1], const double cost[][TEAMSIZE * 2 + 1], int player_num, int assignment[]);
+	void GreedyUnknownAssignment(const bool unknown[][TEAMSIZE * 2 + 1], const int unknown_count[], const Vector unknown_pos[], int player_num, int assignment[]);
+
     /** 更新某一个特定的队员 */
     void UpdateSpecificPlayer(const PlayerObserver& player , Unum unum , bool is_teammate);
 
@@ -488,8 +505,14 @@ private:
     /**计算自己头的角度*/
     bool ComputeSelfDir(double& angle);
 
-    /**计算自己的位置*/
-    bool ComputeSelfPos(Vector& vec , double& eps);
+    /**计算自己的位置，融合本次看到的所有标志和边线，cov为位置的协方差 {xx, xy, yy}*/
+    bool ComputeSelfPos(Vector& vec , double& eps, Array<double, 3> & cov);
+
+    /**只用最近的标志计算自己的位置*/
+    bool ComputeSelfPosByNearestMarker(Vector& vec , double& eps, Array<double, 3> & cov);
+
+    /**用位置和协方差融合新的定位结果*/
+    void FuseSelfPos(const Vector & pos, double eps, const Array<double, 3> & cov);
 
     /**计算下一个周期*/
     bool ComputeNextCycle(MobileState& ms , double decay);
@@ -604,7 +627,7 @@ public:
  *      	//... ...
  *          setter.IncStopTime(); //可以开始反算了
  *      	Agent * agent = mAgent.CreateTeammateAgent(mStrategy.GetSureTm());
- *          ActiveBehaviorList bhv_list;
+ *          ActiveBehaviorList bhv_list(*agent);
  *			{ //用于标示Planner的作用域，作用域结束后Planner将被撤销。
  *			  //如此安排是因为必须先撤销Planner再撤销Agent
  *      		BehaviorPassPlanner(*agent).Plan(bhv_list);
@@ -626,9 +649,11 @@ public:
 		mpBackupBallState(0),
 		mBackupTime(mWorldState.CurrentTime())
 	{
+		mWorldState.Touch();
 	}
 
 	~WorldStateSetter() {
+		mWorldState.Touch();
 		mWorldState.SetCurrentTime(mBackupTime);
 		if (mpBackupBallState != 0) {
 			mWorldState.Ball() = *mpBackupBallState;
@@ -688,15 +713,25 @@ private:
 	Time mBackupTime;
 };
 
-/**记录StateWorld历史信息*/
+/**记录StateWorld历史信息
+ * 只有上一周期的世界是完整保存的，更早的周期按对象记录与后一周期相比变化了的字段（位置、速度、朝向、置信度等），
+ * 在 GetHistory() 时才生成完整的世界（其余字段取自上一周期的世界），同一周期内生成过的会被缓存。
+ * 新周期到来时，上一周期的完整世界和已生成的世界只是指针后移一位，下一周期不必重新生成。
+ * Only the last cycle is kept as a full WorldState; older cycles are compact per-object deltas
+ * against the next newer cycle and are materialized lazily. Materialized views are shifted by
+ * pointer each cycle so they stay valid.
+ */
 class HistoryState
 {
+	HistoryState(const HistoryState &);
+	const HistoryState & operator=(const HistoryState &);
+
 public:
-    HistoryState(): mNum(0) {
-    }
+    HistoryState();
+    ~HistoryState();
 
     enum {
-    	HISTORY_SIZE = 10
+    	HISTORY_SIZE = 10 // 也是估计球员速度、朝向时回看的最大周期数，改变它会改变行为
     };
 
     /**将当前世界加入队列
@@ -709,12 +744,75 @@ public:
      */
     WorldState *GetHistory(int num);
 
+    /**获得之前的时间，不需要生成完整的世界
+     * @param 取值范围为1~HISTORYSIZE
+     */
+    Time GetHistoryTime(int num) const;
+
+private:
+    enum ObjectField {
+    	OF_Alive	= 1 << 0,
+    	OF_Pos		= 1 << 1,
+    	OF_Vel		= 1 << 2,
+    	OF_BodyDir	= 1 << 3,
+    	OF_NeckDir	= 1 << 4,
+    	OF_Eps		= 1 << 5
+    };
+
+    /**一个对象（球或球员）的运动学字段，0为球，1~11为队友，12~22为对手*/
+    struct ObjectRecord {
+    	ObjectRecord(): mIndex(0), mField(0), mIsAlive(false), mPosEps(0.0), mVelEps(0.0) {}
+
+    	int mIndex;
+    	int mField; // 记录了哪些字段，ObjectField的组合
+    	bool mIsAlive;
+    	StateValue<Vector> mPos;
+    	StateValue<Vector> mVel;
+    	StateValue<double> mBodyDir;
+    	StateValue<double> mNeckDir;
+    	double mPosEps;
+    	double mVelEps;
+    };
+
+    /**一个周期的记录*/
+    struct CycleRecord {
+    	CycleRecord(): mCurrentTime(Time(-3, 0)), mKickOffMode(KO_Ours), mPlayMode(PM_No_Mode), mLastPlayMode(PM_No_Mode),
+    	mPlayModeTime(Time(-3, 0)), mIsBallDropped(false), mIsCycleStopped(false) {}
+
+    	Time mCurrentTime;
+    	KickOffMode mKickOffMode;
+    	PlayMode mPlayMode;
+    	PlayMode mLastPlayMode;
+    	Time mPlayModeTime;
+    	bool mIsBallDropped;
+    	bool mIsCycleStopped;
+
+    	std::vector<ObjectRecord> mObject; // 与后一周期相比有变化的对象
+    };
+
+    static ObjectRecord GetObjectRecord(const WorldState & world, int index);
+    static void ApplyObjectRecord(const ObjectRecord & record, WorldState & world);
+    static int GetChangedField(const ObjectRecord & older, const ObjectRecord & newer);
+
+    /** 第num个记录在环中的位置，num >= 2 */
+    int GetRecordIndex(int num) const { return (mNum - num + 1 + HISTORY_SIZE) % HISTORY_SIZE; }
+
 private:
-    /**记录StateWorld的数组*/
-    Array<WorldState, HISTORY_SIZE> mRecord;
+    /**上一周期的完整世界*/
+    WorldState *mpLatest;
 
-    /**记录数组当前的置顶前一个空白*/
+    /**更早周期的增量记录，环形*/
+    Array<CycleRecord, HISTORY_SIZE> mRecord;
+
+    /**已记录的周期数*/
     int mNum;
+
+    /**按需生成的完整世界，及生成时对应的 mNum*/
+    Array<WorldState *, HISTORY_SIZE + 1, true> mView;
+    Array<int, HISTORY_SIZE + 1> mViewNum;
+
+    /**没有记录时返回的空世界*/
+    WorldState mBlank;
 };
 
 #endif /* WORLDSTATE_H_ */
@@ -42,6 +42,8 @@
 #include "Logger.h"
 #include "DynamicDebug.h"
 #include "Trainer.h"
+#include "TeamProcess.h"
+#include "StandInServer.h"
 
 #ifndef WIN32
 #include <signal.h>
@@ -91,6 +93,17 @@ int main(int argc, char* argv[])
 	ServerParam::instance().init(argc, argv);
 	PlayerParam::instance().init(argc, argv);
 
+	if (PlayerParam::instance().StandInServer()) {
+		StandInServer::instance().Run(); // 本进程当server用，不再连接
+		return 0;
+	}
+
+	if (PlayerParam::instance().TeamProcess() && !PlayerParam::instance().isTrainer()) {
+		if (TeamProcess::instance().Run()) {
+			return 0; // 整队都已结束
+		}
+	}
+
 	Client *client = 0;
 
 	if (PlayerParam::instance().isCoach()) {